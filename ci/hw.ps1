@@ -29,10 +29,13 @@ function Find-MSBuild {
 $repoDir = (Get-Item -Path $PSScriptRoot).Parent.FullName
 $binDir = "$repoDir\bin"
 $outputProjectTestServerDir = "$binDir\test_server"
+$outputProjectTestClientDir = "$binDir\test_client"
 $projectTestHWPath = "$repoDir\tests\test_server\test_server.sln"
+$projectTestClientPath = "$repoDir\tests\test_client\test_client.sln"
 $testResultsDir = "$repoDir\ci\test_result"
 $testResultPath = "../../test_result/TestResult.xml"
 $resultTestServerDir = "$repoDir\ci\test_result\server"
+$resultTestClientDir = "$repoDir\ci\test_result\client"
 $hexOutputDir = "$repoDir\ci\build\server"
 $arduinoCliPath = "$binDir\arduino-cli.exe"
 $sketchPath = "$repoDir\src\server\server.ino"
@@ -73,6 +76,16 @@ Write-Host "Saving compiled HEX file..."
 Write-Host "`n--------------------------------------------------`n"
 Copy-Item -Path "$hexOutputDir\server.ino.hex" -Destination $outputHexPath -Force
 
+$msbuildPath = Find-MSBuild
+Write-Host "`n--------------------------------------------------`n"
+Write-Host "Building the client testing project..."
+Write-Host "`n--------------------------------------------------`n"
+& $msbuildPath $projectTestClientPath "/p:OutDir=$outputProjectTestClientDir\"
+Write-Host "`n--------------------------------------------------`n"
+Write-Host "Running client tests..."
+Write-Host "`n--------------------------------------------------`n"
+& "$outputProjectTestClientDir\test_client.exe" "--gtest_output=xml:$resultTestClientDir/TestResultClient.xml"
+
 if ($port -and $speed) {
     Write-Host "`n--------------------------------------------------`n"
     Write-Host "Uploading HEX file to Arduino on port $port..."
@@ -0,0 +1,417 @@
+#include "GameArchive.h"
+#include <cstring>
+
+/**
+ * @brief Maps a whole file read-only into memory.
+ *
+ * @param filename The path to the file.
+ * @param file Receives the handle to the file.
+ * @param mapping Receives the handle to the mapping.
+ * @param size Receives the size of the file.
+ * @return const uint8_t* The mapped view, or nullptr if the file could not be mapped.
+ */
+static const uint8_t* mapFile(const string& filename, HANDLE& file, HANDLE& mapping, LONGLONG& size) {
+    mapping = NULL;
+    file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    const uint8_t* view = nullptr;
+    if (mapping != NULL) {
+        view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (view == nullptr) {
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+            mapping = NULL;
+        }
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+        return nullptr;
+    }
+    size = fileSize.QuadPart;
+    return view;
+}
+
+/**
+ * @brief Unmaps a file mapped with mapFile.
+ *
+ * @param view The mapped view.
+ * @param file The handle to the file.
+ * @param mapping The handle to the mapping.
+ */
+static void unmapFile(const uint8_t*& view, HANDLE& file, HANDLE& mapping) {
+    if (view != nullptr) {
+        UnmapViewOfFile(view);
+        view = nullptr;
+    }
+    if (mapping != NULL) {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+    }
+}
+
+/**
+ * @brief Checks the header of an archive and returns the number of complete games it holds.
+ *
+ * @param view The mapped archive.
+ * @param size The size of the archive file.
+ * @param gameCount Receives the number of committed games present in the file.
+ * @return true if the header is valid, false otherwise.
+ */
+static bool readArchiveHeader(const uint8_t* view, LONGLONG size, uint32_t& gameCount) {
+    if (size < static_cast<LONGLONG>(sizeof(ArchiveHeader))) {
+        return false;
+    }
+    const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(view);
+    if (memcmp(header->magic, "TTTA", 4) != 0 || header->version != ARCHIVE_VERSION || header->recordSize != sizeof(PackedGame)) {
+        return false;
+    }
+    LONGLONG stored = (size - sizeof(ArchiveHeader)) / sizeof(PackedGame);
+    gameCount = (header->gameCount < stored) ? header->gameCount : static_cast<uint32_t>(stored);
+    return true;
+}
+
+/**
+ * @brief Packs a finished game.
+ *
+ * @param game The game to pack.
+ * @param mode The game mode.
+ * @return PackedGame The packed game.
+ */
+PackedGame packGame(const GameRecord& game, GameMode mode) {
+    PackedGame packed = {};
+    uint8_t code = isGameOver(game.status) ? static_cast<uint8_t>(game.status) : 0;
+    packed.header = static_cast<uint8_t>((code << 6) | (static_cast<uint8_t>(mode) << 4) | (game.moveCount & 0x0F));
+    packed.firstPlayer = static_cast<uint8_t>(game.firstPlayer);
+    for (int move = 0; move < game.moveCount && move < 9; ++move) {
+        packed.moves[move / 2] |= static_cast<uint8_t>((move % 2 == 0) ? (game.moves[move] << 4) : game.moves[move]);
+    }
+    return packed;
+}
+
+/**
+ * @brief Unpacks an archived game.
+ *
+ * @param packed The packed game.
+ * @param game The record receiving the game.
+ * @return GameMode The game mode of the game.
+ */
+GameMode unpackGame(const PackedGame& packed, GameRecord& game) {
+    game.firstPlayer = static_cast<char>(packed.firstPlayer);
+    game.status = static_cast<GameStatus>(packed.header >> 6);
+    game.moveCount = packed.header & 0x0F;
+    if (game.moveCount > 9) {
+        game.moveCount = 9;
+    }
+    for (int move = 0; move < game.moveCount; ++move) {
+        game.moves[move] = (move % 2 == 0) ? (packed.moves[move / 2] >> 4) : (packed.moves[move / 2] & 0x0F);
+    }
+    return static_cast<GameMode>((packed.header >> 4) & 0x03);
+}
+
+/**
+ * @brief Packs the finished games found in a sequence of journal records.
+ *
+ * The moves of each game are collected in ply order and the game is packed once a record with
+ * a final status is reached. Unfinished games and games with missing records are skipped.
+ *
+ * @param records The journal records in journal order.
+ * @param afterGameId Only games with a greater journal identifier are packed; 0 packs every game.
+ * @param games The vector receiving the packed games.
+ * @return uint32_t The journal identifier of the last packed game, or afterGameId if none was packed.
+ */
+uint32_t collectFinishedGames(const vector<JournalRecord>& records, uint32_t afterGameId, vector<PackedGame>& games) {
+    games.clear();
+    GameRecord game;
+    uint32_t gameId = 0;
+    uint32_t lastGameId = afterGameId;
+    bool collecting = false;
+    for (const JournalRecord& record : records) {
+        if (record.ply == 0 && record.gameId > afterGameId) {
+            gameId = record.gameId;
+            game.firstPlayer = static_cast<char>(record.player);
+            game.moveCount = 0;
+            collecting = true;
+        }
+        if (!collecting || record.gameId != gameId || record.ply != game.moveCount) {
+            collecting = false;
+            continue;
+        }
+        game.moves[game.moveCount++] = record.cell;
+        if (record.status != 0) {
+            game.status = static_cast<GameStatus>(record.status);
+            games.push_back(packGame(game, static_cast<GameMode>(record.mode)));
+            lastGameId = gameId;
+            collecting = false;
+        }
+    }
+    return lastGameId;
+}
+
+/**
+ * @brief Appends the finished games of a journal that are not archived yet, creating the archive if needed.
+ *
+ * The header remembers the journal identifier of the last archived game, so running the append
+ * again only adds the games finished since. The packed games are written after the last committed
+ * game and flushed before the game count and the last identifier in the header are updated together,
+ * so a crash during the append leaves the archive at its previous committed state.
+ *
+ * @param journalFile The path to the journal file.
+ * @param archiveFile The path to the archive file.
+ * @param appended Receives the number of games appended.
+ * @return true if the games were appended, false otherwise.
+ */
+bool appendJournalToArchive(const string& journalFile, const string& archiveFile, uint32_t& appended) {
+    appended = 0;
+    vector<JournalRecord> records;
+    if (!readJournal(journalFile, records)) {
+        return false;
+    }
+
+    HANDLE file = CreateFileA(archiveFile.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        cerr << "Failed to open the game archive!" << endl;
+        return false;
+    }
+    ArchiveHeader header = {};
+    DWORD bytesRead = 0;
+    if (!ReadFile(file, &header, sizeof(header), &bytesRead, NULL) || bytesRead == 0) {
+        memcpy(header.magic, "TTTA", 4);
+        header.version = ARCHIVE_VERSION;
+        header.recordSize = sizeof(PackedGame);
+        header.gameCount = 0;
+        header.lastJournalId = 0;
+    }
+    else if (bytesRead != sizeof(header) || memcmp(header.magic, "TTTA", 4) != 0 ||
+        header.version != ARCHIVE_VERSION || header.recordSize != sizeof(PackedGame)) {
+        cerr << "The game archive is not valid!" << endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    vector<PackedGame> packed;
+    uint32_t lastJournalId = collectFinishedGames(records, header.lastJournalId, packed);
+    LARGE_INTEGER position;
+    position.QuadPart = sizeof(ArchiveHeader) + static_cast<LONGLONG>(header.gameCount) * sizeof(PackedGame);
+    DWORD bytesToWrite = static_cast<DWORD>(packed.size() * sizeof(PackedGame));
+    DWORD bytesWritten = 0;
+    bool written = SetFilePointerEx(file, position, NULL, FILE_BEGIN)
+        && (packed.empty() || (WriteFile(file, packed.data(), bytesToWrite, &bytesWritten, NULL) && bytesWritten == bytesToWrite))
+        && SetEndOfFile(file) && FlushFileBuffers(file);
+    if (written) {
+        header.gameCount += static_cast<uint32_t>(packed.size());
+        header.lastJournalId = lastJournalId;
+        position.QuadPart = 0;
+        written = SetFilePointerEx(file, position, NULL, FILE_BEGIN)
+            && WriteFile(file, &header, sizeof(header), &bytesWritten, NULL) && bytesWritten == sizeof(header)
+            && FlushFileBuffers(file);
+    }
+    CloseHandle(file);
+    if (!written) {
+        cerr << "Failed to write to the game archive!" << endl;
+        return false;
+    }
+    appended = static_cast<uint32_t>(packed.size());
+    return true;
+}
+
+/**
+ * @brief Builds the outcome index of the archive.
+ *
+ * The archive is scanned once to count the games of each outcome and once more to fill the
+ * identifier lists, which are therefore sorted.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file to write.
+ * @return true if the index was written, false otherwise.
+ */
+bool buildArchiveIndex(const string& archiveFile, const string& indexFile) {
+    HANDLE file;
+    HANDLE mapping;
+    LONGLONG size = 0;
+    const uint8_t* view = mapFile(archiveFile, file, mapping, size);
+    uint32_t gameCount = 0;
+    if (view == nullptr || !readArchiveHeader(view, size, gameCount)) {
+        cerr << "Failed to open the game archive!" << endl;
+        unmapFile(view, file, mapping);
+        return false;
+    }
+    const PackedGame* games = reinterpret_cast<const PackedGame*>(view + sizeof(ArchiveHeader));
+
+    ArchiveIndexHeader header = {};
+    memcpy(header.magic, "TTTI", 4);
+    header.gameCount = gameCount;
+    for (uint32_t id = 0; id < gameCount; ++id) {
+        header.outcomeCounts[games[id].header >> 6]++;
+    }
+    uint32_t next[4];
+    next[0] = 0;
+    for (int outcome = 1; outcome < 4; ++outcome) {
+        next[outcome] = next[outcome - 1] + header.outcomeCounts[outcome - 1];
+    }
+    vector<uint32_t> identifiers(gameCount);
+    for (uint32_t id = 0; id < gameCount; ++id) {
+        identifiers[next[games[id].header >> 6]++] = id;
+    }
+    unmapFile(view, file, mapping);
+
+    HANDLE index = CreateFileA(indexFile.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (index == INVALID_HANDLE_VALUE) {
+        cerr << "Failed to create the archive index!" << endl;
+        return false;
+    }
+    DWORD bytesToWrite = static_cast<DWORD>(identifiers.size() * sizeof(uint32_t));
+    DWORD bytesWritten = 0;
+    bool written = WriteFile(index, &header, sizeof(header), &bytesWritten, NULL) && bytesWritten == sizeof(header)
+        && (identifiers.empty() || (WriteFile(index, identifiers.data(), bytesToWrite, &bytesWritten, NULL) && bytesWritten == bytesToWrite))
+        && FlushFileBuffers(index);
+    CloseHandle(index);
+    if (!written) {
+        cerr << "Failed to write the archive index!" << endl;
+    }
+    return written;
+}
+
+/**
+ * @brief Maps the index of an open archive and checks that it covers every archived game.
+ *
+ * @param archive The archive with the archive file already mapped.
+ * @param indexFile The path to the index file.
+ * @return true if the index was mapped and is up to date, false otherwise.
+ */
+static bool mapArchiveIndex(GameArchive& archive, const string& indexFile) {
+    LONGLONG size = 0;
+    archive.indexView = mapFile(indexFile, archive.indexFile, archive.indexMapping, size);
+    if (archive.indexView == nullptr) {
+        return false;
+    }
+    const ArchiveIndexHeader* header = reinterpret_cast<const ArchiveIndexHeader*>(archive.indexView);
+    if (size < static_cast<LONGLONG>(sizeof(ArchiveIndexHeader)) || memcmp(header->magic, "TTTI", 4) != 0 ||
+        header->gameCount != archive.gameCount ||
+        size != static_cast<LONGLONG>(sizeof(ArchiveIndexHeader) + archive.gameCount * sizeof(uint32_t))) {
+        unmapFile(archive.indexView, archive.indexFile, archive.indexMapping);
+        return false;
+    }
+    const uint32_t* identifiers = reinterpret_cast<const uint32_t*>(archive.indexView + sizeof(ArchiveIndexHeader));
+    for (int outcome = 0; outcome < 4; ++outcome) {
+        archive.outcomes[outcome] = identifiers;
+        archive.outcomeCounts[outcome] = header->outcomeCounts[outcome];
+        identifiers += header->outcomeCounts[outcome];
+    }
+    return true;
+}
+
+/**
+ * @brief Maps the archive and its index into memory.
+ *
+ * The index is rebuilt first if it is missing or does not cover every archived game.
+ *
+ * @param archive The archive to initialize.
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @return true if the archive was opened, false otherwise.
+ */
+bool openArchive(GameArchive& archive, const string& archiveFile, const string& indexFile) {
+    archive.indexFile = INVALID_HANDLE_VALUE;
+    archive.indexMapping = NULL;
+    archive.indexView = nullptr;
+    LONGLONG size = 0;
+    archive.view = mapFile(archiveFile, archive.file, archive.mapping, size);
+    if (archive.view == nullptr || !readArchiveHeader(archive.view, size, archive.gameCount)) {
+        cerr << "Failed to open the game archive!" << endl;
+        unmapFile(archive.view, archive.file, archive.mapping);
+        return false;
+    }
+    archive.games = reinterpret_cast<const PackedGame*>(archive.view + sizeof(ArchiveHeader));
+    if (!mapArchiveIndex(archive, indexFile) &&
+        !(buildArchiveIndex(archiveFile, indexFile) && mapArchiveIndex(archive, indexFile))) {
+        cerr << "Failed to open the archive index!" << endl;
+        unmapFile(archive.view, archive.file, archive.mapping);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Unmaps and closes the archive.
+ *
+ * @param archive The open archive.
+ */
+void closeArchive(GameArchive& archive) {
+    unmapFile(archive.indexView, archive.indexFile, archive.indexMapping);
+    unmapFile(archive.view, archive.file, archive.mapping);
+}
+
+/**
+ * @brief Prints an archived game.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @param gameId The archive identifier of the game.
+ * @return true if the game exists, false otherwise.
+ */
+bool printArchivedGame(const string& archiveFile, const string& indexFile, uint32_t gameId) {
+    GameArchive archive;
+    if (!openArchive(archive, archiveFile, indexFile)) {
+        return false;
+    }
+    if (gameId >= archive.gameCount) {
+        cerr << "Game " << gameId << " is not in the archive (" << archive.gameCount << " games)!" << endl;
+        closeArchive(archive);
+        return false;
+    }
+    GameRecord game;
+    GameMode mode = unpackGame(archive.games[gameId], game);
+    closeArchive(archive);
+
+    Board board = emptyBoard();
+    char player = game.firstPlayer;
+    cout << "=============================================\n";
+    cout << "      Game #" << gameId << ": " << gameModeName(mode) << ", " << game.firstPlayer << " first\n";
+    cout << "      Moves:";
+    for (int move = 0; move < game.moveCount; ++move) {
+        cout << " " << game.moves[move] + 1;
+        makeMove(board, game.moves[move] + 1, player);
+        player = (player == 'X') ? 'O' : 'X';
+    }
+    cout << "\n      Result: " << gameStatusName(game.status) << "\n";
+    printBoard(board);
+    return true;
+}
+
+/**
+ * @brief Prints the number and identifiers of the archived games with the given outcome.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @param status The outcome (Win X, Win O or Draw).
+ * @param limit The maximum number of identifiers to print.
+ * @return true if the archive was queried, false otherwise.
+ */
+bool queryArchive(const string& archiveFile, const string& indexFile, GameStatus status, uint32_t limit) {
+    if (!isGameOver(status)) {
+        cerr << "Only finished games are archived!" << endl;
+        return false;
+    }
+    GameArchive archive;
+    if (!openArchive(archive, archiveFile, indexFile)) {
+        return false;
+    }
+    int outcome = static_cast<int>(status);
+    uint32_t count = archive.outcomeCounts[outcome];
+    cout << "      " << gameStatusName(status) << ": " << count << " of " << archive.gameCount << " games\n";
+    for (uint32_t i = 0; i < count && i < limit; ++i) {
+        cout << "      #" << archive.outcomes[outcome][i] << "\n";
+    }
+    closeArchive(archive);
+    return true;
+}
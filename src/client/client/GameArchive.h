@@ -0,0 +1,169 @@
+/**
+ * @file GameArchive.h
+ * @brief Contains functions for the memory-mapped archive of finished games.
+ *
+ * The archive stores every finished game as a fixed-size 8-byte packed record after a 16-byte header.
+ * The archive identifier of a game is its slot, so any game is found in O(1) from the identifier alone.
+ * A separate index file holds, for each outcome, the sorted list of identifiers of the games with that outcome.
+ * Both files are read through a read-only memory mapping and used in place, without any parsing.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <windows.h>
+#include "GameLogic.h"
+#include "GameJournal.h"
+
+using namespace std;
+
+/**
+ * @brief Default names of the archive and index files.
+ */
+#define ARCHIVE_FILE            "game_archive.bin"
+#define ARCHIVE_INDEX_FILE      "game_archive.idx"
+
+/**
+ * @brief Archive format version written to the header.
+ */
+#define ARCHIVE_VERSION         1
+
+/**
+ * @brief Header at the start of the archive file.
+ */
+struct ArchiveHeader {
+    char magic[4];          ///< Always "TTTA".
+    uint16_t version;       ///< ARCHIVE_VERSION.
+    uint16_t recordSize;    ///< Size of a packed game, sizeof(PackedGame).
+    uint32_t gameCount;     ///< Number of committed games.
+    uint32_t lastJournalId; ///< Journal identifier of the last archived game, 0 if none.
+};
+
+/**
+ * @brief A finished game packed into 8 bytes.
+ *
+ * The cells of the moves are stored as nibbles, two per byte, high nibble first.
+ */
+struct PackedGame {
+    uint8_t header;         ///< Status code in bits 7-6, game mode in bits 5-4, move count in bits 3-0.
+    uint8_t firstPlayer;    ///< The player who moved first ('X' or 'O').
+    uint8_t moves[5];       ///< Cell indices (0-8) of the moves.
+    uint8_t reserved;       ///< Always 0.
+};
+
+/**
+ * @brief Header at the start of the index file, followed by the identifier lists of the outcomes in order.
+ */
+struct ArchiveIndexHeader {
+    char magic[4];              ///< Always "TTTI".
+    uint32_t gameCount;         ///< Number of archived games covered by the index.
+    uint32_t outcomeCounts[4];  ///< Number of games per status code (0 NextMove, 1 Win X, 2 Win O, 3 Draw).
+};
+
+static_assert(sizeof(ArchiveHeader) == 16, "ArchiveHeader must be 16 bytes");
+static_assert(sizeof(PackedGame) == 8, "PackedGame must be 8 bytes");
+static_assert(sizeof(ArchiveIndexHeader) == 24, "ArchiveIndexHeader must be 24 bytes");
+
+/**
+ * @brief An archive and its index mapped into memory.
+ */
+struct GameArchive {
+    HANDLE file;                    ///< Handle to the archive file.
+    HANDLE mapping;                 ///< Mapping of the archive file.
+    const uint8_t* view;            ///< Mapped view of the archive file.
+    HANDLE indexFile;               ///< Handle to the index file.
+    HANDLE indexMapping;            ///< Mapping of the index file.
+    const uint8_t* indexView;       ///< Mapped view of the index file.
+    uint32_t gameCount;             ///< Number of archived games.
+    const PackedGame* games;        ///< The archived games, indexed by identifier.
+    const uint32_t* outcomes[4];    ///< Sorted identifiers of the games per status code.
+    uint32_t outcomeCounts[4];      ///< Number of identifiers in each outcome list.
+};
+
+/**
+ * @brief Packs a finished game.
+ *
+ * @param game The game to pack.
+ * @param mode The game mode.
+ * @return The packed game.
+ */
+PackedGame packGame(const GameRecord& game, GameMode mode);
+
+/**
+ * @brief Unpacks an archived game.
+ *
+ * @param packed The packed game.
+ * @param game The record receiving the game.
+ * @return The game mode of the game.
+ */
+GameMode unpackGame(const PackedGame& packed, GameRecord& game);
+
+/**
+ * @brief Packs the finished games found in a sequence of journal records.
+ *
+ * @param records The journal records in journal order.
+ * @param afterGameId Only games with a greater journal identifier are packed; 0 packs every game.
+ * @param games The vector receiving the packed games.
+ * @return The journal identifier of the last packed game, or afterGameId if none was packed.
+ */
+uint32_t collectFinishedGames(const vector<JournalRecord>& records, uint32_t afterGameId, vector<PackedGame>& games);
+
+/**
+ * @brief Appends the finished games of a journal that are not archived yet, creating the archive if needed.
+ *
+ * @param journalFile The path to the journal file.
+ * @param archiveFile The path to the archive file.
+ * @param appended Receives the number of games appended.
+ * @return true if the games were appended, false otherwise.
+ */
+bool appendJournalToArchive(const string& journalFile, const string& archiveFile, uint32_t& appended);
+
+/**
+ * @brief Builds the outcome index of the archive.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file to write.
+ * @return true if the index was written, false otherwise.
+ */
+bool buildArchiveIndex(const string& archiveFile, const string& indexFile);
+
+/**
+ * @brief Maps the archive and its index into memory.
+ *
+ * The index is rebuilt first if it does not cover every archived game.
+ *
+ * @param archive The archive to initialize.
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @return true if the archive was opened, false otherwise.
+ */
+bool openArchive(GameArchive& archive, const string& archiveFile, const string& indexFile);
+
+/**
+ * @brief Unmaps and closes the archive.
+ *
+ * @param archive The open archive.
+ */
+void closeArchive(GameArchive& archive);
+
+/**
+ * @brief Prints an archived game.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @param gameId The archive identifier of the game.
+ * @return true if the game exists, false otherwise.
+ */
+bool printArchivedGame(const string& archiveFile, const string& indexFile, uint32_t gameId);
+
+/**
+ * @brief Prints the number and identifiers of the archived games with the given outcome.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @param status The outcome (Win X, Win O or Draw).
+ * @param limit The maximum number of identifiers to print.
+ * @return true if the archive was queried, false otherwise.
+ */
+bool queryArchive(const string& archiveFile, const string& indexFile, GameStatus status, uint32_t limit);
@@ -0,0 +1,342 @@
+#include "GameJournal.h"
+#include <cstddef>
+#include <ctime>
+#include "Protocol.h"
+
+/**
+ * @brief Number of records read at once when scanning the journal.
+ */
+#define JOURNAL_SCAN_RECORDS    256
+
+/**
+ * @brief Computes the checksum stored in a journal record.
+ *
+ * @param record The record to checksum.
+ * @return uint16_t The CRC-16 of every field preceding the checksum.
+ */
+static uint16_t recordChecksum(const JournalRecord& record) {
+    return crc16(reinterpret_cast<const uint8_t*>(&record), offsetof(JournalRecord, checksum));
+}
+
+/**
+ * @brief Checks that a record read from the journal is intact and well formed.
+ *
+ * @param record The record to check.
+ * @return true if the checksum matches and every field is in range, false otherwise.
+ */
+bool isValidJournalRecord(const JournalRecord& record) {
+    return record.checksum == recordChecksum(record)
+        && record.ply < 9 && record.cell < 9
+        && (record.player == 'X' || record.player == 'O')
+        && record.status < 4 && record.mode < 4;
+}
+
+/**
+ * @brief Reads consecutive records from the journal at the given offset.
+ *
+ * @param file Handle to the journal file.
+ * @param offset The byte offset of the first record.
+ * @param records The buffer receiving the records.
+ * @param count The number of records to read.
+ * @return DWORD The number of complete records read.
+ */
+static DWORD readRecords(HANDLE file, LONGLONG offset, JournalRecord* records, DWORD count) {
+    LARGE_INTEGER position;
+    position.QuadPart = offset;
+    DWORD bytesRead = 0;
+    if (!SetFilePointerEx(file, position, NULL, FILE_BEGIN) ||
+        !ReadFile(file, records, count * sizeof(JournalRecord), &bytesRead, NULL)) {
+        return 0;
+    }
+    return bytesRead / sizeof(JournalRecord);
+}
+
+/**
+ * @brief Reads every valid record of the journal.
+ *
+ * The journal is read in blocks of JOURNAL_SCAN_RECORDS records. Records that fail validation are skipped.
+ *
+ * @param journalFile The path to the journal file.
+ * @param records The vector receiving the records in journal order.
+ * @return true if the journal was read, false otherwise.
+ */
+bool readJournal(const string& journalFile, vector<JournalRecord>& records) {
+    HANDLE file = CreateFileA(journalFile.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        cerr << "Failed to open the game journal!" << endl;
+        return false;
+    }
+    records.clear();
+    JournalRecord block[JOURNAL_SCAN_RECORDS];
+    LONGLONG offset = 0;
+    DWORD count;
+    while ((count = readRecords(file, offset, block, JOURNAL_SCAN_RECORDS)) > 0) {
+        for (DWORD i = 0; i < count; ++i) {
+            if (isValidJournalRecord(block[i])) {
+                records.push_back(block[i]);
+            }
+        }
+        offset += count * sizeof(JournalRecord);
+    }
+    CloseHandle(file);
+    return true;
+}
+
+/**
+ * @brief Opens the journal, creating it if it does not exist.
+ *
+ * A crash can leave a partially written record or a record that never reached the disk intact at the
+ * end of the file. Such a tail is cut off, and the next game identifier continues after the last valid record.
+ *
+ * @param journal The journal to initialize.
+ * @param filename The path to the journal file.
+ * @return true if the journal was opened, false otherwise.
+ */
+bool openJournal(GameJournal& journal, const string& filename) {
+    journal.file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (journal.file == INVALID_HANDLE_VALUE) {
+        cerr << "Failed to open the game journal!" << endl;
+        return false;
+    }
+    journal.nextGameId = 1;
+    journal.gameId = 0;
+    journal.ply = 0;
+    journal.mode = GameMode::ManVsMan;
+    journal.board = emptyBoard();
+    journal.unsyncedRecords = 0;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(journal.file, &size)) {
+        CloseHandle(journal.file);
+        journal.file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    LONGLONG validSize = size.QuadPart - size.QuadPart % sizeof(JournalRecord);
+    JournalRecord last;
+    while (validSize > 0) {
+        if (readRecords(journal.file, validSize - sizeof(JournalRecord), &last, 1) == 1 && isValidJournalRecord(last)) {
+            journal.nextGameId = last.gameId + 1;
+            break;
+        }
+        validSize -= sizeof(JournalRecord);
+    }
+    LARGE_INTEGER end;
+    end.QuadPart = validSize;
+    SetFilePointerEx(journal.file, end, NULL, FILE_BEGIN);
+    if (validSize != size.QuadPart) {
+        SetEndOfFile(journal.file);
+        FlushFileBuffers(journal.file);
+    }
+    return true;
+}
+
+/**
+ * @brief Starts recording a new game.
+ *
+ * @param journal The open journal.
+ * @param gameMode The game mode.
+ */
+void startJournalGame(GameJournal& journal, GameMode gameMode) {
+    journal.gameId = journal.nextGameId++;
+    journal.ply = 0;
+    journal.mode = gameMode;
+    journal.board = emptyBoard();
+}
+
+/**
+ * @brief Continues recording a game recovered from the journal.
+ *
+ * @param journal The open journal.
+ * @param game The recovered game.
+ */
+void resumeJournalGame(GameJournal& journal, const JournalGame& game) {
+    startJournalGame(journal, game.gameMode);
+    journal.nextGameId = game.gameId + 1;
+    journal.gameId = game.gameId;
+    journal.ply = game.moveCount;
+    journal.board = game.board;
+}
+
+/**
+ * @brief Appends the moves that bring the recorded position up to the given board.
+ *
+ * The records are written with a single WriteFile call. The journal is flushed to disk every
+ * JOURNAL_SYNC_INTERVAL records and whenever a game ends, so persisting a move normally costs
+ * one small append.
+ *
+ * @param journal The open journal.
+ * @param board The current board.
+ * @param firstCell The cell (0-8) to record first if it is among the new moves, or -1.
+ * @param status The status of the game after the moves (e.g., NextMove, Win X).
+ * @return true if the moves were written, false otherwise.
+ */
+bool journalBoard(GameJournal& journal, Board board, int firstCell, GameStatus status) {
+    int cells[9];
+    int count = 0;
+    if (firstCell >= 0 && firstCell < 9 && board[firstCell] != journal.board[firstCell]) {
+        cells[count++] = firstCell;
+    }
+    for (int cell = 0; cell < 9; ++cell) {
+        if (cell != firstCell && board[cell] != EMPTY_CELL && board[cell] != journal.board[cell]) {
+            cells[count++] = cell;
+        }
+    }
+    if (count > 9 - journal.ply) {
+        count = 9 - journal.ply;
+    }
+    if (count <= 0) {
+        return true;
+    }
+
+    JournalRecord records[9];
+    uint32_t timestamp = static_cast<uint32_t>(time(nullptr));
+    uint8_t code = isGameOver(status) ? static_cast<uint8_t>(status) : 0;
+    for (int i = 0; i < count; ++i) {
+        JournalRecord& record = records[i];
+        record.gameId = journal.gameId;
+        record.timestamp = timestamp;
+        record.ply = static_cast<uint8_t>(journal.ply++);
+        record.cell = static_cast<uint8_t>(cells[i]);
+        record.player = static_cast<uint8_t>(board[cells[i]]);
+        record.status = (i == count - 1) ? code : 0;
+        record.mode = static_cast<uint8_t>(journal.mode);
+        record.reserved = 0;
+        record.checksum = recordChecksum(record);
+        journal.board[cells[i]] = board[cells[i]];
+    }
+
+    DWORD bytesToWrite = count * sizeof(JournalRecord);
+    DWORD bytesWritten = 0;
+    if (!WriteFile(journal.file, records, bytesToWrite, &bytesWritten, NULL) || bytesWritten != bytesToWrite) {
+        cerr << "Failed to write to the game journal!" << endl;
+        return false;
+    }
+    journal.unsyncedRecords += count;
+    if (journal.unsyncedRecords >= JOURNAL_SYNC_INTERVAL || code != 0) {
+        syncJournal(journal);
+    }
+    return true;
+}
+
+/**
+ * @brief Flushes the appended records to disk.
+ *
+ * @param journal The open journal.
+ */
+void syncJournal(GameJournal& journal) {
+    if (journal.unsyncedRecords > 0) {
+        FlushFileBuffers(journal.file);
+        journal.unsyncedRecords = 0;
+    }
+}
+
+/**
+ * @brief Flushes and closes the journal.
+ *
+ * @param journal The open journal.
+ */
+void closeJournal(GameJournal& journal) {
+    if (journal.file != INVALID_HANDLE_VALUE) {
+        syncJournal(journal);
+        CloseHandle(journal.file);
+        journal.file = INVALID_HANDLE_VALUE;
+    }
+}
+
+/**
+ * @brief Rebuilds the last game of the journal by replaying the records at its tail.
+ *
+ * The ply of the last record tells how many records belong to its game, so only those records
+ * are read, regardless of the size of the journal.
+ *
+ * @param journal The open journal.
+ * @param game The game to populate.
+ * @return true if the journal holds a complete, valid last game, false otherwise.
+ */
+bool recoverLastGame(GameJournal& journal, JournalGame& game) {
+    LARGE_INTEGER zero;
+    zero.QuadPart = 0;
+    LARGE_INTEGER end;
+    if (!SetFilePointerEx(journal.file, zero, &end, FILE_END) || end.QuadPart < static_cast<LONGLONG>(sizeof(JournalRecord))) {
+        return false;
+    }
+
+    JournalRecord records[9];
+    DWORD count = 0;
+    if (readRecords(journal.file, end.QuadPart - sizeof(JournalRecord), records, 1) == 1 && isValidJournalRecord(records[0])) {
+        count = records[0].ply + 1;
+        if (end.QuadPart < static_cast<LONGLONG>(count * sizeof(JournalRecord)) ||
+            readRecords(journal.file, end.QuadPart - count * sizeof(JournalRecord), records, count) != count) {
+            count = 0;
+        }
+    }
+    SetFilePointerEx(journal.file, end, NULL, FILE_BEGIN);
+    if (count == 0) {
+        return false;
+    }
+
+    game.gameId = records[0].gameId;
+    game.gameMode = static_cast<GameMode>(records[0].mode);
+    game.firstPlayer = static_cast<char>(records[0].player);
+    game.board = emptyBoard();
+    for (DWORD i = 0; i < count; ++i) {
+        const JournalRecord& record = records[i];
+        if (!isValidJournalRecord(record) || record.gameId != game.gameId || record.ply != i || game.board[record.cell] != EMPTY_CELL) {
+            return false;
+        }
+        game.board[record.cell] = static_cast<char>(record.player);
+        game.lastPlayer = static_cast<char>(record.player);
+        game.status = static_cast<GameStatus>(record.status);
+    }
+    game.moveCount = static_cast<int>(count);
+    return true;
+}
+
+/**
+ * @brief Exports a game from the journal as a game state XML file.
+ *
+ * The moves of the game are replayed onto an empty board.
+ *
+ * @param journalFile The path to the journal file.
+ * @param gameId The identifier of the game to export.
+ * @param xmlFile The path to the XML file to write.
+ * @return true if the game was found and exported, false otherwise.
+ */
+bool exportGameXML(const string& journalFile, uint32_t gameId, const string& xmlFile) {
+    vector<JournalRecord> records;
+    if (!readJournal(journalFile, records)) {
+        return false;
+    }
+
+    JournalGame game;
+    game.gameId = gameId;
+    game.moveCount = 0;
+    game.board = emptyBoard();
+    for (const JournalRecord& record : records) {
+        if (record.gameId != gameId) {
+            continue;
+        }
+        if (game.moveCount == 0) {
+            game.gameMode = static_cast<GameMode>(record.mode);
+            game.firstPlayer = static_cast<char>(record.player);
+        }
+        game.board[record.cell] = static_cast<char>(record.player);
+        game.lastPlayer = static_cast<char>(record.player);
+        game.status = static_cast<GameStatus>(record.status);
+        game.moveCount++;
+    }
+    if (game.moveCount == 0) {
+        cerr << "Game " << gameId << " was not found in the journal!" << endl;
+        return false;
+    }
+
+    string buffer;
+    serializeGameState(buffer, otherPlayer(game.lastPlayer), game.gameMode, game.board, game.status);
+    ofstream xml(xmlFile);
+    if (!xml.is_open()) {
+        cerr << "Failed to create XML file!" << endl;
+        return false;
+    }
+    xml << buffer;
+    return true;
+}
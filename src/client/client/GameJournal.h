@@ -0,0 +1,167 @@
+/**
+ * @file GameJournal.h
+ * @brief Contains functions for the append-only binary journal of played moves.
+ *
+ * Every move is appended to the journal as a fixed-size 16-byte record, so persisting a move
+ * costs a single small write instead of rewriting the whole game state. Records are checksummed
+ * with CRC-16, which allows a torn or corrupted tail left by a crash to be detected and dropped.
+ * The position of any game can be rebuilt by replaying its records.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <windows.h>
+#include "GameLogic.h"
+
+using namespace std;
+
+/**
+ * @brief Default name of the journal file.
+ */
+#define JOURNAL_FILE            "game_journal.bin"
+
+/**
+ * @brief Number of records appended between two flushes to disk.
+ *
+ * The journal is also flushed whenever a game ends and when it is closed.
+ */
+#define JOURNAL_SYNC_INTERVAL   16
+
+/**
+ * @brief A single move as stored in the journal.
+ */
+struct JournalRecord {
+    uint32_t gameId;    ///< Identifier of the game, increasing from 1.
+    uint32_t timestamp; ///< Time of the move in seconds since the Unix epoch.
+    uint8_t ply;        ///< Index of the move within the game (0-8).
+    uint8_t cell;       ///< Cell index (0-8, row * 3 + column) of the move.
+    uint8_t player;     ///< The player who moved ('X' or 'O').
+    uint8_t status;     ///< Status code of the game after the move (0 NextMove, 1 Win X, 2 Win O, 3 Draw).
+    uint8_t mode;       ///< Index of the game mode (0 Man vs Man, 1 Man vs AI, 2 AI vs Man, 3 AI vs AI).
+    uint8_t reserved;   ///< Always 0.
+    uint16_t checksum;  ///< CRC-16 of the preceding 14 bytes.
+};
+
+static_assert(sizeof(JournalRecord) == 16, "JournalRecord must be 16 bytes");
+
+/**
+ * @brief An open journal and the game currently being recorded.
+ */
+struct GameJournal {
+    HANDLE file;            ///< Handle to the journal file.
+    uint32_t nextGameId;    ///< Identifier assigned to the next game started.
+    uint32_t gameId;        ///< Identifier of the game being recorded.
+    int ply;                ///< Number of moves recorded for the current game.
+    GameMode mode;          ///< Game mode of the current game.
+    Board board;            ///< The position covered by the recorded moves.
+    int unsyncedRecords;    ///< Records appended since the last flush.
+};
+
+/**
+ * @brief A game rebuilt from the journal.
+ */
+struct JournalGame {
+    uint32_t gameId;    ///< Identifier of the game.
+    GameMode gameMode;  ///< The game mode.
+    char firstPlayer;   ///< The player who made the first move.
+    char lastPlayer;    ///< The player who made the last move.
+    int moveCount;      ///< Number of moves played.
+    Board board;        ///< The position after the last move.
+    GameStatus status;  ///< The status after the last move (NextMove, Win X, Win O or Draw).
+};
+
+/**
+ * @brief Checks that a record read from the journal is intact and well formed.
+ *
+ * @param record The record to check.
+ * @return true if the checksum matches and every field is in range, false otherwise.
+ */
+bool isValidJournalRecord(const JournalRecord& record);
+
+/**
+ * @brief Reads every valid record of the journal.
+ *
+ * @param journalFile The path to the journal file.
+ * @param records The vector receiving the records in journal order.
+ * @return true if the journal was read, false otherwise.
+ */
+bool readJournal(const string& journalFile, vector<JournalRecord>& records);
+
+/**
+ * @brief Opens the journal, creating it if it does not exist.
+ *
+ * A partially written or corrupted tail is truncated, so appending always starts after the last valid record.
+ *
+ * @param journal The journal to initialize.
+ * @param filename The path to the journal file.
+ * @return true if the journal was opened, false otherwise.
+ */
+bool openJournal(GameJournal& journal, const string& filename);
+
+/**
+ * @brief Starts recording a new game.
+ *
+ * @param journal The open journal.
+ * @param gameMode The game mode.
+ */
+void startJournalGame(GameJournal& journal, GameMode gameMode);
+
+/**
+ * @brief Continues recording a game recovered from the journal.
+ *
+ * @param journal The open journal.
+ * @param game The recovered game.
+ */
+void resumeJournalGame(GameJournal& journal, const JournalGame& game);
+
+/**
+ * @brief Appends the moves that bring the recorded position up to the given board.
+ *
+ * Every cell occupied on the board but not yet recorded is appended as a move. The last
+ * appended move carries the given status; any earlier ones carry NextMove.
+ *
+ * @param journal The open journal.
+ * @param board The current board.
+ * @param firstCell The cell (0-8) to record first if it is among the new moves, or -1.
+ * @param status The status of the game after the moves (e.g., NextMove, Win X).
+ * @return true if the moves were written, false otherwise.
+ */
+bool journalBoard(GameJournal& journal, Board board, int firstCell, GameStatus status);
+
+/**
+ * @brief Flushes the appended records to disk.
+ *
+ * @param journal The open journal.
+ */
+void syncJournal(GameJournal& journal);
+
+/**
+ * @brief Flushes and closes the journal.
+ *
+ * @param journal The open journal.
+ */
+void closeJournal(GameJournal& journal);
+
+/**
+ * @brief Rebuilds the last game of the journal by replaying the records at its tail.
+ *
+ * @param journal The open journal.
+ * @param game The game to populate.
+ * @return true if the journal holds a complete, valid last game, false otherwise.
+ */
+bool recoverLastGame(GameJournal& journal, JournalGame& game);
+
+/**
+ * @brief Exports a game from the journal as a game state XML file.
+ *
+ * The file holds the document built by serializeGameState, with the player to move next
+ * and the status after the last move.
+ *
+ * @param journalFile The path to the journal file.
+ * @param gameId The identifier of the game to export.
+ * @param xmlFile The path to the XML file to write.
+ * @return true if the game was found and exported, false otherwise.
+ */
+bool exportGameXML(const string& journalFile, uint32_t gameId, const string& xmlFile);
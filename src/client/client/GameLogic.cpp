@@ -1,28 +1,97 @@
 #include "GameLogic.h"
+#include "GameStateBinder.h"
+#include <iomanip>
 
 /**
- * @brief Parses a game state XML file and extracts game data.
+ * @brief Returns the XML document reused by every parse during the session.
  *
- * This function loads a specified XML file and extracts the game state, including the first player,
- * game type, board state, and game status. The parsed values are stored in the provided references.
+ * The document retains its memory pools and character buffer between parses, so parsing
+ * the game state on every move performs no heap allocation once the first reply has been parsed.
+ * Element names are interned, so the repeated <Row> and <Cell> elements are looked up by atom.
  *
- * @param filename The name of the XML file to load.
- * @param firstPlayer Reference to a character where the first player ('X' or 'O') will be stored.
- * @param gameMode Reference to a string where the game mode (e.g., "Man vs Man") will be stored.
- * @param board Reference to a 2D vector of characters representing the board state.
- * @param gameStatus Reference to a string where the game status (e.g., "Start") will be stored.
+ * @return tinyxml2::XMLDocument& The session document.
+ */
+static tinyxml2::XMLDocument& sessionDocument() {
+    static tinyxml2::XMLDocument document;
+    document.SetRetainMemory(true);
+    document.SetInternNames(true);
+    return document;
+}
+
+/**
+ * @brief Whether the memory statistics of the session document are printed after every parse.
+ */
+static bool memoryStatsLogging = false;
+
+/**
+ * @brief Enables or disables printing the memory statistics of the session document after every parse.
+ *
+ * @param enabled true to print the statistics, false otherwise.
+ */
+void setMemoryStatsLogging(bool enabled) {
+    memoryStatsLogging = enabled;
+}
+
+/**
+ * @brief Tells whether the memory statistics of the XML documents are printed.
+ *
+ * @return true if the statistics are printed, false otherwise.
  */
-void parseGameStateXML(const string& filename, char& firstPlayer, string& gameMode, vector<vector<char>>& board, string& gameStatus) {
-    tinyxml2::XMLDocument doc;
-    XMLError eResult = doc.LoadFile(filename.c_str());
-    if (eResult != XML_SUCCESS) {
-        cerr << "Error loading XML file: " << doc.ErrorStr() << endl;
-        return;
+bool memoryStatsLoggingEnabled() {
+    return memoryStatsLogging;
+}
+
+/**
+ * @brief Prints one memory pool as a row of the memory table.
+ *
+ * @param name The name of the pool.
+ * @param pool The statistics of the pool.
+ */
+static void printPoolStats(const string& name, const XMLPoolStats& pool) {
+    cout << "  " << left << setw(12) << name << right << setw(8) << pool.currentAllocs << setw(8) << pool.maxAllocs
+        << setw(10) << pool.totalAllocs << setw(8) << pool.blocks << setw(10) << pool.bytes << "\n";
+}
+
+/**
+ * @brief Prints the memory held by an XML document, pool by pool.
+ *
+ * @param doc The XML document.
+ * @param label The name of the document printed in the title.
+ */
+void printMemoryStats(const tinyxml2::XMLDocument& doc, const string& label) {
+    XMLMemoryStats stats = doc.MemoryStats();
+    cout << "\n=============================================\n";
+    cout << "      Memory of " << label << "\n";
+    cout << "=============================================\n";
+    cout << "  " << left << setw(12) << "" << right << setw(8) << "In use" << setw(8) << "Peak"
+        << setw(10) << "Allocs" << setw(8) << "Blocks" << setw(10) << "Bytes" << "\n";
+    printPoolStats("Elements", stats.elements);
+    printPoolStats("Attributes", stats.attributes);
+    printPoolStats("Texts", stats.texts);
+    printPoolStats("Comments", stats.comments);
+    cout << "  " << left << setw(12) << "Characters" << right << setw(44) << stats.charBufferBytes << "\n";
+    if (stats.mappedBytes > 0) {
+        cout << "  " << left << setw(12) << "Mapped" << right << setw(44) << stats.mappedBytes << "\n";
     }
+    cout << "  " << left << setw(12) << "Total" << right << setw(44) << stats.totalBytes << "\n";
+}
+
+/**
+ * @brief Extracts the game data from a parsed game state document.
+ *
+ * The names of the game mode and status are looked up here, so the caller only sees the enums.
+ *
+ * @param doc The parsed XML document.
+ * @param firstPlayer Reference to a character where the first player ('X' or 'O') will be stored.
+ * @param gameMode Reference to the game mode.
+ * @param board Reference to the board receiving the cells.
+ * @param gameStatus Reference to the game status.
+ * @return true if a <GameState> element was found and its names are known, false otherwise.
+ */
+static bool readGameState(tinyxml2::XMLDocument& doc, char& firstPlayer, GameMode& gameMode, Board& board, GameStatus& gameStatus) {
     XMLNode* root = doc.FirstChildElement("GameState");
     if (root == nullptr) {
-        cerr << "No <GameState> element found!" << endl;
-        return;
+        return false;
     }
     XMLElement* playerElement = root->FirstChildElement("Player");
     if (playerElement != nullptr) {
@@ -34,19 +103,21 @@ void parseGameStateXML(const string& filename, char& firstPlayer, string& gameMo
     XMLElement* gameTypeElement = root->FirstChildElement("GameType");
     if (gameTypeElement != nullptr) {
         const char* gameTypeText = gameTypeElement->GetText();
-        if (gameTypeText != nullptr) {
-            gameMode = gameTypeText;
+        if (gameTypeText != nullptr && !findGameMode(gameTypeText, strlen(gameTypeText), gameMode)) {
+            return false;
         }
     }
     XMLElement* boardElement = root->FirstChildElement("Board");
     if (boardElement != nullptr) {
+        XMLAtom rowAtom = doc.Atom("Row");
+        XMLAtom cellAtom = doc.Atom("Cell");
         int row = 0;
-        for (XMLElement* rowElement = boardElement->FirstChildElement("Row"); rowElement != nullptr; rowElement = rowElement->NextSiblingElement("Row")) {
+        for (XMLElement* rowElement = boardElement->FirstChildElement(rowAtom); rowElement != nullptr; rowElement = rowElement->NextSiblingElement(rowAtom)) {
             int col = 0;
-            for (XMLElement* cellElement = rowElement->FirstChildElement("Cell"); cellElement != nullptr; cellElement = cellElement->NextSiblingElement("Cell")) {
+            for (XMLElement* cellElement = rowElement->FirstChildElement(cellAtom); cellElement != nullptr; cellElement = cellElement->NextSiblingElement(cellAtom)) {
                 const char* cellText = cellElement->GetText();
-                if (cellText != nullptr && col < 3) {
-                    board[row][col] = cellText[0];
+                if (cellText != nullptr && row < 3 && col < 3) {
+                    board.at(row, col) = cellText[0];
                 }
                 col++;
             }
@@ -56,85 +127,145 @@ void parseGameStateXML(const string& filename, char& firstPlayer, string& gameMo
     XMLElement* statusElement = root->FirstChildElement("Status");
     if (statusElement != nullptr) {
         const char* statusText = statusElement->GetText();
-        if (statusText != nullptr) {
-            gameStatus = statusText;
+        if (statusText != nullptr && !findGameStatus(statusText, strlen(statusText), gameStatus)) {
+            return false;
         }
     }
+    return true;
 }
 
 /**
- * @brief Updates the game state in the XML file.
+ * @brief Parses the game state from an XML string held in memory.
  *
- * This function writes the current player, game type, and board state to an XML file. It creates or
- * overwrites the "game_state.xml" file with the updated information.
+ * The document is bound in a single pass by the schema-driven binder, without building a DOM,
+ * so a reply received from the server is applied without copying it or allocating memory.
+ * Documents that do not follow the game state schema exactly are rejected without a message,
+ * so the caller can fall back to parseGameStateInSitu.
  *
- * @param player The current player ('X' or 'O').
- * @param gameType The current game type (e.g., "Man vs Man").
- * @param board A 2D vector representing the current state of the game board.
+ * @param xml The XML document (e.g., a reply received from the server).
+ * @param firstPlayer Reference to a character where the next player ('X' or 'O') will be stored.
+ * @param gameMode Reference to the game mode.
+ * @param board Reference to the board receiving the cells.
+ * @param gameStatus Reference to the game status.
+ * @return true if the document was parsed, false otherwise.
  */
-void updateXML(const string& player, const string& gameType, const vector<vector<char>>& board) {
-    ofstream file("game_state.xml");
-    file << "<GameState><Player>" << player << "</Player><GameType>" << gameType << "</GameType><Board>";
-    for (int i = 0; i < 3; ++i) {
-        file << "<Row>";
-        for (int j = 0; j < 3; ++j) {
-            file << "<Cell>" << board[i][j] << "</Cell>";
-        }
-        file << "</Row>";
+bool parseGameState(const string& xml, char& firstPlayer, GameMode& gameMode, Board& board, GameStatus& gameStatus) {
+    GameState state;
+    BindError error;
+    if (!bindGameState(xml.data(), xml.size(), state, error)) {
+        return false;
     }
-    file << "</Board><Status>Start</Status></GameState>\n";
-    file.close();
+    firstPlayer = state.player;
+    gameMode = state.gameMode;
+    board = state.board;
+    gameStatus = state.status;
+    return true;
 }
 
 /**
- * @brief Creates a new game state XML file with initial values.
+ * @brief Parses the game state in place from a buffer that is consumed by the parse.
  *
- * This function generates a new XML file with the provided first player, game type, and board state.
- * The game status is set to "Start".
+ * The session document borrows the buffer with XMLDocument::ParseInSitu instead of copying it,
+ * and the game data is extracted before the function returns, so the document never outlives
+ * the buffer's contents. The buffer is modified and cannot be parsed again.
  *
- * @param filename The name of the XML file to create.
- * @param firstPlayer The first player ('X' or 'O').
- * @param gameMode The game type (e.g., "Man vs Man").
- * @param board A 2D vector representing the initial state of the game board.
+ * @param xml The XML document (e.g., a reply received from the server), modified by the parse.
+ * @param firstPlayer Reference to a character where the next player ('X' or 'O') will be stored.
+ * @param gameMode Reference to the game mode.
+ * @param board Reference to the board receiving the cells.
+ * @param gameStatus Reference to the game status.
+ * @return XMLError XML_SUCCESS if the document was parsed, the parse error if it is not well-formed
+ *         XML, or XML_ERROR_PARSING_ELEMENT if it has no <GameState> element or a field holds an unknown name.
  */
-void createGameStateXML(const string& filename, char firstPlayer, const string& gameMode, const vector<vector<char>>& board) {
-    ofstream file(filename);
-    if (file.is_open()) {
-        file << "<GameState><Player>" << firstPlayer << "</Player>"
-            << "<GameType>" << gameMode << "</GameType>"
-            << "<Board>";
-        for (const auto& row : board) {
-            file << "<Row>";
-            for (const auto& cell : row) {
-                file << "<Cell>" << cell << "</Cell>";
-            }
-            file << "</Row>";
-        }
-        file << "</Board><Status>Start</Status></GameState>\n";
-        file.close();
+XMLError parseGameStateInSitu(string& xml, char& firstPlayer, GameMode& gameMode, Board& board, GameStatus& gameStatus) {
+    tinyxml2::XMLDocument& doc = sessionDocument();
+    XMLError eResult = doc.ParseInSitu(&xml[0], xml.size());
+    if (eResult == XML_SUCCESS && !readGameState(doc, firstPlayer, gameMode, board, gameStatus)) {
+        eResult = XML_ERROR_PARSING_ELEMENT;
     }
-    else {
-        cerr << "Failed to create XML file!" << endl;
+    if (memoryStatsLogging) {
+        printMemoryStats(doc, "the game state");
     }
+    doc.Clear();
+    return eResult;
 }
 
 /**
- * @brief Reads the contents of a file and returns it as a string.
+ * @brief Serializes the game state into a reusable buffer.
  *
- * This function opens a specified file, reads its contents, and returns them as a single string.
+ * The buffer is cleared but keeps its capacity, so serializing every move into the same buffer
+ * does not allocate.
  *
- * @param fileName The name of the file to read.
- * @return string The contents of the file as a string.
+ * @param buffer The buffer receiving the XML document.
+ * @param player The current player ('X' or 'O').
+ * @param gameType The current game mode.
+ * @param board The current state of the game board.
+ * @param gameStatus The status to send (e.g., Start).
+ */
+void serializeGameState(string& buffer, char player, GameMode gameType, Board board, GameStatus gameStatus) {
+    buffer.clear();
+    buffer += "<GameState><Player>";
+    buffer += player;
+    buffer += "</Player><GameType>";
+    buffer += gameModeName(gameType);
+    buffer += "</GameType><Board>";
+    for (int i = 0; i < 3; ++i) {
+        buffer += "<Row>";
+        for (int j = 0; j < 3; ++j) {
+            buffer += "<Cell>";
+            buffer += board.at(i, j);
+            buffer += "</Cell>";
+        }
+        buffer += "</Row>";
+    }
+    buffer += "</Board><Status>";
+    buffer += gameStatusName(gameStatus);
+    buffer += "</Status></GameState>\n";
+}
+
+/**
+ * @brief Serializes the game state straight into a transmit buffer.
+ *
+ * The printer writes through to the buffer without staging, so nothing is allocated.
+ *
+ * @param buffer The transmit buffer.
+ * @param capacity The size of the transmit buffer.
+ * @param player The current player ('X' or 'O').
+ * @param gameType The current game mode.
+ * @param board The current state of the game board.
+ * @param gameStatus The status to send (e.g., Start).
+ * @return size_t The length of the document, or 0 if it does not fit in the buffer.
  */
-string readFileToString(const string& fileName) {
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
-        cerr << "File could not be opened: " << fileName << endl;
-        return "";
+size_t serializeGameState(char* buffer, size_t capacity, char player, GameMode gameType, Board board, GameStatus gameStatus) {
+    XMLBufferSink sink(buffer, capacity);
+    XMLPrinter printer(sink, true, 0, 0);
+    const char playerText[2] = { player, '\0' };
+    char cellText[2] = { EMPTY_CELL, '\0' };
+    printer.OpenElement("GameState", true);
+    printer.OpenElement("Player", true);
+    printer.PushText(playerText);
+    printer.CloseElement(true);
+    printer.OpenElement("GameType", true);
+    printer.PushText(gameModeName(gameType));
+    printer.CloseElement(true);
+    printer.OpenElement("Board", true);
+    for (int i = 0; i < 3; ++i) {
+        printer.OpenElement("Row", true);
+        for (int j = 0; j < 3; ++j) {
+            cellText[0] = board.at(i, j);
+            printer.OpenElement("Cell", true);
+            printer.PushText(cellText);
+            printer.CloseElement(true);
+        }
+        printer.CloseElement(true);
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    printer.CloseElement(true);
+    printer.OpenElement("Status", true);
+    printer.PushText(gameStatusName(gameStatus));
+    printer.CloseElement(true);
+    printer.CloseElement(true);
+    sink.Write("\n", 1);
+    return sink.Overflowed() ? 0 : sink.Size();
 }
 
 /**
@@ -166,11 +297,11 @@ char selectFirstPlayer() {
  * @brief Prompts the user to select the game mode.
  *
  * This function asks the user to choose the type of game to play, such as 'Man vs Man', 'Man vs AI',
- * 'AI vs Man', or 'AI vs AI'. It returns a string representing the selected game mode.
+ * 'AI vs Man', or 'AI vs AI'. It returns the selected game mode.
  *
- * @return string The selected game mode (e.g., "Man vs Man", "Man vs AI").
+ * @return GameMode The selected game mode.
  */
-string selectGameMode() {
+GameMode selectGameMode() {
     int gameModeChoice;
     cout << "=============================================\n";
     cout << "      	Game type:\n";
@@ -182,13 +313,13 @@ string selectGameMode() {
     cout << "\nPlease, enter your choice (1-4): ";
     cin >> gameModeChoice;
     switch (gameModeChoice) {
-    case 1: return "Man vs Man";
-    case 2: return "Man vs AI";
-    case 3: return "AI vs Man";
-    case 4: return "AI vs AI";
+    case 1: return GameMode::ManVsMan;
+    case 2: return GameMode::ManVsAI;
+    case 3: return GameMode::AIVsMan;
+    case 4: return GameMode::AIVsAI;
     default:
         cerr << "Invalid choice, defaulting to Man vs Man." << endl;
-        return "Man vs Man";
+        return GameMode::ManVsMan;
     }
 }
 
@@ -199,16 +330,17 @@ string selectGameMode() {
  * ('X' or 'O') on the board at the position determined by the move number (1-9). If the cell is already
  * occupied, the function returns `false`. Otherwise, it places the symbol and returns `true`.
  *
- * @param board A reference to a 2D vector representing the game board.
+ * @param board A reference to the game board.
  * @param move The move number (1-9) representing the position on the board where the player wants to place their symbol.
  * @param player The symbol of the player ('X' or 'O') making the move.
- * @return true if the move was successful (the cell was empty and the symbol was placed), false otherwise (if the cell was already occupied).
+ * @return true if the move was successful (the cell was empty and the symbol was placed), false otherwise (if the cell was already occupied or the move is out of range).
  */
-bool makeMove(vector<vector<char>>& board, int move, char player) {
-    int row = (move - 1) / 3;
-    int col = (move - 1) % 3;
-    if (board[row][col] == '_') {
-        board[row][col] = player;
+bool makeMove(Board& board, int move, char player) {
+    if (move < 1 || move > 9) {
+        return false;
+    }
+    if (board[move - 1] == EMPTY_CELL) {
+        board[move - 1] = player;
         return true;
     }
     else {
@@ -223,13 +355,13 @@ bool makeMove(vector<vector<char>>& board, int move, char player) {
  * with each cell containing either an 'X', 'O', or an empty space ('_'). The board is visually formatted
  * with lines separating the rows and columns for easier readability. The cells are colorized with green text.
  *
- * @param board A constant reference to a 2D vector representing the Tic-Tac-Toe game board.
+ * @param board The Tic-Tac-Toe game board.
  */
-void printBoard(const vector<vector<char>>& board) {
+void printBoard(Board board) {
     cout << "\n=============================================\n";
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < 3; ++j) {
-            cout << "\033[32m" << " " << board[i][j] << " " << "\033[0m";
+            cout << "\033[32m" << " " << board.at(i, j) << " " << "\033[0m";
             if (j < 2) cout << "|";
         }
         cout << "\n";
@@ -238,4 +370,148 @@ void printBoard(const vector<vector<char>>& board) {
         }
     }
     cout << "=============================================\n";
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Converts a board to the packed game state used by the shared rules.
+ *
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param player The player to move ('X' or 'O').
+ * @param mode The game mode.
+ * @param status The game status.
+ * @return CoreState The game state.
+ */
+CoreState toCoreState(Board board, char player, GameMode mode, GameStatus status) {
+    CoreState state = { 0, 0, player, mode, status };
+    for (uint8_t cell = 0; cell < 9; ++cell) {
+        setCellSymbol(state, cell, board[cell]);
+    }
+    return state;
+}
+
+/**
+ * @brief Determines the status of a board with the rules the server plays by.
+ *
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @return GameStatus Win X or Win O if a player has a line, Draw if the board is full, NextMove otherwise.
+ */
+GameStatus boardStatus(Board board) {
+    return evaluateBoard(toCoreState(board, 'X', GameMode::ManVsMan, GameStatus::NextMove));
+}
+
+/**
+ * @brief Builds a request asking the server to play complete AI vs AI games.
+ *
+ * The request is three bytes: MSG_PLAY_GAMES, the first player and the number of games.
+ *
+ * @param firstPlayer The player who moves first in every game ('X' or 'O').
+ * @param count The number of games to play (1 to PLAY_GAMES_MAX).
+ * @return string The binary request message.
+ */
+string encodePlayGamesRequest(char firstPlayer, int count) {
+    string request;
+    request += static_cast<char>(MSG_PLAY_GAMES);
+    request += firstPlayer;
+    request += static_cast<char>(count);
+    return request;
+}
+
+/**
+ * @brief Decodes the server's response to a MSG_PLAY_GAMES request.
+ *
+ * The response is MSG_PLAY_GAMES and the number of games, followed by one record per game: a header
+ * byte (status code in bits 7-6, first player in bit 4 with 1 for 'O', move count in bits 3-0) and
+ * the cell indices of the moves packed two per byte, high nibble first.
+ *
+ * @param message The response message.
+ * @param games The vector receiving one record per game played.
+ * @return true if the response was well formed, false otherwise.
+ */
+bool decodeGameRecords(const string& message, vector<GameRecord>& games) {
+    if (message.size() < 2 || static_cast<uint8_t>(message[0]) != MSG_PLAY_GAMES) {
+        return false;
+    }
+    size_t count = static_cast<uint8_t>(message[1]);
+    size_t pos = 2;
+    games.clear();
+    games.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (pos >= message.size()) {
+            return false;
+        }
+        uint8_t header = static_cast<uint8_t>(message[pos++]);
+        GameRecord game;
+        game.firstPlayer = (header & 0x10) ? 'O' : 'X';
+        game.status = static_cast<GameStatus>(header >> 6);
+        game.moveCount = header & 0x0F;
+        if (game.moveCount > 9 || pos + (game.moveCount + 1) / 2 > message.size()) {
+            return false;
+        }
+        for (int move = 0; move < game.moveCount; ++move) {
+            uint8_t packed = static_cast<uint8_t>(message[pos + move / 2]);
+            game.moves[move] = (move % 2 == 0) ? (packed >> 4) : (packed & 0x0F);
+        }
+        pos += (game.moveCount + 1) / 2;
+        games.push_back(game);
+    }
+    return pos == message.size();
+}
+
+/**
+ * @brief Builds a request asking the server to evaluate a batch of positions.
+ *
+ * The request is MSG_EVAL_BATCH and the number of positions, followed by 3 bytes per position:
+ * a 24-bit big-endian value with 2 bits per cell (cell i in bits 2i+1..2i; 0 empty, 1 'X', 2 'O')
+ * and the side to move in bit 18 (1 for 'O').
+ *
+ * @param positions The positions to evaluate (at most EVAL_BATCH_MAX).
+ * @return string The binary request message.
+ */
+string encodeEvalBatchRequest(const vector<Position>& positions) {
+    string request;
+    request.reserve(2 + positions.size() * 3);
+    request += static_cast<char>(MSG_EVAL_BATCH);
+    request += static_cast<char>(positions.size());
+    for (const Position& position : positions) {
+        uint32_t value = (position.sideToMove == 'O') ? 0x40000u : 0;
+        for (int cell = 0; cell < 9; ++cell) {
+            char symbol = position.board[cell];
+            uint32_t code = (symbol == 'X') ? 1u : (symbol == 'O') ? 2u : 0u;
+            value |= code << (cell * 2);
+        }
+        request += static_cast<char>(value >> 16);
+        request += static_cast<char>(value >> 8);
+        request += static_cast<char>(value);
+    }
+    return request;
+}
+
+/**
+ * @brief Decodes the server's response to a MSG_EVAL_BATCH request.
+ *
+ * The response is MSG_EVAL_BATCH and the number of positions, followed by one byte per position
+ * with the status code in bits 7-6 and the AI's move in bits 3-0 (0x0F if the game is over).
+ *
+ * @param message The response message.
+ * @param evaluations The vector receiving one evaluation per position, in request order.
+ * @return true if the response was well formed, false otherwise.
+ */
+bool decodeEvaluations(const string& message, vector<Evaluation>& evaluations) {
+    if (message.size() < 2 || static_cast<uint8_t>(message[0]) != MSG_EVAL_BATCH) {
+        return false;
+    }
+    size_t count = static_cast<uint8_t>(message[1]);
+    if (message.size() != 2 + count) {
+        return false;
+    }
+    evaluations.clear();
+    evaluations.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t packed = static_cast<uint8_t>(message[2 + i]);
+        Evaluation evaluation;
+        evaluation.status = static_cast<GameStatus>(packed >> 6);
+        evaluation.move = ((packed & 0x0F) < 9) ? (packed & 0x0F) : -1;
+        evaluations.push_back(evaluation);
+    }
+    return true;
+}
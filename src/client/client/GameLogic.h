@@ -4,63 +4,194 @@
  */
 
 #pragma once
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 #include "tinyxml2.h"
+#include "../../server/TicTacToeCore.h"
 
 using namespace std;
 using namespace tinyxml2;
 
 /**
- * @brief Parses the game state from an XML file.
+ * @brief Binary request types understood by the server. XML requests always start with '<'.
+ */
+#define MSG_PLAY_GAMES      0x01
+#define MSG_EVAL_BATCH      0x02
+
+/**
+ * @brief Maximum number of games the server plays per MSG_PLAY_GAMES request.
+ */
+#define PLAY_GAMES_MAX      60
+
+/**
+ * @brief Maximum number of positions per MSG_EVAL_BATCH request.
+ */
+#define EVAL_BATCH_MAX      120
+
+/**
+ * @brief Symbol of an empty cell.
+ */
+#define EMPTY_CELL          '_'
+
+/**
+ * @brief Size of the transmit buffer a game state is serialized into.
+ */
+#define GAME_STATE_TX_SIZE  512
+
+/**
+ * @brief The 3x3 game board stored as nine contiguous cells in row-major order.
  *
- * This function loads an XML file containing the game state and parses the relevant details,
- * including the first player, the game mode, the current board state, and the game status.
+ * Board is a trivially copyable value type, so it is passed and stored by value without
+ * any heap allocation. Cells are addressed either by index (0-8, row * 3 + column) or by row and column.
+ */
+struct Board {
+    array<char, 9> cells;   ///< The cells ('X', 'O', '_'), row by row.
+
+    /**
+     * @brief Returns the cell at the given index (0-8).
+     */
+    constexpr char operator[](int cell) const { return cells[cell]; }
+
+    /**
+     * @brief Returns a reference to the cell at the given index (0-8).
+     */
+    char& operator[](int cell) { return cells[cell]; }
+
+    /**
+     * @brief Returns the cell at the given row and column (0-2).
+     */
+    constexpr char at(int row, int col) const { return cells[row * 3 + col]; }
+
+    /**
+     * @brief Returns a reference to the cell at the given row and column (0-2).
+     */
+    char& at(int row, int col) { return cells[row * 3 + col]; }
+};
+
+static_assert(is_trivially_copyable<Board>::value, "Board must stay trivially copyable");
+
+/**
+ * @brief Returns a board with every cell empty.
  *
- * @param filename The path to the XML file to load.
- * @param firstPlayer The player who will make the first move ('X' or 'O').
- * @param gameMode The type of game being played (e.g., "Man vs Man", "AI vs Man").
- * @param board The 3x3 game board represented as a 2D vector of characters ('X', 'O', '_').
- * @param gameStatus The current status of the game (e.g., "Start", "Game Over").
+ * @return The empty board.
+ */
+constexpr Board emptyBoard() {
+    return Board{ { { EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL } } };
+}
+
+/**
+ * @brief A complete game played by the server, as a sequence of moves.
+ */
+struct GameRecord {
+    char firstPlayer;   ///< The player who moved first ('X' or 'O').
+    GameStatus status;  ///< The final status of the game (Win X, Win O or Draw).
+    int moveCount;      ///< Number of moves played.
+    int moves[9];       ///< Cell index (0-8, row * 3 + column) of each move in order.
+};
+
+/**
+ * @brief A position to be evaluated by the server.
  */
-void parseGameStateXML(const string& filename, char& firstPlayer, string& gameMode, vector<vector<char>>& board, string& gameStatus);
+struct Position {
+    Board board;        ///< The 3x3 board ('X', 'O', '_').
+    char sideToMove;    ///< The player to move ('X' or 'O').
+};
 
 /**
- * @brief Updates the XML file with the current game state.
+ * @brief The server's evaluation of a position.
+ */
+struct Evaluation {
+    GameStatus status;  ///< The status of the position (NextMove, Win X, Win O or Draw).
+    int move;           ///< The cell index (0-8) the AI would play, or -1 if the game is over.
+};
+
+/**
+ * @brief Enables or disables printing the memory statistics of the session document after every parse.
  *
- * This function writes the updated game state (current player, game type, board) to an XML file.
+ * @param enabled true to print the statistics, false otherwise.
+ */
+void setMemoryStatsLogging(bool enabled);
+
+/**
+ * @brief Tells whether the memory statistics of the XML documents are printed.
  *
- * @param player The current player ('X' or 'O').
- * @param gameType The type of game being played (e.g., "Man vs Man", "AI vs Man").
- * @param board The 3x3 game board represented as a 2D vector of characters ('X', 'O', '_').
+ * @return true if the statistics are printed, false otherwise.
+ */
+bool memoryStatsLoggingEnabled();
+
+/**
+ * @brief Prints the memory held by an XML document, pool by pool.
+ *
+ * @param doc The XML document.
+ * @param label The name of the document printed in the title.
+ */
+void printMemoryStats(const tinyxml2::XMLDocument& doc, const string& label);
+
+/**
+ * @brief Parses the game state from an XML string held in memory.
+ *
+ * This function parses the XML directly from the given buffer, without touching the filesystem.
+ * Only documents that follow the game state schema are accepted.
+ *
+ * @param xml The XML document (e.g., a reply received from the server).
+ * @param firstPlayer The player who will make the next move ('X' or 'O').
+ * @param gameMode The game mode.
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The current status of the game.
+ * @return true if the document was parsed, false otherwise.
  */
-void updateXML(const string& player, const string& gameType, const vector<vector<char>>& board);
+bool parseGameState(const string& xml, char& firstPlayer, GameMode& gameMode, Board& board, GameStatus& gameStatus);
 
 /**
- * @brief Creates a new XML file with the initial game state.
+ * @brief Parses the game state in place from a buffer that is consumed by the parse.
  *
- * This function creates an XML file containing the initial game state with player settings,
- * game type, and an empty 3x3 game board.
+ * The XML is parsed inside the given buffer without copying it, so the buffer is modified and
+ * cannot be parsed again.
  *
- * @param filename The path to the XML file to create.
- * @param firstPlayer The player who will make the first move ('X' or 'O').
- * @param gameMode The type of game being played (e.g., "Man vs Man", "AI vs Man").
- * @param board The 3x3 game board represented as a 2D vector of characters ('X', 'O', '_').
+ * @param xml The XML document (e.g., a reply received from the server), modified by the parse.
+ * @param firstPlayer The player who will make the next move ('X' or 'O').
+ * @param gameMode The game mode.
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The current status of the game.
+ * @return XML_SUCCESS if the document was parsed, the parse error if it is not well-formed XML,
+ *         or XML_ERROR_PARSING_ELEMENT if it has no <GameState> element or a field holds an unknown name.
  */
-void createGameStateXML(const string& filename, char firstPlayer, const string& gameMode, const vector<vector<char>>& board);
+XMLError parseGameStateInSitu(string& xml, char& firstPlayer, GameMode& gameMode, Board& board, GameStatus& gameStatus);
 
 /**
- * @brief Reads the contents of a file into a string.
+ * @brief Serializes the game state into a reusable buffer.
  *
- * This function reads the entire content of the given file and returns it as a string.
+ * The buffer is cleared but keeps its capacity, so repeated calls do not allocate.
  *
- * @param fileName The path to the file to read.
- * @return The contents of the file as a string.
+ * @param buffer The buffer receiving the XML document.
+ * @param player The current player ('X' or 'O').
+ * @param gameType The game mode.
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The status to send (e.g., Start).
  */
-string readFileToString(const string& fileName);
+void serializeGameState(string& buffer, char player, GameMode gameType, Board board, GameStatus gameStatus);
+
+/**
+ * @brief Serializes the game state straight into a transmit buffer.
+ *
+ * Produces the same document as the string overload, printed by an XMLPrinter into the buffer
+ * without an intermediate string.
+ *
+ * @param buffer The transmit buffer.
+ * @param capacity The size of the transmit buffer.
+ * @param player The current player ('X' or 'O').
+ * @param gameType The game mode.
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The status to send (e.g., Start).
+ * @return The length of the document, or 0 if it does not fit in the buffer.
+ */
+size_t serializeGameState(char* buffer, size_t capacity, char player, GameMode gameType, Board board, GameStatus gameStatus);
 
 /**
  * @brief Prompts the user to select which player goes first.
@@ -76,9 +207,9 @@ char selectFirstPlayer();
  *
  * This function allows the user to choose the game mode (e.g., "Man vs Man", "AI vs Man").
  *
- * @return The selected game mode as a string.
+ * @return The selected game mode.
  */
-string selectGameMode();
+GameMode selectGameMode();
 
 /**
  * @brief Makes a move on the Tic-Tac-Toe board.
@@ -87,12 +218,12 @@ string selectGameMode();
  * ('X' or 'O') on the board at the position determined by the move number (1-9). If the cell is already
  * occupied, the function returns `false`. Otherwise, it places the symbol and returns `true`.
  *
- * @param board A reference to a 2D vector representing the game board.
+ * @param board A reference to the game board.
  * @param move The move number (1-9) representing the position on the board where the player wants to place their symbol.
  * @param player The symbol of the player ('X' or 'O') making the move.
- * @return true if the move was successful (the cell was empty and the symbol was placed), false otherwise (if the cell was already occupied).
+ * @return true if the move was successful (the cell was empty and the symbol was placed), false otherwise (if the cell was already occupied or the move is out of range).
  */
-bool makeMove(vector<vector<char>>& board, int move, char player);
+bool makeMove(Board& board, int move, char player);
 
 /**
  * @brief Prints the current state of the Tic-Tac-Toe board.
@@ -101,6 +232,60 @@ bool makeMove(vector<vector<char>>& board, int move, char player);
  * with each cell containing either an 'X', 'O', or an empty space ('_'). The board is visually formatted
  * with lines separating the rows and columns for easier readability. The cells are colorized with green text.
  *
- * @param board A constant reference to a 2D vector representing the Tic-Tac-Toe game board.
+ * @param board The Tic-Tac-Toe game board.
+ */
+void printBoard(Board board);
+
+/**
+ * @brief Converts a board to the packed game state used by the shared rules.
+ *
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param player The player to move ('X' or 'O').
+ * @param mode The game mode.
+ * @param status The game status.
+ * @return The game state.
+ */
+CoreState toCoreState(Board board, char player, GameMode mode, GameStatus status);
+
+/**
+ * @brief Determines the status of a board with the rules the server plays by.
+ *
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @return Win X or Win O if a player has a line, Draw if the board is full, NextMove otherwise.
+ */
+GameStatus boardStatus(Board board);
+
+/**
+ * @brief Builds a request asking the server to play complete AI vs AI games.
+ *
+ * @param firstPlayer The player who moves first in every game ('X' or 'O').
+ * @param count The number of games to play (1 to PLAY_GAMES_MAX).
+ * @return The binary request message.
+ */
+string encodePlayGamesRequest(char firstPlayer, int count);
+
+/**
+ * @brief Decodes the server's response to a MSG_PLAY_GAMES request.
+ *
+ * @param message The response message.
+ * @param games The vector receiving one record per game played.
+ * @return true if the response was well formed, false otherwise.
+ */
+bool decodeGameRecords(const string& message, vector<GameRecord>& games);
+
+/**
+ * @brief Builds a request asking the server to evaluate a batch of positions.
+ *
+ * @param positions The positions to evaluate (at most EVAL_BATCH_MAX).
+ * @return The binary request message.
+ */
+string encodeEvalBatchRequest(const vector<Position>& positions);
+
+/**
+ * @brief Decodes the server's response to a MSG_EVAL_BATCH request.
+ *
+ * @param message The response message.
+ * @param evaluations The vector receiving one evaluation per position, in request order.
+ * @return true if the response was well formed, false otherwise.
  */
-void printBoard(const vector<vector<char>>& board);
\ No newline at end of file
+bool decodeEvaluations(const string& message, vector<Evaluation>& evaluations);
@@ -7,11 +7,85 @@
  * including "Man vs Man", "Man vs AI", "AI vs Man", and "AI vs AI".
  */
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include "Windows.h"
 #include "SerialPort.h"
 #include "GameLogic.h"
+#include "GameStateDocument.h"
+#include "GameJournal.h"
+#include "GameArchive.h"
+#include "GameStats.h"
+
+ /**
+  * @brief Sends the game state to the server and applies its reply.
+  *
+  * The request is sent straight from the cached serialization of the game state document and the reply is
+  * received into a reusable buffer and bound from there without a DOM, so the move path neither
+  * touches the filesystem nor copies the request or the reply. A well-formed reply that the binder
+  * does not accept (comments, attributes, entities) is parsed in place by the session document instead.
+  * The status of the reply is checked against its board with the rules the server plays by.
+  *
+  * @param comPort Handle to the serial port.
+  * @param request The serialized game state.
+  * @param requestLength The length of the serialized game state, 0 if it could not be serialized.
+  * @param reply The buffer receiving the server's reply.
+  * @param player Receives the next player from the reply.
+  * @param gameMode Receives the game mode from the reply.
+  * @param board Receives the board from the reply.
+  * @param gameStatus Receives the game status from the reply.
+  * @return true if the exchange succeeded and the reply was parsed, false otherwise.
+  */
+static bool exchangeGameState(HANDLE comPort, const char* request, size_t requestLength, string& reply,
+	char& player, GameMode& gameMode, Board& board, GameStatus& gameStatus) {
+	if (requestLength == 0) {
+		cerr << "\n\033[31m      Game state could not be serialized! \033[0m" << endl;
+		return false;
+	}
+	if (!sendMessage(comPort, request, requestLength) || !readMessage(comPort, reply)) {
+		cerr << "\n\033[31m      No reply from the server! \033[0m" << endl;
+		return false;
+	}
+	if (reply.compare(0, 6, "Error:") == 0) {
+		cerr << "\n\033[31m      The server rejected the game state: " << reply.substr(min<size_t>(7, reply.size())) << " \033[0m" << endl;
+		return false;
+	}
+	if (!parseGameState(reply, player, gameMode, board, gameStatus)) {
+		XMLError error = parseGameStateInSitu(reply, player, gameMode, board, gameStatus);
+		if (error != XML_SUCCESS) {
+			cerr << "\n\033[31m      The reply is not a valid game state: " << tinyxml2::XMLDocument::ErrorIDToName(error) << " \033[0m" << endl;
+			return false;
+		}
+	}
+	if (gameStatus != boardStatus(board)) {
+		cerr << "\n\033[31m      The status of the reply does not match its board! \033[0m" << endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Ends a game that cannot continue because an exchange with the server failed.
+ *
+ * The failed move is not journaled, so a resumed game starts from the last state the server accepted.
+ *
+ * @param comPort Handle to the serial port.
+ * @param journal The game journal.
+ * @param saveState true if the game is being journaled.
+ * @return int The exit code of the program.
+ */
+static int abortGame(HANDLE comPort, GameJournal& journal, bool saveState) {
+	cout << "\n=============================================\n";
+	cerr << "\033[31m      The game was stopped. \033[0m" << endl;
+	cout << "=============================================\n";
+	CloseHandle(comPort);
+	if (saveState) {
+		closeJournal(journal);
+	}
+	return 1;
+}
 
  /**
   * @brief Main function that runs the Tic-Tac-Toe game.
@@ -20,58 +94,153 @@
   * It interacts with the player, makes moves, updates the game board, communicates
   * with the serial port, and displays the results.
   *
+  * Passing --save-state on the command line records every move in the game journal and
+  * offers to resume an unfinished game found there. Passing --export-game <id> [file] writes
+  * a game from the journal to an XML file (game_state.xml by default) and exits.
+  *
+  * The game archive is maintained with --archive-append <journal>, which appends the finished
+  * games of a journal and rebuilds the index, --archive-game <id>, which prints an archived game,
+  * and --archive-query <status> [limit], which lists the archived games with the given outcome.
+  * --stats [journal] prints outcome rates over the archive, or over the given journal.
+  * --memory-stats prints the memory held by the XML documents after they are built or parsed.
+  *
+  * @param argc Number of command-line arguments.
+  * @param argv Command-line arguments.
   * @return int Exit code.
   */
 
-int main() {
+int main(int argc, char* argv[]) {
+	bool saveState = false;
+	for (int i = 1; i < argc; ++i) {
+		if (string(argv[i]) == "--save-state") {
+			saveState = true;
+		}
+		else if (string(argv[i]) == "--memory-stats") {
+			setMemoryStatsLogging(true);
+		}
+		else if (string(argv[i]) == "--export-game" && i + 1 < argc) {
+			uint32_t gameId = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			string xmlFile = (i + 2 < argc) ? argv[i + 2] : "game_state.xml";
+			return exportGameXML(JOURNAL_FILE, gameId, xmlFile) ? 0 : 1;
+		}
+		else if (string(argv[i]) == "--archive-append" && i + 1 < argc) {
+			uint32_t appended = 0;
+			if (!appendJournalToArchive(argv[i + 1], ARCHIVE_FILE, appended) || !buildArchiveIndex(ARCHIVE_FILE, ARCHIVE_INDEX_FILE)) {
+				return 1;
+			}
+			cout << "      " << appended << " games appended to the archive\n";
+			return 0;
+		}
+		else if (string(argv[i]) == "--archive-game" && i + 1 < argc) {
+			uint32_t gameId = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			return printArchivedGame(ARCHIVE_FILE, ARCHIVE_INDEX_FILE, gameId) ? 0 : 1;
+		}
+		else if (string(argv[i]) == "--stats") {
+			GameColumns columns;
+			bool loaded = (i + 1 < argc) ? loadColumnsFromJournal(argv[i + 1], columns) : loadColumnsFromArchive(ARCHIVE_FILE, ARCHIVE_INDEX_FILE, columns);
+			if (!loaded) {
+				return 1;
+			}
+			printGameStats(columns);
+			return 0;
+		}
+		else if (string(argv[i]) == "--archive-query" && i + 1 < argc) {
+			uint32_t limit = (i + 2 < argc) ? static_cast<uint32_t>(strtoul(argv[i + 2], nullptr, 10)) : 20;
+			GameStatus outcome;
+			if (!findGameStatus(argv[i + 1], strlen(argv[i + 1]), outcome)) {
+				cerr << "Unknown outcome: " << argv[i + 1] << endl;
+				return 1;
+			}
+			return queryArchive(ARCHIVE_FILE, ARCHIVE_INDEX_FILE, outcome, limit) ? 0 : 1;
+		}
+	}
+
 	cout << "\n\n=============================================\n\n";
 	cout << "      Welcome to \"Tic - tac - toe\" \n";
 	cout << "\n=============================================\n";
 
 	wstring portName = selectPort();
-	DWORD baudRate = selectBaudRate();
+	DWORD maxBaudRate = selectBaudRate();
 	cout << "\033[2J\033[H";
 
-	char firstPlayer = selectFirstPlayer();
-	string gameMode = selectGameMode();
+	HANDLE comPort = openSerialPort(portName, BASE_BAUD_RATE);
+	if (comPort == INVALID_HANDLE_VALUE) {
+		cout << "\033[2J\033[H";
+		cout << "=============================================\n";
+		cerr << "\n\033[31m      Error opening com-port! \033[0m" << endl;
+		cout << "\n=============================================\n";
+		return 1;
+	}
+
+	GameJournal journal;
+	JournalGame recovered;
+	bool resumed = false;
+	if (saveState && !openJournal(journal, JOURNAL_FILE)) {
+		saveState = false;
+	}
+	if (saveState && recoverLastGame(journal, recovered) && recovered.status == GameStatus::NextMove &&
+		(recovered.gameMode == GameMode::ManVsMan || recovered.gameMode == GameMode::ManVsAI)) {
+		char answer;
+		cout << "=============================================\n";
+		cout << "      Unfinished game #" << recovered.gameId << " (" << gameModeName(recovered.gameMode) << ")";
+		printBoard(recovered.board);
+		cout << "Resume it? (y/n): ";
+		cin >> answer;
+		resumed = (answer == 'y' || answer == 'Y');
+		cout << "\033[2J\033[H";
+	}
+
+	char firstPlayer;
+	GameMode gameMode;
+	if (resumed) {
+		gameMode = recovered.gameMode;
+		firstPlayer = (gameMode == GameMode::ManVsMan) ? otherPlayer(recovered.lastPlayer) : recovered.firstPlayer;
+	}
+	else {
+		firstPlayer = selectFirstPlayer();
+		gameMode = selectGameMode();
+	}
+
+	DWORD baudRate = negotiateBaudRate(comPort, maxBaudRate);
 
 	cout << "\033[2J\033[H";
 	cout << "\n=============================================\n";
 	cout << "      " << firstPlayer << " goes first\n";
 	cout << "=============================================\n";
 	cout << "\n=============================================\n";
-	cout << "      Selected Game Mode: " << gameMode << "\n";
+	cout << "      Selected Game Mode: " << gameModeName(gameMode) << "\n";
+	cout << "=============================================\n";
+	cout << "\n=============================================\n";
+	cout << "      Link speed: " << baudRate << " bps\n";
 	cout << "=============================================\n";
 
-	vector<vector<char>> board = {
-		{'_', '_', '_'},
-		{'_', '_', '_'},
-		{'_', '_', '_'}
-	};
-	string filename = "game_state.xml";
-	createGameStateXML(filename, firstPlayer, gameMode, board);
+	Board board = resumed ? recovered.board : emptyBoard();
+	GameStateDocument request;
+	string reply;
+	size_t requestLength = initGameStateDocument(request, firstPlayer, gameMode, board, GameStatus::Start);
+	if (memoryStatsLoggingEnabled()) {
+		printMemoryStats(request.dom, "the game state document");
+	}
+	if (resumed) {
+		resumeJournalGame(journal, recovered);
+	}
+	else if (saveState) {
+		startJournalGame(journal, gameMode);
+	}
 
-	if (gameMode == "Man vs Man") {
-		string gameStatus = "Start";
+	if (gameMode == GameMode::ManVsMan) {
+		GameStatus gameStatus = GameStatus::Start;
 		cout << "\n=============================================\n";
 		cout << "      Hints for selecting cells";
-		vector<vector<char>> boardAbout = {
-			{'1', '2', '3'},
-			{'4', '5', '6'},
-			{'7', '8', '9'}
-		};
+		Board boardAbout = { {
+			'1', '2', '3',
+			'4', '5', '6',
+			'7', '8', '9'
+		} };
 		printBoard(boardAbout);
 		cout << "      Board:";
 		printBoard(board);
-		while (gameStatus != "Win X" && gameStatus != "Win O" && gameStatus != "Draw") {
-			HANDLE comPort = openSerialPort(portName, baudRate);
-			if (comPort == INVALID_HANDLE_VALUE) {
-				cout << "\033[2J\033[H";
-				cout << "=============================================\n";
-				cerr << "\n\033[31m      Error opening com-port! \033[0m" << endl;
-				cout << "\n=============================================\n";
-				return 1;
-			}
+		while (!isGameOver(gameStatus)) {
 			int move;
 			cout << "      Please, " << firstPlayer << " enter your move(1 - 9) : ";
 			cin >> move;
@@ -79,7 +248,6 @@ int main() {
 			if (!makeMove(board, move, firstPlayer)) {
 				cout << "\033[31m      Cell already occupied! \033[0m" << endl;
 				cout << "=============================================\n";
-				CloseHandle(comPort);
 				continue;
 
 			}
@@ -87,39 +255,31 @@ int main() {
 			cout << "=============================================\n";
 			cout << "      Board:";
 			printBoard(board);
-			updateXML(std::string(1, firstPlayer), gameMode, board);
-			sendMessage(comPort, readFileToString("game_state.xml"));
-			ofstream file("game_state.xml");
-			file << readMessage(comPort);
-			file.close();
-			parseGameStateXML("game_state.xml", firstPlayer, gameMode, board, gameStatus);
-			CloseHandle(comPort);
+			requestLength = updateGameStateDocument(request, firstPlayer, board, GameStatus::Start);
+			if (!exchangeGameState(comPort, request.xml, requestLength, reply, firstPlayer, gameMode, board, gameStatus)) {
+				return abortGame(comPort, journal, saveState);
+			}
+			if (saveState) {
+				journalBoard(journal, board, move - 1, gameStatus);
+			}
 		}
 		cout << "\n\033[32m============================================= \033[0m\n";
-		cout << "\033[32m   \033[0m               \033[32m" << gameStatus << "\033[0m\n";
+		cout << "\033[32m   \033[0m               \033[32m" << gameStatusName(gameStatus) << "\033[0m\n";
 		cout << "\033[32m============================================= \033[0m\n";
 	}
-	else if (gameMode == "Man vs AI") {
-		string gameStatus = "Start";
+	else if (gameMode == GameMode::ManVsAI) {
+		GameStatus gameStatus = GameStatus::Start;
 		cout << "\n=============================================\n";
 		cout << "      Hints for selecting cells";
-		vector<vector<char>> boardAbout = {
-			{'1', '2', '3'},
-			{'4', '5', '6'},
-			{'7', '8', '9'}
-		};
+		Board boardAbout = { {
+			'1', '2', '3',
+			'4', '5', '6',
+			'7', '8', '9'
+		} };
 		printBoard(boardAbout);
 		cout << "      Board:";
 		printBoard(board);
-		while (gameStatus != "Win X" && gameStatus != "Win O" && gameStatus != "Draw") {
-			HANDLE comPort = openSerialPort(portName, baudRate);
-			if (comPort == INVALID_HANDLE_VALUE) {
-				cout << "\033[2J\033[H";
-				cout << "=============================================\n";
-				cerr << "\n\033[31m      Error opening com-port! \033[0m" << endl;
-				cout << "\n=============================================\n";
-				return 1;
-			}
+		while (!isGameOver(gameStatus)) {
 			int move;
 			cout << "      Enter your move (1-9): ";
 			cin >> move;
@@ -127,7 +287,6 @@ int main() {
 			if (!makeMove(board, move, firstPlayer)) {
 				cout << "\033[31m      Cell already occupied! \033[0m" << endl;
 				cout << "=============================================\n";
-				CloseHandle(comPort);
 				continue;
 
 			}
@@ -135,57 +294,50 @@ int main() {
 			cout << "=============================================\n";
 			cout << "      Board:";
 			printBoard(board);
-			updateXML(std::string(1, firstPlayer), gameMode, board);
-			sendMessage(comPort, readFileToString("game_state.xml"));
-			ofstream file("game_state.xml");
-			file << readMessage(comPort);
-			file.close();
-			parseGameStateXML("game_state.xml", firstPlayer, gameMode, board, gameStatus);
+			requestLength = updateGameStateDocument(request, firstPlayer, board, GameStatus::Start);
+			if (!exchangeGameState(comPort, request.xml, requestLength, reply, firstPlayer, gameMode, board, gameStatus)) {
+				return abortGame(comPort, journal, saveState);
+			}
+			if (saveState) {
+				journalBoard(journal, board, move - 1, gameStatus);
+			}
 			cout << "\033[2J\033[H";
 			cout << "\n=============================================\n";
 			cout << "      AI has made a move \n";
 			cout << "=============================================\n";
 			printBoard(board);
-			CloseHandle(comPort);
 		}
 		cout << "\n\033[32m============================================= \033[0m\n";
-		cout << "\033[32m   \033[0m               \033[32m" << gameStatus << "\033[0m\n";
+		cout << "\033[32m   \033[0m               \033[32m" << gameStatusName(gameStatus) << "\033[0m\n";
 		cout << "\033[32m============================================= \033[0m\n";
 	}
-	else if (gameMode == "AI vs Man") {
-		string gameStatus = "Start";
+	else if (gameMode == GameMode::AIVsMan) {
+		GameStatus gameStatus = GameStatus::Start;
 		cout << "\n=============================================\n";
 		cout << "      Hints for selecting cells";
-		vector<vector<char>> boardAbout = {
-			{'1', '2', '3'},
-			{'4', '5', '6'},
-			{'7', '8', '9'}
-		};
+		Board boardAbout = { {
+			'1', '2', '3',
+			'4', '5', '6',
+			'7', '8', '9'
+		} };
 		printBoard(boardAbout);
 		cout << "      Board:";
 		printBoard(board);
-		while (gameStatus != "Win X" && gameStatus != "Win O" && gameStatus != "Draw") {
-			HANDLE comPort = openSerialPort(portName, baudRate);
-			if (comPort == INVALID_HANDLE_VALUE) {
-				cout << "\033[2J\033[H";
-				cout << "=============================================\n";
-				cerr << "\n\033[31m      Error opening com-port! \033[0m" << endl;
-				cout << "\n=============================================\n";
-				return 1;
+		int move = 0;
+		while (!isGameOver(gameStatus)) {
+			if (!exchangeGameState(comPort, request.xml, requestLength, reply, firstPlayer, gameMode, board, gameStatus)) {
+				return abortGame(comPort, journal, saveState);
+			}
+			if (saveState) {
+				journalBoard(journal, board, move - 1, gameStatus);
 			}
-			sendMessage(comPort, readFileToString("game_state.xml"));
-			ofstream file("game_state.xml");
-			file << readMessage(comPort);
-			file.close();
-			parseGameStateXML("game_state.xml", firstPlayer, gameMode, board, gameStatus);
 			cout << "\033[2J\033[H";
 			cout << "\n=============================================\n";
 			cout << "      AI has made a move \n";
 			cout << "=============================================\n";
 			printBoard(board);
-			int move;
 			bool validMove = false;
-			if (gameStatus == "Win X" || gameStatus == "Win O" || gameStatus == "Draw") {
+			if (isGameOver(gameStatus)) {
 				break;
 			}
 			while (!validMove) {
@@ -206,49 +358,51 @@ int main() {
 
 			printBoard(board);
 			firstPlayer = (firstPlayer == 'X') ? 'O' : 'X';
-			updateXML(std::string(1, firstPlayer), gameMode, board);
+			requestLength = updateGameStateDocument(request, firstPlayer, board, GameStatus::Start);
 
-			CloseHandle(comPort);
 		}
 		cout << "\n\033[32m============================================= \033[0m\n";
-		cout << "\033[32m   \033[0m               \033[32m" << gameStatus << "\033[0m\n";
+		cout << "\033[32m   \033[0m               \033[32m" << gameStatusName(gameStatus) << "\033[0m\n";
 		cout << "\033[32m============================================= \033[0m\n";
 	}
-	else if (gameMode == "AI vs AI") {
-		string gameStatus = "Start";
+	else {
+		GameStatus gameStatus = GameStatus::Start;
 		cout << "\n=============================================\n";
 		cout << "      Board:";
 		printBoard(board);
-		while (gameStatus != "Win X" && gameStatus != "Win O" && gameStatus != "Draw") {
-			HANDLE comPort = openSerialPort(portName, baudRate);
-			if (comPort == INVALID_HANDLE_VALUE) {
-				cout << "\033[2J\033[H";
-				cout << "=============================================\n";
-				cerr << "\n\033[31m      Error opening com-port! \033[0m" << endl;
-				cout << "\n=============================================\n";
-				return 1;
+		vector<GameRecord> games;
+		if (!sendMessage(comPort, encodePlayGamesRequest(firstPlayer, 1)) || !decodeGameRecords(readMessage(comPort), games) || games.empty()) {
+			cout << "\033[2J\033[H";
+			cout << "=============================================\n";
+			cerr << "\n\033[31m      Error communicating with the server! \033[0m" << endl;
+			cout << "\n=============================================\n";
+			CloseHandle(comPort);
+			if (saveState) {
+				closeJournal(journal);
+			}
+			return 1;
+		}
+		char player = games[0].firstPlayer;
+		for (int i = 0; i < games[0].moveCount; ++i) {
+			makeMove(board, games[0].moves[i] + 1, player);
+			if (saveState) {
+				journalBoard(journal, board, games[0].moves[i], (i == games[0].moveCount - 1) ? games[0].status : GameStatus::NextMove);
 			}
-			sendMessage(comPort, readFileToString("game_state.xml"));
-			ofstream file("game_state.xml");
-			file << readMessage(comPort);
-			file.close();
-			parseGameStateXML("game_state.xml", firstPlayer, gameMode, board, gameStatus);
+			Sleep(500);
 			cout << "\033[2J\033[H";
 			cout << "\n=============================================\n";
-			cout << "      AI has made a move \n";
+			cout << "      AI " << player << " has made a move \n";
 			cout << "=============================================\n";
 			printBoard(board);
-			CloseHandle(comPort);
+			player = (player == 'X') ? 'O' : 'X';
 		}
+		gameStatus = games[0].status;
 		cout << "\n\033[32m============================================= \033[0m\n";
-		cout << "\033[32m   \033[0m               \033[32m" << gameStatus << "\033[0m\n";
+		cout << "\033[32m   \033[0m               \033[32m" << gameStatusName(gameStatus) << "\033[0m\n";
 		cout << "\033[32m============================================= \033[0m\n";
 	}
-	else {
-		cout << "\033[2J\033[H";
-		cout << "=============================================\n";
-		cerr << "\n\033[31m      Something went wrong... \033[0m" << endl;
-		cout << "\n=============================================\n";
-		return 1;
+	CloseHandle(comPort);
+	if (saveState) {
+		closeJournal(journal);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "GameStateBinder.h"
+#include <cstring>
+
+/**
+ * @brief Skips the whitespace allowed between tags.
+ *
+ * @param p The current position.
+ * @param end The end of the input.
+ * @return const char* The first position that is not whitespace.
+ */
+static inline const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * @brief Matches one schema step at the current position and writes its field.
+ *
+ * Called with a compile-time constant step, so the tag comparison and the value table are
+ * resolved when the binder is compiled.
+ *
+ * @param step The schema step.
+ * @param p The current position, advanced past the step on success.
+ * @param end The end of the input.
+ * @param state The game state receiving the field.
+ * @return bool true if the input matched the step, false otherwise.
+ */
+static inline bool bindStep(const SchemaStep& step, const char*& p, const char* end, GameState& state) {
+    if (step.kind == SchemaStepKind::Tag) {
+        p = skipSpace(p, end);
+        if (static_cast<size_t>(end - p) < step.length || memcmp(p, step.tag, step.length) != 0) {
+            return false;
+        }
+        p += step.length;
+        return true;
+    }
+
+    const char* close = static_cast<const char*>(memchr(p, '<', end - p));
+    if (close == nullptr) {
+        return false;
+    }
+    size_t textLength = close - p;
+    uint8_t index = step.valueCount;
+    for (uint8_t i = 0; i < step.valueCount; ++i) {
+        if (strncmp(p, step.values[i], textLength) == 0 && step.values[i][textLength] == '\0') {
+            index = i;
+            break;
+        }
+    }
+    if (index == step.valueCount) {
+        return false;
+    }
+    switch (step.field) {
+    case GameStateField::Player:
+        state.player = step.values[index][0];
+        break;
+    case GameStateField::GameMode:
+        state.gameMode = static_cast<GameMode>(index);
+        break;
+    case GameStateField::Cell:
+        state.board[step.cell] = step.values[index][0];
+        break;
+    case GameStateField::Status:
+        state.status = static_cast<GameStatus>(index);
+        break;
+    case GameStateField::None:
+        break;
+    }
+    p = close;
+    return true;
+}
+
+/**
+ * @brief Matches the schema steps from step I to the end.
+ *
+ * Each step is instantiated separately, so the whole schema is unrolled into straight-line code.
+ *
+ * @param p The current position, advanced past the matched steps.
+ * @param end The end of the input.
+ * @param state The game state receiving the fields.
+ * @param failedStep Receives the index of the step that did not match.
+ * @return bool true if every step matched, false otherwise.
+ */
+template <size_t I>
+static bool bindSteps(const char*& p, const char* end, GameState& state, size_t& failedStep) {
+    constexpr SchemaStep step = GAME_STATE_SCHEMA.steps[I];
+    if (!bindStep(step, p, end, state)) {
+        failedStep = I;
+        return false;
+    }
+    return bindSteps<I + 1>(p, end, state, failedStep);
+}
+
+/**
+ * @brief Ends the recursion once every schema step has matched.
+ *
+ * @return bool Always true.
+ */
+template <>
+bool bindSteps<GAME_STATE_SCHEMA_STEPS>(const char*&, const char*, GameState&, size_t&) {
+    return true;
+}
+
+/**
+ * @brief Binds a game state document in a single pass, without building a DOM.
+ *
+ * An optional XML declaration and whitespace between tags are accepted; everything else must
+ * follow the schema exactly.
+ *
+ * @param xml The document.
+ * @param length The length of the document.
+ * @param state The game state receiving the fields.
+ * @param error Receives the offset and the expected input if binding fails.
+ * @return bool true if the document matched the schema, false otherwise.
+ */
+bool bindGameState(const char* xml, size_t length, GameState& state, BindError& error) {
+    const char* p = skipSpace(xml, xml + length);
+    const char* end = xml + length;
+    if (end - p >= 2 && p[0] == '<' && p[1] == '?') {
+        const char* close = p + 2;
+        while (close + 1 < end && !(close[0] == '?' && close[1] == '>')) {
+            ++close;
+        }
+        if (close + 1 >= end) {
+            error.offset = end - xml;
+            error.expected = "?>";
+            return false;
+        }
+        p = close + 2;
+    }
+
+    size_t failedStep = 0;
+    if (!bindSteps<0>(p, end, state, failedStep)) {
+        const SchemaStep& step = GAME_STATE_SCHEMA.steps[failedStep];
+        error.offset = skipSpace(p, end) - xml;
+        error.expected = (step.kind == SchemaStepKind::Tag) ? step.tag : "a valid value";
+        return false;
+    }
+    p = skipSpace(p, end);
+    if (p != end) {
+        error.offset = p - xml;
+        error.expected = "end of document";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file GameStateBinder.h
+ * @brief Contains the schema-driven binder that reads a game state document without building a DOM.
+ *
+ * The layout of the <GameState> document is described once, at compile time, as a flat sequence of
+ * steps: the tags in document order and the text fields between them with their allowed values. The
+ * binder walks that sequence over the input in a single pass, writing each field straight into a
+ * GameState. Anything that does not follow the schema is rejected, and no memory is allocated.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "GameLogic.h"
+
+using namespace std;
+
+/**
+ * @brief Number of steps in the game state schema.
+ */
+#define GAME_STATE_SCHEMA_STEPS     46
+
+/**
+ * @brief A game state bound from a document.
+ *
+ * The names of the game mode and status are mapped to the enums while binding, so nothing
+ * refers to the input buffer once it is released.
+ */
+struct GameState {
+    char player;            ///< The player to move ('X' or 'O').
+    GameMode gameMode;      ///< The game mode.
+    Board board;            ///< The 3x3 board ('X', 'O', '_').
+    GameStatus status;      ///< The game status.
+};
+
+/**
+ * @brief Kind of a schema step.
+ */
+enum class SchemaStepKind : uint8_t {
+    Tag,    ///< A start or end tag that must come next, after optional whitespace.
+    Text    ///< A text field that must match one of the allowed values.
+};
+
+/**
+ * @brief The GameState member written by a text step.
+ */
+enum class GameStateField : uint8_t {
+    None,
+    Player,
+    GameMode,
+    Cell,
+    Status
+};
+
+/**
+ * @brief One step of the game state schema.
+ */
+struct SchemaStep {
+    SchemaStepKind kind;            ///< Whether the step is a tag or a text field.
+    GameStateField field;           ///< The member written by a text step.
+    uint8_t cell;                   ///< The cell index (0-8) written by a Cell step.
+    uint8_t length;                 ///< The length of the tag.
+    const char* tag;                ///< The tag of a Tag step, including the angle brackets.
+    const char* const* values;      ///< The allowed values of a Text step.
+    uint8_t valueCount;             ///< The number of allowed values.
+};
+
+/**
+ * @brief The schema of the game state document as a sequence of steps.
+ */
+struct GameStateSchema {
+    SchemaStep steps[GAME_STATE_SCHEMA_STEPS];  ///< The steps in document order.
+    size_t count;                               ///< The number of steps written by the schema builder.
+};
+
+/**
+ * @brief Where and why binding a document failed.
+ */
+struct BindError {
+    size_t offset;          ///< Offset in the input at which the document stopped matching the schema.
+    const char* expected;   ///< What the schema expected at that offset.
+};
+
+/**
+ * @brief Allowed values of the player and cell fields.
+ *
+ * The game mode and status fields take their allowed values from GAME_MODE_NAMES and GAME_STATUS_NAMES,
+ * so the index of a matched value is the enum.
+ */
+constexpr const char* SCHEMA_PLAYERS[] = { "X", "O" };
+constexpr const char* SCHEMA_CELLS[] = { "X", "O", "_" };
+
+/**
+ * @brief Returns the index of the allowed value of the schema that matches a text.
+ *
+ * @param values The allowed values.
+ * @param text The text.
+ * @return The index of the allowed value, or N if the text is not allowed.
+ */
+template <size_t N>
+inline size_t findSchemaIndex(const char* const (&values)[N], const char* text) {
+    for (size_t i = 0; i < N; ++i) {
+        if (strcmp(values[i], text) == 0) {
+            return i;
+        }
+    }
+    return N;
+}
+
+/**
+ * @brief Returns the allowed value of the schema that matches a text.
+ *
+ * @param values The allowed values.
+ * @param text The text.
+ * @return The allowed value, or nullptr if the text is not allowed.
+ */
+template <size_t N>
+inline const char* findSchemaValue(const char* const (&values)[N], const char* text) {
+    size_t index = findSchemaIndex(values, text);
+    return (index < N) ? values[index] : nullptr;
+}
+
+/**
+ * @brief Returns the length of a string literal at compile time.
+ *
+ * @param text The string literal.
+ * @return The number of characters before the terminator.
+ */
+constexpr uint8_t schemaLength(const char* text) {
+    uint8_t length = 0;
+    while (text[length] != '\0') {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * @brief Returns a step that expects the given tag.
+ *
+ * @param tag The tag, including the angle brackets (e.g., "<Player>").
+ * @return The step.
+ */
+constexpr SchemaStep tagStep(const char* tag) {
+    return SchemaStep{ SchemaStepKind::Tag, GameStateField::None, 0, schemaLength(tag), tag, nullptr, 0 };
+}
+
+/**
+ * @brief Returns a step that binds a text field.
+ *
+ * @param field The GameState member to write.
+ * @param cell The cell index for a Cell field, 0 otherwise.
+ * @param values The allowed values.
+ * @return The step.
+ */
+template <size_t N>
+constexpr SchemaStep textStep(GameStateField field, uint8_t cell, const char* const (&values)[N]) {
+    return SchemaStep{ SchemaStepKind::Text, field, cell, 0, nullptr, values, static_cast<uint8_t>(N) };
+}
+
+/**
+ * @brief Builds the schema of the game state document sent between the client and the server.
+ *
+ * @return The schema.
+ */
+constexpr GameStateSchema makeGameStateSchema() {
+    GameStateSchema schema{};
+    size_t n = 0;
+    schema.steps[n++] = tagStep("<GameState>");
+    schema.steps[n++] = tagStep("<Player>");
+    schema.steps[n++] = textStep(GameStateField::Player, 0, SCHEMA_PLAYERS);
+    schema.steps[n++] = tagStep("</Player>");
+    schema.steps[n++] = tagStep("<GameType>");
+    schema.steps[n++] = textStep(GameStateField::GameMode, 0, GAME_MODE_NAMES);
+    schema.steps[n++] = tagStep("</GameType>");
+    schema.steps[n++] = tagStep("<Board>");
+    for (uint8_t row = 0; row < 3; ++row) {
+        schema.steps[n++] = tagStep("<Row>");
+        for (uint8_t col = 0; col < 3; ++col) {
+            schema.steps[n++] = tagStep("<Cell>");
+            schema.steps[n++] = textStep(GameStateField::Cell, static_cast<uint8_t>(row * 3 + col), SCHEMA_CELLS);
+            schema.steps[n++] = tagStep("</Cell>");
+        }
+        schema.steps[n++] = tagStep("</Row>");
+    }
+    schema.steps[n++] = tagStep("</Board>");
+    schema.steps[n++] = tagStep("<Status>");
+    schema.steps[n++] = textStep(GameStateField::Status, 0, GAME_STATUS_NAMES);
+    schema.steps[n++] = tagStep("</Status>");
+    schema.steps[n++] = tagStep("</GameState>");
+    schema.count = n;
+    return schema;
+}
+
+/**
+ * @brief The game state schema, built at compile time.
+ */
+constexpr GameStateSchema GAME_STATE_SCHEMA = makeGameStateSchema();
+
+static_assert(GAME_STATE_SCHEMA.count == GAME_STATE_SCHEMA_STEPS, "GAME_STATE_SCHEMA_STEPS must match the schema");
+
+/**
+ * @brief Binds a game state document in a single pass, without building a DOM.
+ *
+ * An optional XML declaration and whitespace between tags are accepted; everything else must
+ * follow the schema exactly.
+ *
+ * @param xml The document.
+ * @param length The length of the document.
+ * @param state The game state receiving the fields.
+ * @param error Receives the offset and the expected input if binding fails.
+ * @return true if the document matched the schema, false otherwise.
+ */
+bool bindGameState(const char* xml, size_t length, GameState& state, BindError& error);
@@ -0,0 +1,193 @@
+#include "GameStateDocument.h"
+#include <cstring>
+#include "GameStateBinder.h"
+
+/**
+ * @brief Printer that records where the text of each field starts in the printed document.
+ */
+class FieldOffsetPrinter : public XMLPrinter {
+public:
+    /**
+     * @brief Creates a printer that writes through to the sink.
+     *
+     * @param sink The sink receiving the document.
+     * @param offsets Receives the offset of the text of each field.
+     */
+    FieldOffsetPrinter(XMLBufferSink& sink, size_t* offsets) : XMLPrinter(sink, true, 0, 0), sink(sink), offsets(offsets), count(0) {}
+
+    /**
+     * @brief Records the offset of a text node, then prints it.
+     *
+     * @param text The text node.
+     * @return bool Always true.
+     */
+    bool Visit(const XMLText& text) override {
+        SealElementIfJustOpened();
+        Flush();
+        if (count < GAME_STATE_FIELDS) {
+            offsets[count] = sink.Size();
+        }
+        ++count;
+        return XMLPrinter::Visit(text);
+    }
+
+    /**
+     * @brief Returns the number of text nodes printed.
+     *
+     * @return size_t The number of text nodes.
+     */
+    size_t fieldCount() const {
+        return count;
+    }
+
+private:
+    XMLBufferSink& sink;
+    size_t* offsets;
+    size_t count;
+};
+
+/**
+ * @brief Returns the allowed value of the schema that matches a symbol.
+ *
+ * @param values The allowed values.
+ * @param symbol The symbol ('X', 'O' or '_').
+ * @return const char* The allowed value, or nullptr if the symbol is not allowed.
+ */
+template <size_t N>
+static const char* findSymbol(const char* const (&values)[N], char symbol) {
+    const char text[2] = { symbol, '\0' };
+    return findSchemaValue(values, text);
+}
+
+/**
+ * @brief Appends an element holding a single text node.
+ *
+ * @param dom The document.
+ * @param parent The parent element.
+ * @param name The name of the element.
+ * @param value The text, which must outlive the document.
+ * @return XMLText* The text node.
+ */
+static XMLText* appendField(tinyxml2::XMLDocument& dom, XMLElement* parent, const char* name, const char* value) {
+    XMLText* text = dom.NewText("");
+    text->SetValue(value, true);
+    parent->InsertNewChildElement(name)->InsertEndChild(text);
+    return text;
+}
+
+/**
+ * @brief Sets a field in the DOM and in the serialized document.
+ *
+ * A value of the same length is copied over the old one; otherwise the rest of the serialized
+ * document is moved and the offsets of the following fields are adjusted.
+ *
+ * @param document The document.
+ * @param field The index of the field.
+ * @param value The allowed value to set, or nullptr if the new value is not allowed.
+ * @return bool true if the field holds the value, false otherwise.
+ */
+static bool setField(GameStateDocument& document, int field, const char* value) {
+    if (value == nullptr) {
+        return false;
+    }
+    if (document.fields[field]->Value() == value) {
+        return true;
+    }
+    size_t length = strlen(value);
+    size_t oldLength = document.lengths[field];
+    char* text = document.xml + document.offsets[field];
+    if (length != oldLength) {
+        size_t newLength = document.length - oldLength + length;
+        if (newLength > sizeof(document.xml)) {
+            return false;
+        }
+        memmove(text + length, text + oldLength, document.length - document.offsets[field] - oldLength);
+        for (int next = field + 1; next < GAME_STATE_FIELDS; ++next) {
+            document.offsets[next] = document.offsets[next] - oldLength + length;
+        }
+        document.lengths[field] = length;
+        document.length = newLength;
+    }
+    memcpy(text, value, length);
+    document.fields[field]->SetValue(value, true);
+    return true;
+}
+
+/**
+ * @brief Builds the document and its serialization from a game state.
+ *
+ * @param document The document to build.
+ * @param player The current player ('X' or 'O').
+ * @param gameType The game mode.
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The status to send (e.g., Start).
+ * @return size_t The length of the serialized document, or 0 if a value is not allowed by the
+ *         schema or the document does not fit in the transmit buffer.
+ */
+size_t initGameStateDocument(GameStateDocument& document, char player, GameMode gameType, Board board, GameStatus gameStatus) {
+    document.length = 0;
+    const char* values[GAME_STATE_FIELDS];
+    values[FIELD_PLAYER] = findSymbol(SCHEMA_PLAYERS, player);
+    values[FIELD_GAME_TYPE] = gameModeName(gameType);
+    for (int cell = 0; cell < 9; ++cell) {
+        values[FIELD_FIRST_CELL + cell] = findSymbol(SCHEMA_CELLS, board[cell]);
+    }
+    values[FIELD_STATUS] = gameStatusName(gameStatus);
+    for (int field = 0; field < GAME_STATE_FIELDS; ++field) {
+        if (values[field] == nullptr) {
+            return 0;
+        }
+    }
+
+    tinyxml2::XMLDocument& dom = document.dom;
+    dom.Clear();
+    XMLElement* root = dom.NewElement("GameState");
+    dom.InsertEndChild(root);
+    document.fields[FIELD_PLAYER] = appendField(dom, root, "Player", values[FIELD_PLAYER]);
+    document.fields[FIELD_GAME_TYPE] = appendField(dom, root, "GameType", values[FIELD_GAME_TYPE]);
+    XMLElement* boardElement = root->InsertNewChildElement("Board");
+    for (int row = 0; row < 3; ++row) {
+        XMLElement* rowElement = boardElement->InsertNewChildElement("Row");
+        for (int col = 0; col < 3; ++col) {
+            int field = FIELD_FIRST_CELL + row * 3 + col;
+            document.fields[field] = appendField(dom, rowElement, "Cell", values[field]);
+        }
+    }
+    document.fields[FIELD_STATUS] = appendField(dom, root, "Status", values[FIELD_STATUS]);
+
+    XMLBufferSink sink(document.xml, sizeof(document.xml));
+    FieldOffsetPrinter printer(sink, document.offsets);
+    dom.Print(&printer);
+    printer.Flush();
+    sink.Write("\n", 1);
+    if (sink.Overflowed() || printer.fieldCount() != GAME_STATE_FIELDS) {
+        return 0;
+    }
+    for (int field = 0; field < GAME_STATE_FIELDS; ++field) {
+        document.lengths[field] = strlen(values[field]);
+    }
+    document.length = sink.Size();
+    return document.length;
+}
+
+/**
+ * @brief Updates the document to a new game state, rewriting only the fields that changed.
+ *
+ * @param document The document built by initGameStateDocument.
+ * @param player The current player ('X' or 'O').
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The status to send (e.g., Start).
+ * @return size_t The length of the serialized document, or 0 if a value is not allowed by the
+ *         schema or the document does not fit in the transmit buffer.
+ */
+size_t updateGameStateDocument(GameStateDocument& document, char player, Board board, GameStatus gameStatus) {
+    if (document.length == 0) {
+        return 0;
+    }
+    bool updated = setField(document, FIELD_PLAYER, findSymbol(SCHEMA_PLAYERS, player));
+    for (int cell = 0; updated && cell < 9; ++cell) {
+        updated = setField(document, FIELD_FIRST_CELL + cell, findSymbol(SCHEMA_CELLS, board[cell]));
+    }
+    updated = updated && setField(document, FIELD_STATUS, gameStatusName(gameStatus));
+    return updated ? document.length : 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file GameStateDocument.h
+ * @brief Contains the persistent game state document that is patched move by move.
+ *
+ * The <GameState> document is built once as a DOM and serialized once into a cached transmit
+ * buffer, recording where the text of every field starts. A move then only rewrites the fields
+ * that changed: their text nodes in the DOM and their bytes in the cached buffer. The markup
+ * between the fields is never printed again, and a field whose length changes only moves the
+ * part of the buffer after it.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include "GameLogic.h"
+
+using namespace std;
+
+/**
+ * @brief Number of text fields in the game state document.
+ */
+#define GAME_STATE_FIELDS       12
+
+/**
+ * @brief Index of each text field, in document order.
+ */
+#define FIELD_PLAYER            0
+#define FIELD_GAME_TYPE         1
+#define FIELD_FIRST_CELL        2
+#define FIELD_STATUS            11
+
+/**
+ * @brief A game state kept as a DOM together with its cached serialization.
+ *
+ * The text nodes hold the allowed values of the game state schema, so updating them never
+ * allocates.
+ */
+struct GameStateDocument {
+    tinyxml2::XMLDocument dom;                  ///< The <GameState> document.
+    XMLText* fields[GAME_STATE_FIELDS];         ///< Text nodes of the fields, in document order.
+    char xml[GAME_STATE_TX_SIZE];               ///< The serialized document, ending with a newline.
+    size_t length;                              ///< The length of the serialized document.
+    size_t offsets[GAME_STATE_FIELDS];          ///< Offset of the text of each field in xml.
+    size_t lengths[GAME_STATE_FIELDS];          ///< Length of the text of each field in xml.
+};
+
+/**
+ * @brief Builds the document and its serialization from a game state.
+ *
+ * @param document The document to build.
+ * @param player The current player ('X' or 'O').
+ * @param gameType The game mode.
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The status to send (e.g., Start).
+ * @return The length of the serialized document, or 0 if a value is not allowed by the schema or
+ *         the document does not fit in the transmit buffer.
+ */
+size_t initGameStateDocument(GameStateDocument& document, char player, GameMode gameType, Board board, GameStatus gameStatus);
+
+/**
+ * @brief Updates the document to a new game state, rewriting only the fields that changed.
+ *
+ * Produces the same document as serializeGameState for the new state.
+ *
+ * @param document The document built by initGameStateDocument.
+ * @param player The current player ('X' or 'O').
+ * @param board The 3x3 game board ('X', 'O', '_').
+ * @param gameStatus The status to send (e.g., Start).
+ * @return The length of the serialized document, or 0 if a value is not allowed by the schema or
+ *         the document does not fit in the transmit buffer.
+ */
+size_t updateGameStateDocument(GameStateDocument& document, char player, Board board, GameStatus gameStatus);
@@ -0,0 +1,267 @@
+#include "GameStateParser.h"
+#include <algorithm>
+
+/**
+ * @brief Records an error in a parse result.
+ *
+ * @param result The result.
+ * @param status The outcome.
+ * @param element The name of the missing or invalid element.
+ * @param line The line of the element, 0 if unknown.
+ */
+static void setParseError(ParseResult& result, ParseStatus status, const char* element, int line) {
+    result.status = status;
+    result.element = element;
+    result.line = line;
+}
+
+/**
+ * @brief Reads the text of an element as one of the allowed values.
+ *
+ * @param element The element, or nullptr if it is missing.
+ * @param parent The parent element, whose line is reported if the element is missing.
+ * @param name The name of the element.
+ * @param values The allowed values.
+ * @param result Receives the error if the element is missing or its text is not allowed.
+ * @return size_t The index of the allowed value, or N on error.
+ */
+template <size_t N>
+static size_t readValue(const XMLElement* element, const XMLElement* parent, const char* name, const char* const (&values)[N], ParseResult& result) {
+    const char* text = (element != nullptr) ? element->GetText() : nullptr;
+    if (text == nullptr) {
+        setParseError(result, ParseStatus::MissingElement, name, (element != nullptr) ? element->GetLineNum() : parent->GetLineNum());
+        return N;
+    }
+    size_t index = findSchemaIndex(values, text);
+    if (index == N) {
+        setParseError(result, ParseStatus::InvalidValue, name, element->GetLineNum());
+    }
+    return index;
+}
+
+/**
+ * @brief Reads the text of the first child element with the given name as one of the allowed values.
+ *
+ * @param parent The parent element.
+ * @param name The name of the child element.
+ * @param values The allowed values.
+ * @param result Receives the error if the element is missing or its text is not allowed.
+ * @return size_t The index of the allowed value, or N on error.
+ */
+template <size_t N>
+static size_t readField(const XMLElement* parent, const char* name, const char* const (&values)[N], ParseResult& result) {
+    return readValue(parent->FirstChildElement(name), parent, name, values, result);
+}
+
+/**
+ * @brief Parses one game state document with the given document.
+ *
+ * @param document The XML document to parse into; it may be reused for the next parse.
+ * @param xml The game state document.
+ * @param length The length of the game state document.
+ * @param result Receives the game state or the error.
+ */
+void parseGameStateDocument(tinyxml2::XMLDocument& document, const char* xml, size_t length, ParseResult& result) {
+    result.status = ParseStatus::Ok;
+    result.xmlError = XML_SUCCESS;
+    result.line = 0;
+    result.element = nullptr;
+    XMLError error = document.Parse(xml, length);
+    if (error != XML_SUCCESS) {
+        result.xmlError = error;
+        setParseError(result, ParseStatus::XmlError, nullptr, document.ErrorLineNum());
+        return;
+    }
+    const XMLElement* root = document.FirstChildElement("GameState");
+    if (root == nullptr) {
+        setParseError(result, ParseStatus::MissingElement, "GameState", 0);
+        return;
+    }
+    size_t player = readField(root, "Player", SCHEMA_PLAYERS, result);
+    if (player == size(SCHEMA_PLAYERS)) {
+        return;
+    }
+    size_t gameMode = readField(root, "GameType", GAME_MODE_NAMES, result);
+    if (gameMode == GAME_MODE_COUNT) {
+        return;
+    }
+    const XMLElement* boardElement = root->FirstChildElement("Board");
+    if (boardElement == nullptr) {
+        setParseError(result, ParseStatus::MissingElement, "Board", root->GetLineNum());
+        return;
+    }
+    const XMLElement* rowElement = boardElement->FirstChildElement("Row");
+    for (int row = 0; row < 3; ++row) {
+        if (rowElement == nullptr) {
+            setParseError(result, ParseStatus::MissingElement, "Row", boardElement->GetLineNum());
+            return;
+        }
+        const XMLElement* cellElement = rowElement->FirstChildElement("Cell");
+        for (int col = 0; col < 3; ++col) {
+            size_t cell = readValue(cellElement, rowElement, "Cell", SCHEMA_CELLS, result);
+            if (cell == size(SCHEMA_CELLS)) {
+                return;
+            }
+            result.state.board.at(row, col) = SCHEMA_CELLS[cell][0];
+            cellElement = cellElement->NextSiblingElement("Cell");
+        }
+        rowElement = rowElement->NextSiblingElement("Row");
+    }
+    size_t status = readField(root, "Status", GAME_STATUS_NAMES, result);
+    if (status == GAME_STATUS_COUNT) {
+        return;
+    }
+    result.state.player = SCHEMA_PLAYERS[player][0];
+    result.state.gameMode = static_cast<GameMode>(gameMode);
+    result.state.status = static_cast<GameStatus>(status);
+}
+
+/**
+ * @brief Takes the next chunk for a worker, stealing from another worker when its own queue is empty.
+ *
+ * The owner takes chunks from the front of its queue and thieves from the back, so a thief takes
+ * the work the owner would have reached last.
+ *
+ * @param service The service.
+ * @param self The index of the worker.
+ * @param first Receives the first document of the chunk.
+ * @return bool true if a chunk was taken, false if every queue is empty.
+ */
+static bool takeChunk(ParserService& service, size_t self, size_t& first) {
+    ParserWorker& own = *service.workers[self];
+    {
+        lock_guard<mutex> guard(own.queueLock);
+        if (!own.queue.empty()) {
+            first = own.queue.front();
+            own.queue.pop_front();
+            return true;
+        }
+    }
+    size_t count = service.workers.size();
+    for (size_t i = 1; i < count; ++i) {
+        ParserWorker& victim = *service.workers[(self + i) % count];
+        lock_guard<mutex> guard(victim.queueLock);
+        if (!victim.queue.empty()) {
+            first = victim.queue.back();
+            victim.queue.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Runs a worker: waits for a batch, parses chunks until none is left, and repeats.
+ *
+ * @param service The service.
+ * @param self The index of the worker.
+ */
+static void runParserWorker(ParserService& service, size_t self) {
+    ParserWorker& worker = *service.workers[self];
+    uint64_t seen = 0;
+    unique_lock<mutex> lock(service.lock);
+    for (;;) {
+        service.batchReady.wait(lock, [&] { return service.stopping || service.batch != seen; });
+        if (service.stopping) {
+            return;
+        }
+        seen = service.batch;
+        const vector<string>& documents = *service.documents;
+        vector<ParseResult>& results = *service.results;
+        lock.unlock();
+
+        size_t first;
+        while (takeChunk(service, self, first)) {
+            size_t end = min(first + PARSER_CHUNK_SIZE, documents.size());
+            for (size_t i = first; i < end; ++i) {
+                parseGameStateDocument(worker.document, documents[i].data(), documents[i].size(), results[i]);
+            }
+        }
+
+        lock.lock();
+        if (--service.busyWorkers == 0) {
+            service.batchDone.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Starts the workers of the parser service.
+ *
+ * @param service The service to start.
+ * @param threads The number of workers, or 0 to use every hardware thread.
+ */
+void startParserService(ParserService& service, unsigned threads) {
+    if (threads == 0) {
+        threads = max(thread::hardware_concurrency(), 1u);
+    }
+    service.documents = nullptr;
+    service.results = nullptr;
+    service.batch = 0;
+    service.busyWorkers = 0;
+    service.stopping = false;
+    for (unsigned i = 0; i < threads; ++i) {
+        service.workers.push_back(make_unique<ParserWorker>());
+        service.workers.back()->document.SetRetainMemory(true);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        service.workers[i]->worker = thread(runParserWorker, ref(service), i);
+    }
+}
+
+/**
+ * @brief Stops the workers of the parser service and waits for them to exit.
+ *
+ * @param service The service to stop.
+ */
+void stopParserService(ParserService& service) {
+    {
+        lock_guard<mutex> guard(service.lock);
+        service.stopping = true;
+    }
+    service.batchReady.notify_all();
+    for (unique_ptr<ParserWorker>& worker : service.workers) {
+        worker->worker.join();
+    }
+    service.workers.clear();
+}
+
+/**
+ * @brief Stops the workers if the service is still running, so no joinable thread is destroyed.
+ */
+ParserService::~ParserService() {
+    if (!workers.empty()) {
+        stopParserService(*this);
+    }
+}
+
+/**
+ * @brief Parses a batch of game state documents across the workers.
+ *
+ * The chunks are dealt out in contiguous runs, one run per worker, before the workers are woken.
+ *
+ * @param service The started service.
+ * @param documents The game state documents.
+ * @param results Receives one result per document, in the same order.
+ */
+void parseGameStates(ParserService& service, const vector<string>& documents, vector<ParseResult>& results) {
+    results.resize(documents.size());
+    size_t chunks = (documents.size() + PARSER_CHUNK_SIZE - 1) / PARSER_CHUNK_SIZE;
+    size_t workers = service.workers.size();
+    if (chunks == 0 || workers == 0) {
+        return;
+    }
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        ParserWorker& worker = *service.workers[chunk * workers / chunks];
+        lock_guard<mutex> guard(worker.queueLock);
+        worker.queue.push_back(chunk * PARSER_CHUNK_SIZE);
+    }
+
+    unique_lock<mutex> lock(service.lock);
+    service.documents = &documents;
+    service.results = &results;
+    service.busyWorkers = static_cast<unsigned>(workers);
+    ++service.batch;
+    service.batchReady.notify_all();
+    service.batchDone.wait(lock, [&] { return service.busyWorkers == 0; });
+}
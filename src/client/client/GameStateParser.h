@@ -0,0 +1,116 @@
+/**
+ * @file GameStateParser.h
+ * @brief Contains the parser service that parses batches of game state documents in parallel.
+ *
+ * The service owns a pool of worker threads, each with its own XMLDocument that keeps its memory
+ * between documents, so parsing allocates nothing once every worker has seen a document. A batch is
+ * split into chunks that are dealt out to the workers up front; a worker that runs out of chunks
+ * steals from the back of another worker's queue, so uneven documents do not leave cores idle.
+ * Errors are returned per document instead of being printed, so workers never contend on a stream.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GameStateBinder.h"
+
+using namespace std;
+
+/**
+ * @brief Number of documents a worker takes from a queue at a time.
+ */
+#define PARSER_CHUNK_SIZE       32
+
+/**
+ * @brief Outcome of parsing one game state document.
+ */
+enum class ParseStatus : uint8_t {
+    Ok,                 ///< The document was parsed and every field holds an allowed value.
+    XmlError,           ///< The document is not well-formed XML.
+    MissingElement,     ///< A required element is missing or has no text.
+    InvalidValue        ///< A field holds a value the game state schema does not allow.
+};
+
+/**
+ * @brief Result of parsing one game state document.
+ */
+struct ParseResult {
+    ParseStatus status;     ///< The outcome.
+    XMLError xmlError;      ///< The tinyxml2 error if status is XmlError, XML_SUCCESS otherwise.
+    int line;               ///< The line of the error, 0 if unknown.
+    const char* element;    ///< The name of the missing or invalid element, nullptr otherwise.
+    GameState state;        ///< The game state if status is Ok.
+};
+
+/**
+ * @brief A worker thread and the work it owns.
+ */
+struct ParserWorker {
+    tinyxml2::XMLDocument document;     ///< Document reused for every parse of the worker.
+    mutex queueLock;                    ///< Guards the queue.
+    deque<size_t> queue;                ///< First document of each chunk left to parse.
+    thread worker;                      ///< The worker thread.
+};
+
+/**
+ * @brief A pool of workers parsing batches of game state documents.
+ */
+struct ParserService {
+    vector<unique_ptr<ParserWorker>> workers;   ///< The workers.
+    mutex lock;                                 ///< Guards the batch state below.
+    condition_variable batchReady;              ///< Signaled when a batch starts or the service stops.
+    condition_variable batchDone;               ///< Signaled when the last worker finishes a batch.
+    const vector<string>* documents;            ///< The documents of the current batch.
+    vector<ParseResult>* results;               ///< The results of the current batch.
+    uint64_t batch;                             ///< Number of batches started.
+    unsigned busyWorkers;                       ///< Workers still working on the current batch.
+    bool stopping;                              ///< Set when the workers must exit.
+
+    /**
+     * @brief Stops the workers if the service is still running.
+     */
+    ~ParserService();
+};
+
+/**
+ * @brief Parses one game state document with the given document.
+ *
+ * @param document The XML document to parse into; it may be reused for the next parse.
+ * @param xml The game state document.
+ * @param length The length of the game state document.
+ * @param result Receives the game state or the error.
+ */
+void parseGameStateDocument(tinyxml2::XMLDocument& document, const char* xml, size_t length, ParseResult& result);
+
+/**
+ * @brief Starts the workers of the parser service.
+ *
+ * @param service The service to start.
+ * @param threads The number of workers, or 0 to use every hardware thread.
+ */
+void startParserService(ParserService& service, unsigned threads);
+
+/**
+ * @brief Stops the workers of the parser service and waits for them to exit.
+ *
+ * Stopping a service that is already stopped does nothing. A service that is destroyed
+ * while running is stopped by its destructor.
+ *
+ * @param service The service to stop.
+ */
+void stopParserService(ParserService& service);
+
+/**
+ * @brief Parses a batch of game state documents across the workers.
+ *
+ * @param service The started service.
+ * @param documents The game state documents.
+ * @param results Receives one result per document, in the same order.
+ */
+void parseGameStates(ParserService& service, const vector<string>& documents, vector<ParseResult>& results);
@@ -0,0 +1,234 @@
+#include "GameStats.h"
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <thread>
+
+/**
+ * @brief Bin collecting the games rejected by the mode filter.
+ */
+#define STATS_REJECTED_BIN      (STATS_MAX_GROUPS * 4)
+
+/**
+ * @brief Appends packed games to the columns.
+ *
+ * @param games The packed games.
+ * @param count The number of games.
+ * @param columns The columns receiving the games.
+ */
+void appendColumns(const PackedGame* games, size_t count, GameColumns& columns) {
+    size_t size = columns.outcome.size() + count;
+    columns.outcome.reserve(size);
+    columns.mode.reserve(size);
+    columns.firstPlayer.reserve(size);
+    columns.moveCount.reserve(size);
+    for (int move = 0; move < 9; ++move) {
+        columns.moves[move].reserve(size);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const PackedGame& game = games[i];
+        uint8_t moveCount = game.header & 0x0F;
+        columns.outcome.push_back(game.header >> 6);
+        columns.mode.push_back((game.header >> 4) & 0x03);
+        columns.firstPlayer.push_back(game.firstPlayer == 'O' ? 1 : 0);
+        columns.moveCount.push_back(moveCount);
+        for (int move = 0; move < 9; ++move) {
+            uint8_t packed = game.moves[move / 2];
+            uint8_t cell = (move % 2 == 0) ? (packed >> 4) : (packed & 0x0F);
+            columns.moves[move].push_back(move < moveCount ? cell : STATS_NO_MOVE);
+        }
+    }
+}
+
+/**
+ * @brief Builds the columns from the finished games of a journal.
+ *
+ * @param journalFile The path to the journal file.
+ * @param columns The columns to populate.
+ * @return true if the journal was read, false otherwise.
+ */
+bool loadColumnsFromJournal(const string& journalFile, GameColumns& columns) {
+    vector<JournalRecord> records;
+    if (!readJournal(journalFile, records)) {
+        return false;
+    }
+    vector<PackedGame> games;
+    collectFinishedGames(records, 0, games);
+    appendColumns(games.data(), games.size(), columns);
+    return true;
+}
+
+/**
+ * @brief Builds the columns from the games of the archive.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @param columns The columns to populate.
+ * @return true if the archive was read, false otherwise.
+ */
+bool loadColumnsFromArchive(const string& archiveFile, const string& indexFile, GameColumns& columns) {
+    GameArchive archive;
+    if (!openArchive(archive, archiveFile, indexFile)) {
+        return false;
+    }
+    appendColumns(archive.games, archive.gameCount, columns);
+    closeArchive(archive);
+    return true;
+}
+
+/**
+ * @brief Counts the games of a range per group value and outcome.
+ *
+ * Each block is first turned into one bin number per game (group value * 4 + outcome, or
+ * STATS_REJECTED_BIN for games rejected by the filter) with a branch-free loop, then the bin
+ * numbers are counted into four interleaved histograms so consecutive games never wait on the
+ * same counter.
+ *
+ * @param group The grouping column.
+ * @param outcome The outcome column.
+ * @param mode The game mode column.
+ * @param modeFilter The game mode index to keep, or -1 for all games.
+ * @param begin The first game of the range.
+ * @param end One past the last game of the range.
+ * @param result The counts receiving the games of the range.
+ */
+static void countOutcomes(const uint8_t* group, const uint8_t* outcome, const uint8_t* mode, int modeFilter,
+    size_t begin, size_t end, OutcomeCounts& result) {
+    uint8_t bins[STATS_BLOCK_SIZE];
+    uint32_t histograms[4][STATS_REJECTED_BIN + 1] = {};
+    for (size_t block = begin; block < end; block += STATS_BLOCK_SIZE) {
+        size_t count = (end - block < STATS_BLOCK_SIZE) ? end - block : STATS_BLOCK_SIZE;
+        const uint8_t* groupBlock = group + block;
+        const uint8_t* outcomeBlock = outcome + block;
+        const uint8_t* modeBlock = mode + block;
+        if (modeFilter < 0) {
+            for (size_t i = 0; i < count; ++i) {
+                bins[i] = static_cast<uint8_t>(((groupBlock[i] & 0x0F) << 2) | (outcomeBlock[i] & 0x03));
+            }
+        }
+        else {
+            uint8_t wanted = static_cast<uint8_t>(modeFilter);
+            for (size_t i = 0; i < count; ++i) {
+                uint8_t bin = static_cast<uint8_t>(((groupBlock[i] & 0x0F) << 2) | (outcomeBlock[i] & 0x03));
+                uint8_t keep = static_cast<uint8_t>(-(modeBlock[i] == wanted));
+                bins[i] = static_cast<uint8_t>((bin & keep) | (STATS_REJECTED_BIN & ~keep));
+            }
+        }
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            histograms[0][bins[i]]++;
+            histograms[1][bins[i + 1]]++;
+            histograms[2][bins[i + 2]]++;
+            histograms[3][bins[i + 3]]++;
+        }
+        for (; i < count; ++i) {
+            histograms[0][bins[i]]++;
+        }
+    }
+    for (int bin = 0; bin < STATS_REJECTED_BIN; ++bin) {
+        result.counts[bin >> 2][bin & 0x03] += static_cast<uint64_t>(histograms[0][bin]) + histograms[1][bin] + histograms[2][bin] + histograms[3][bin];
+    }
+}
+
+/**
+ * @brief Counts the games per value of a grouping column and per outcome.
+ *
+ * The games are split into one contiguous range per thread, each thread counts its range into
+ * its own counters and the counters are summed once every thread has finished.
+ *
+ * @param columns The columns to scan.
+ * @param group The grouping column (values below STATS_MAX_GROUPS; STATS_NO_MOVE is counted too).
+ * @param modeFilter The game mode index to restrict the scan to, or -1 for all games.
+ * @param result The counts.
+ * @param threads The number of threads to use, or 0 to use every hardware thread.
+ */
+void aggregateOutcomes(const GameColumns& columns, const vector<uint8_t>& group, int modeFilter, OutcomeCounts& result, unsigned threads) {
+    result = OutcomeCounts();
+    size_t games = columns.outcome.size();
+    if (threads == 0) {
+        threads = thread::hardware_concurrency();
+    }
+    size_t maxThreads = games / STATS_MIN_GAMES_PER_THREAD;
+    if (threads > maxThreads) {
+        threads = static_cast<unsigned>(maxThreads);
+    }
+    if (threads <= 1) {
+        countOutcomes(group.data(), columns.outcome.data(), columns.mode.data(), modeFilter, 0, games, result);
+        return;
+    }
+
+    vector<OutcomeCounts> partial(threads, OutcomeCounts());
+    vector<thread> workers;
+    size_t rangeSize = (games + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        size_t begin = t * rangeSize;
+        size_t end = (begin + rangeSize < games) ? begin + rangeSize : games;
+        workers.emplace_back(countOutcomes, group.data(), columns.outcome.data(), columns.mode.data(), modeFilter, begin, end, ref(partial[t]));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    for (const OutcomeCounts& counts : partial) {
+        for (int value = 0; value < STATS_MAX_GROUPS; ++value) {
+            for (int outcome = 0; outcome < 4; ++outcome) {
+                result.counts[value][outcome] += counts.counts[value][outcome];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Prints one table of outcome rates.
+ *
+ * @param title The title of the table.
+ * @param counts The counts per group value and outcome.
+ * @param labels The label of each group value to print.
+ * @param labelCount The number of group values to print.
+ */
+static void printOutcomeTable(const string& title, const OutcomeCounts& counts, const string* labels, int labelCount) {
+    cout << "\n=============================================\n";
+    cout << "      " << title << "\n";
+    cout << "=============================================\n";
+    cout << "  " << left << setw(12) << "" << right << setw(10) << "Games" << setw(8) << "Win X" << setw(8) << "Win O" << setw(8) << "Draw" << "\n";
+    for (int value = 0; value < labelCount; ++value) {
+        const uint64_t* outcomes = counts.counts[value];
+        uint64_t total = outcomes[1] + outcomes[2] + outcomes[3];
+        cout << "  " << left << setw(12) << labels[value] << right << setw(10) << total;
+        for (int outcome = 1; outcome < 4; ++outcome) {
+            double rate = (total > 0) ? 100.0 * outcomes[outcome] / total : 0.0;
+            cout << setw(7) << fixed << setprecision(1) << rate << "%";
+        }
+        cout << "\n";
+    }
+}
+
+/**
+ * @brief Prints the outcome rates by opening cell, by game mode and by first player.
+ *
+ * @param columns The columns to analyze.
+ */
+void printGameStats(const GameColumns& columns) {
+    auto start = chrono::steady_clock::now();
+    OutcomeCounts byOpening;
+    OutcomeCounts byMode;
+    OutcomeCounts byFirstPlayer;
+    aggregateOutcomes(columns, columns.moves[0], -1, byOpening, 0);
+    aggregateOutcomes(columns, columns.mode, -1, byMode, 0);
+    aggregateOutcomes(columns, columns.firstPlayer, -1, byFirstPlayer, 0);
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+
+    string cellLabels[9];
+    for (int cell = 0; cell < 9; ++cell) {
+        cellLabels[cell] = "Cell " + to_string(cell + 1);
+    }
+    string modeLabels[4];
+    for (int mode = 0; mode < 4; ++mode) {
+        modeLabels[mode] = gameModeName(static_cast<GameMode>(mode));
+    }
+    string playerLabels[2] = { "X first", "O first" };
+
+    printOutcomeTable("By opening cell", byOpening, cellLabels, 9);
+    printOutcomeTable("By game mode", byMode, modeLabels, 4);
+    printOutcomeTable("By first player", byFirstPlayer, playerLabels, 2);
+    cout << "\n      " << columns.outcome.size() << " games scanned in " << elapsed.count() << " ms\n";
+}
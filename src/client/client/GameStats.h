@@ -0,0 +1,100 @@
+/**
+ * @file GameStats.h
+ * @brief Contains functions for column-oriented analytics over recorded games.
+ *
+ * Finished games are stored column by column, one byte per game in each column, so a query only
+ * touches the columns it needs. The aggregation kernels process the columns in blocks with branch-free
+ * loops the compiler vectorizes, and large scans are split across hardware threads.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GameArchive.h"
+
+using namespace std;
+
+/**
+ * @brief Value stored in a move column when the game has fewer moves.
+ */
+#define STATS_NO_MOVE           0x0F
+
+/**
+ * @brief Maximum number of distinct values of a grouping column.
+ */
+#define STATS_MAX_GROUPS        16
+
+/**
+ * @brief Number of games processed per block by the aggregation kernels.
+ */
+#define STATS_BLOCK_SIZE        4096
+
+/**
+ * @brief Minimum number of games per thread before a scan is split across threads.
+ */
+#define STATS_MIN_GAMES_PER_THREAD  (1 << 20)
+
+/**
+ * @brief Finished games stored column by column.
+ */
+struct GameColumns {
+    vector<uint8_t> outcome;        ///< Status code (1 Win X, 2 Win O, 3 Draw).
+    vector<uint8_t> mode;           ///< Game mode index (0 Man vs Man, 1 Man vs AI, 2 AI vs Man, 3 AI vs AI).
+    vector<uint8_t> firstPlayer;    ///< 0 if 'X' moved first, 1 if 'O' moved first.
+    vector<uint8_t> moveCount;      ///< Number of moves played.
+    vector<uint8_t> moves[9];       ///< Cell (0-8) of each move, or STATS_NO_MOVE.
+};
+
+/**
+ * @brief Number of games per group and outcome.
+ */
+struct OutcomeCounts {
+    uint64_t counts[STATS_MAX_GROUPS][4];   ///< Games per group value and status code.
+};
+
+/**
+ * @brief Appends packed games to the columns.
+ *
+ * @param games The packed games.
+ * @param count The number of games.
+ * @param columns The columns receiving the games.
+ */
+void appendColumns(const PackedGame* games, size_t count, GameColumns& columns);
+
+/**
+ * @brief Builds the columns from the finished games of a journal.
+ *
+ * @param journalFile The path to the journal file.
+ * @param columns The columns to populate.
+ * @return true if the journal was read, false otherwise.
+ */
+bool loadColumnsFromJournal(const string& journalFile, GameColumns& columns);
+
+/**
+ * @brief Builds the columns from the games of the archive.
+ *
+ * @param archiveFile The path to the archive file.
+ * @param indexFile The path to the index file.
+ * @param columns The columns to populate.
+ * @return true if the archive was read, false otherwise.
+ */
+bool loadColumnsFromArchive(const string& archiveFile, const string& indexFile, GameColumns& columns);
+
+/**
+ * @brief Counts the games per value of a grouping column and per outcome.
+ *
+ * @param columns The columns to scan.
+ * @param group The grouping column (values below STATS_MAX_GROUPS; STATS_NO_MOVE is counted too).
+ * @param modeFilter The game mode index to restrict the scan to, or -1 for all games.
+ * @param result The counts.
+ * @param threads The number of threads to use, or 0 to use every hardware thread.
+ */
+void aggregateOutcomes(const GameColumns& columns, const vector<uint8_t>& group, int modeFilter, OutcomeCounts& result, unsigned threads);
+
+/**
+ * @brief Prints the outcome rates by opening cell, by game mode and by first player.
+ *
+ * @param columns The columns to analyze.
+ */
+void printGameStats(const GameColumns& columns);
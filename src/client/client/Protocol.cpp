@@ -0,0 +1,151 @@
+#include "Protocol.h"
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE checksum of a block of data.
+ *
+ * Uses the polynomial 0x1021 with an initial value of 0xFFFF, the same variant the server computes.
+ *
+ * @param data The data to checksum.
+ * @param length The number of bytes in data.
+ * @return uint16_t The 16-bit checksum.
+ */
+uint16_t crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Encodes a block of data with Consistent Overhead Byte Stuffing.
+ *
+ * Each run of non-zero bytes is prefixed with a code byte holding the distance to the next zero,
+ * so the encoded data never contains a zero and the zero byte can be used as a frame delimiter.
+ *
+ * @param input The data to encode.
+ * @param length The number of bytes in input.
+ * @param output The buffer receiving the encoded data.
+ * @return size_t The number of bytes written to output.
+ */
+size_t cobsEncode(const uint8_t* input, size_t length, uint8_t* output) {
+    size_t codeIndex = 0;
+    size_t writeIndex = 1;
+    uint8_t code = 1;
+    for (size_t readIndex = 0; readIndex < length; ++readIndex) {
+        if (input[readIndex] == 0) {
+            output[codeIndex] = code;
+            code = 1;
+            codeIndex = writeIndex++;
+        }
+        else {
+            output[writeIndex++] = input[readIndex];
+            if (++code == 0xFF) {
+                output[codeIndex] = code;
+                code = 1;
+                codeIndex = writeIndex++;
+            }
+        }
+    }
+    output[codeIndex] = code;
+    return writeIndex;
+}
+
+/**
+ * @brief Decodes a block of COBS-encoded data.
+ *
+ * @param input The encoded data without the zero delimiter.
+ * @param length The number of bytes in input.
+ * @param output The buffer receiving the decoded data.
+ * @return size_t The number of bytes written to output, or 0 if the input is malformed.
+ */
+size_t cobsDecode(const uint8_t* input, size_t length, uint8_t* output) {
+    size_t readIndex = 0;
+    size_t writeIndex = 0;
+    while (readIndex < length) {
+        uint8_t code = input[readIndex];
+        if (code == 0 || readIndex + code > length) {
+            return 0;
+        }
+        readIndex++;
+        for (uint8_t i = 1; i < code; ++i) {
+            output[writeIndex++] = input[readIndex++];
+        }
+        if (code != 0xFF && readIndex != length) {
+            output[writeIndex++] = 0;
+        }
+    }
+    return writeIndex;
+}
+
+/**
+ * @brief Builds a complete encoded frame including the zero delimiter.
+ *
+ * The header and payload are checksummed, the CRC is appended in big-endian order and the
+ * result is COBS-encoded into the output buffer.
+ *
+ * @param type The frame type.
+ * @param seq The message sequence number.
+ * @param index The fragment index.
+ * @param count The number of fragments in the message.
+ * @param payload The fragment payload (may be nullptr if payloadLength is 0).
+ * @param payloadLength The number of payload bytes (at most FRAME_PAYLOAD_SIZE).
+ * @param output The buffer receiving the frame, at least FRAME_MAX_ENCODED_SIZE bytes.
+ * @return size_t The number of bytes written to output.
+ */
+size_t buildFrame(uint8_t type, uint8_t seq, uint8_t index, uint8_t count, const uint8_t* payload, size_t payloadLength, uint8_t* output) {
+    uint8_t raw[FRAME_MAX_SIZE];
+    if (payloadLength > FRAME_PAYLOAD_SIZE) {
+        payloadLength = FRAME_PAYLOAD_SIZE;
+    }
+    raw[0] = type;
+    raw[1] = seq;
+    raw[2] = index;
+    raw[3] = count;
+    for (size_t i = 0; i < payloadLength; ++i) {
+        raw[FRAME_HEADER_SIZE + i] = payload[i];
+    }
+    size_t rawLength = FRAME_HEADER_SIZE + payloadLength;
+    uint16_t crc = crc16(raw, rawLength);
+    raw[rawLength++] = static_cast<uint8_t>(crc >> 8);
+    raw[rawLength++] = static_cast<uint8_t>(crc & 0xFF);
+    size_t encodedLength = cobsEncode(raw, rawLength, output);
+    output[encodedLength++] = 0;
+    return encodedLength;
+}
+
+/**
+ * @brief Decodes and validates a received frame.
+ *
+ * @param encoded The encoded frame without the zero delimiter.
+ * @param length The number of bytes in encoded.
+ * @param frame The frame to populate.
+ * @return true if the frame is well formed and its CRC matches, false otherwise.
+ */
+bool parseFrame(const uint8_t* encoded, size_t length, Frame& frame) {
+    uint8_t raw[FRAME_MAX_ENCODED_SIZE];
+    if (length == 0 || length > FRAME_MAX_ENCODED_SIZE) {
+        return false;
+    }
+    size_t rawLength = cobsDecode(encoded, length, raw);
+    if (rawLength < FRAME_HEADER_SIZE + FRAME_CRC_SIZE || rawLength > FRAME_MAX_SIZE) {
+        return false;
+    }
+    size_t dataLength = rawLength - FRAME_CRC_SIZE;
+    uint16_t expected = static_cast<uint16_t>((raw[dataLength] << 8) | raw[dataLength + 1]);
+    if (crc16(raw, dataLength) != expected) {
+        return false;
+    }
+    frame.type = raw[0];
+    frame.seq = raw[1];
+    frame.index = raw[2];
+    frame.count = raw[3];
+    frame.payloadLength = dataLength - FRAME_HEADER_SIZE;
+    for (size_t i = 0; i < frame.payloadLength; ++i) {
+        frame.payload[i] = raw[FRAME_HEADER_SIZE + i];
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file Protocol.h
+ * @brief Contains functions for framing messages exchanged with the server.
+ *
+ * Every frame on the wire is COBS-encoded and terminated by a zero byte. Before encoding
+ * a frame consists of a 4-byte header (type, sequence number, fragment index, fragment count),
+ * up to FRAME_PAYLOAD_SIZE bytes of payload and a big-endian CRC-16/CCITT over the header and payload.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+ /**
+  * @brief Frame types used by the link protocol.
+  */
+#define FRAME_DATA          0x01
+#define FRAME_ACK           0x02
+#define FRAME_NAK           0x03
+#define FRAME_BAUD          0x04
+#define FRAME_TEST          0x05
+
+/**
+ * @brief Frame layout constants.
+ *
+ * The payload size keeps a complete encoded frame below the 64-byte receive buffer of the Arduino Uno.
+ */
+#define FRAME_HEADER_SIZE       4
+#define FRAME_CRC_SIZE          2
+#define FRAME_PAYLOAD_SIZE      48
+#define FRAME_MAX_SIZE          (FRAME_HEADER_SIZE + FRAME_PAYLOAD_SIZE + FRAME_CRC_SIZE)
+#define FRAME_MAX_ENCODED_SIZE  (FRAME_MAX_SIZE + 2)
+
+/**
+ * @brief A decoded frame.
+ */
+struct Frame {
+    uint8_t type;                           ///< One of the FRAME_* frame types.
+    uint8_t seq;                            ///< Sequence number of the message the frame belongs to.
+    uint8_t index;                          ///< Index of the fragment within the message.
+    uint8_t count;                          ///< Number of fragments in the message.
+    uint8_t payload[FRAME_PAYLOAD_SIZE];    ///< Fragment payload.
+    size_t payloadLength;                   ///< Number of valid bytes in payload.
+};
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE checksum of a block of data.
+ *
+ * @param data The data to checksum.
+ * @param length The number of bytes in data.
+ * @return The 16-bit checksum.
+ */
+uint16_t crc16(const uint8_t* data, size_t length);
+
+/**
+ * @brief Encodes a block of data with Consistent Overhead Byte Stuffing.
+ *
+ * The output never contains a zero byte and is at most length + length / 254 + 1 bytes long.
+ * The terminating zero delimiter is not written.
+ *
+ * @param input The data to encode.
+ * @param length The number of bytes in input.
+ * @param output The buffer receiving the encoded data.
+ * @return The number of bytes written to output.
+ */
+size_t cobsEncode(const uint8_t* input, size_t length, uint8_t* output);
+
+/**
+ * @brief Decodes a block of COBS-encoded data.
+ *
+ * Decoding may be performed in place (output == input).
+ *
+ * @param input The encoded data without the zero delimiter.
+ * @param length The number of bytes in input.
+ * @param output The buffer receiving the decoded data.
+ * @return The number of bytes written to output, or 0 if the input is malformed.
+ */
+size_t cobsDecode(const uint8_t* input, size_t length, uint8_t* output);
+
+/**
+ * @brief Builds a complete encoded frame including the zero delimiter.
+ *
+ * @param type The frame type.
+ * @param seq The message sequence number.
+ * @param index The fragment index.
+ * @param count The number of fragments in the message.
+ * @param payload The fragment payload (may be nullptr if payloadLength is 0).
+ * @param payloadLength The number of payload bytes (at most FRAME_PAYLOAD_SIZE).
+ * @param output The buffer receiving the frame, at least FRAME_MAX_ENCODED_SIZE bytes.
+ * @return The number of bytes written to output.
+ */
+size_t buildFrame(uint8_t type, uint8_t seq, uint8_t index, uint8_t count, const uint8_t* payload, size_t payloadLength, uint8_t* output);
+
+/**
+ * @brief Decodes and validates a received frame.
+ *
+ * @param encoded The encoded frame without the zero delimiter.
+ * @param length The number of bytes in encoded.
+ * @param frame The frame to populate.
+ * @return true if the frame is well formed and its CRC matches, false otherwise.
+ */
+bool parseFrame(const uint8_t* encoded, size_t length, Frame& frame);
@@ -1,11 +1,46 @@
 #include "SerialPort.h"
 
+/**
+ * @brief Bytes of the frame currently being received.
+ */
+static uint8_t rxFrame[FRAME_MAX_ENCODED_SIZE];
+static size_t rxFrameLength = 0;
+static bool rxFrameOverflow = false;
+
+/**
+ * @brief Bytes read from the port but not yet consumed by readFrame.
+ */
+static uint8_t rxChunk[256];
+static DWORD rxChunkLength = 0;
+static DWORD rxChunkPos = 0;
+
+/**
+ * @brief Sequence number of the last message sent, and a response frame received while waiting for an ACK.
+ */
+static uint8_t txSeq = 0;
+static Frame pendingFrame;
+static bool hasPendingFrame = false;
+
+/**
+ * @brief Current rate of the port and the highest rate the user allowed for negotiation.
+ */
+static DWORD currentBaudRate = BASE_BAUD_RATE;
+static DWORD negotiationMaxRate = BASE_BAUD_RATE;
+
+/**
+ * @brief Candidate rates for negotiation, fastest first.
+ *
+ * 1 Mbps, 500 kbps and 250 kbps divide the Uno's 16 MHz clock exactly.
+ */
+static const DWORD candidateBaudRates[] = { CBR_1000000, CBR_500000, CBR_250000, CBR_115200, CBR_57600, CBR_38400, CBR_19200 };
+
 /**
  * @brief Opens a serial port with specified settings.
  *
  * This function initializes the serial port with the specified port name and baud rate.
  * It configures the communication parameters such as baud rate, byte size, stop bits, and parity.
- * The function also sets timeouts for read and write operations.
+ * Reads are configured to return as soon as any byte is available (or after 10 ms), so that
+ * readFrame can enforce its own per-frame deadlines.
  *
  * @param portName The name of the port to open (e.g., "COM1").
  * @param baudRate The baud rate for the serial communication (e.g., 9600, 115200).
@@ -41,60 +76,422 @@ HANDLE openSerialPort(const wstring& portName, DWORD baudRate) {
     }
 
     COMMTIMEOUTS timeouts = { 0 };
-    timeouts.ReadIntervalTimeout = 50;
-    timeouts.ReadTotalTimeoutConstant = 50;
-    timeouts.ReadTotalTimeoutMultiplier = 10;
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = 10;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
     timeouts.WriteTotalTimeoutConstant = 1000;
     timeouts.WriteTotalTimeoutMultiplier = 10;
-    SetCommTimeouts(hSerial, &timeouts);
 
-    DWORD dwInQueue = 0;
-    DWORD dwOutQueue = 0;
     SetupComm(hSerial, 8192, 8192);
     SetCommTimeouts(hSerial, &timeouts);
+    PurgeComm(hSerial, PURGE_RXCLEAR | PURGE_TXCLEAR);
+
+    rxFrameLength = 0;
+    rxFrameOverflow = false;
+    rxChunkLength = 0;
+    rxChunkPos = 0;
+    hasPendingFrame = false;
+    currentBaudRate = baudRate;
 
     return hSerial;
 }
 
 /**
- * @brief Sends a message to the serial port.
+ * @brief Changes the baud rate of an open serial port.
+ *
+ * Pending input is discarded, since bytes received at the old rate are meaningless at the new one.
  *
- * This function writes the given message to the serial port.
- * It uses the `WriteFile` function to send the data and waits for the specified message length to be written.
+ * @param hSerial Handle to the serial port.
+ * @param baudRate The new baud rate.
+ *
+ * @return true if the port accepted the new rate, false otherwise.
+ */
+bool setPortBaudRate(HANDLE hSerial, DWORD baudRate) {
+    DCB dcbSerialParams = { 0 };
+    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+    if (!GetCommState(hSerial, &dcbSerialParams)) {
+        return false;
+    }
+    dcbSerialParams.BaudRate = baudRate;
+    if (!SetCommState(hSerial, &dcbSerialParams)) {
+        return false;
+    }
+    PurgeComm(hSerial, PURGE_RXCLEAR);
+    rxFrameLength = 0;
+    rxFrameOverflow = false;
+    rxChunkLength = 0;
+    rxChunkPos = 0;
+    currentBaudRate = baudRate;
+    return true;
+}
+
+/**
+ * @brief Asks the server to use a baud rate and waits for its acknowledgement.
+ *
+ * The same request sent at the new rate confirms it, which ends the server's probation period.
  *
  * @param hSerial Handle to the serial port.
- * @param message The message to send as a C-style string.
+ * @param baudRate The requested baud rate.
+ *
+ * @return true if the server acknowledged the request, false if the retry limit was exceeded.
  */
-void sendMessage(HANDLE hSerial, const string& message) {
+static bool requestBaudRate(HANDLE hSerial, DWORD baudRate) {
+    uint8_t payload[4] = {
+        static_cast<uint8_t>(baudRate >> 24), static_cast<uint8_t>(baudRate >> 16),
+        static_cast<uint8_t>(baudRate >> 8), static_cast<uint8_t>(baudRate)
+    };
+    uint8_t seq = ++txSeq;
+    for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
+        writeFrame(hSerial, FRAME_BAUD, seq, 0, 1, payload, sizeof(payload));
+        Frame reply;
+        while (readFrame(hSerial, reply, ACK_TIMEOUT_MS) == FRAME_RECEIVED) {
+            if (reply.type == FRAME_ACK && reply.seq == seq) {
+                return true;
+            }
+            if (reply.type == FRAME_NAK) {
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks that test patterns are echoed back intact at the current rate.
+ *
+ * The pattern covers zero and 0xFF bytes so that COBS stuffing is exercised as well.
+ * Any corrupted, missing or altered echo fails the check; no retries are made, since
+ * errors at this stage mean the rate is not reliable.
+ *
+ * @param hSerial Handle to the serial port.
+ *
+ * @return true if every test pattern was echoed correctly, false otherwise.
+ */
+static bool verifyLink(HANDLE hSerial) {
+    for (int round = 0; round < BAUD_TEST_ROUNDS; ++round) {
+        uint8_t pattern[FRAME_PAYLOAD_SIZE];
+        for (int i = 0; i < FRAME_PAYLOAD_SIZE; ++i) {
+            pattern[i] = static_cast<uint8_t>(i * 53 + round * 97);
+        }
+        uint8_t seq = ++txSeq;
+        writeFrame(hSerial, FRAME_TEST, seq, static_cast<uint8_t>(round), BAUD_TEST_ROUNDS, pattern, sizeof(pattern));
+        Frame echo;
+        if (readFrame(hSerial, echo, ACK_TIMEOUT_MS) != FRAME_RECEIVED || echo.type != FRAME_TEST ||
+            echo.seq != seq || echo.payloadLength != sizeof(pattern) || memcmp(echo.payload, pattern, sizeof(pattern)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns both sides of the link to the base rate.
+ *
+ * The port drops to the base rate and sends a few frames; at the server's faster rate they arrive
+ * as corrupted frames, which makes the server fall back to the base rate as well.
+ *
+ * @param hSerial Handle to the serial port.
+ */
+static void fallBackToBaseRate(HANDLE hSerial) {
+    setPortBaudRate(hSerial, BASE_BAUD_RATE);
+    for (int i = 0; i <= BAUD_ERROR_LIMIT; ++i) {
+        writeFrame(hSerial, FRAME_NAK, txSeq, 0, 0, nullptr, 0);
+    }
+    Sleep(BAUD_PROBATION_MS);
+    PurgeComm(hSerial, PURGE_RXCLEAR);
+}
+
+/**
+ * @brief Negotiates the highest baud rate that works reliably with the server.
+ *
+ * If the port is not at the base rate, both sides are first returned to it.
+ * For each candidate rate the server is asked at the base rate to switch, both sides change
+ * rate, the link is verified with echoed test patterns and the rate is confirmed. If any step
+ * fails the client returns to the base rate and stays silent until the server's probation
+ * period expires, after which the server is back at the base rate too.
+ *
+ * @param hSerial Handle to the serial port, opened at BASE_BAUD_RATE.
+ * @param maxRate The highest rate to try.
+ *
+ * @return DWORD The negotiated baud rate (BASE_BAUD_RATE if no faster rate works).
+ */
+DWORD negotiateBaudRate(HANDLE hSerial, DWORD maxRate) {
+    negotiationMaxRate = maxRate;
+    if (currentBaudRate != BASE_BAUD_RATE) {
+        fallBackToBaseRate(hSerial);
+    }
+    for (DWORD rate : candidateBaudRates) {
+        if (rate > maxRate) {
+            continue;
+        }
+        if (!requestBaudRate(hSerial, rate)) {
+            return BASE_BAUD_RATE;
+        }
+        Sleep(BAUD_SWITCH_DELAY_MS);
+        if (setPortBaudRate(hSerial, rate) && verifyLink(hSerial) && requestBaudRate(hSerial, rate)) {
+            return rate;
+        }
+        setPortBaudRate(hSerial, BASE_BAUD_RATE);
+        Sleep(BAUD_PROBATION_MS * 2);
+    }
+    return BASE_BAUD_RATE;
+}
+
+/**
+ * @brief Writes a single frame to the serial port.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param type The frame type (FRAME_DATA, FRAME_ACK or FRAME_NAK).
+ * @param seq The message sequence number.
+ * @param index The fragment index.
+ * @param count The number of fragments in the message.
+ * @param payload The fragment payload (may be nullptr if payloadLength is 0).
+ * @param payloadLength The number of payload bytes.
+ */
+void writeFrame(HANDLE hSerial, uint8_t type, uint8_t seq, uint8_t index, uint8_t count, const uint8_t* payload, size_t payloadLength) {
+    uint8_t encoded[FRAME_MAX_ENCODED_SIZE];
+    size_t length = buildFrame(type, seq, index, count, payload, payloadLength, encoded);
     DWORD bytesWritten;
-    WriteFile(hSerial, message.c_str(), message.length(), &bytesWritten, NULL);
-    Sleep(100);
+    WriteFile(hSerial, encoded, static_cast<DWORD>(length), &bytesWritten, NULL);
 }
 
 /**
- * @brief Reads a message from the serial port.
+ * @brief Waits for the next frame from the serial port.
  *
- * This function reads data from the serial port and stores it in a buffer.
- * It waits until a newline character (`\n`) is encountered, indicating the end of the message.
- * The message is then returned as a `string`.
+ * Bytes are accumulated until the zero delimiter is seen. A frame that overflows the receive
+ * buffer, fails COBS decoding or has a wrong CRC is reported as corrupted, so a dropped or
+ * damaged byte only costs the frame it belongs to.
  *
  * @param hSerial Handle to the serial port.
+ * @param frame The frame to populate.
+ * @param timeoutMs The maximum time to wait in milliseconds.
  *
- * @return string The message read from the serial port.
+ * @return FrameStatus Whether a valid frame, a corrupted frame or nothing was received.
  */
-string readMessage(HANDLE hSerial) {
-    static char buffer[256];
-    DWORD bytesRead;
-    string result;
+FrameStatus readFrame(HANDLE hSerial, Frame& frame, DWORD timeoutMs) {
+    ULONGLONG deadline = GetTickCount64() + timeoutMs;
     while (true) {
-        if (ReadFile(hSerial, buffer, sizeof(buffer) - 1, &bytesRead, NULL)) {
-            buffer[bytesRead] = '\0';
-            result.append(buffer, bytesRead);
-            if (result.find('\n') != string::npos) {
+        while (rxChunkPos < rxChunkLength) {
+            uint8_t value = rxChunk[rxChunkPos++];
+            if (value != 0) {
+                if (rxFrameLength < sizeof(rxFrame)) {
+                    rxFrame[rxFrameLength++] = value;
+                }
+                else {
+                    rxFrameOverflow = true;
+                }
+                continue;
+            }
+            size_t length = rxFrameLength;
+            bool overflow = rxFrameOverflow;
+            rxFrameLength = 0;
+            rxFrameOverflow = false;
+            if (length == 0 && !overflow) {
+                continue;
+            }
+            return (!overflow && parseFrame(rxFrame, length, frame)) ? FRAME_RECEIVED : FRAME_CORRUPTED;
+        }
+        if (GetTickCount64() >= deadline) {
+            return FRAME_TIMEOUT;
+        }
+        rxChunkPos = 0;
+        if (!ReadFile(hSerial, rxChunk, sizeof(rxChunk), &rxChunkLength, NULL)) {
+            rxChunkLength = 0;
+        }
+    }
+}
+
+/**
+ * @brief Sends one fragment of a message and waits for it to be acknowledged.
+ *
+ * The fragment is retransmitted on a NAK or when no ACK arrives within ACK_TIMEOUT_MS.
+ * If the server starts sending its response while the ACK for the last fragment was lost,
+ * the response frame is kept for readMessage and counts as the acknowledgement.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param seq The message sequence number.
+ * @param index The fragment index.
+ * @param count The number of fragments in the message.
+ * @param payload The fragment payload.
+ * @param payloadLength The number of payload bytes.
+ *
+ * @return true if the fragment was acknowledged, false if the retry limit was exceeded.
+ */
+static bool sendFragment(HANDLE hSerial, uint8_t seq, uint8_t index, uint8_t count, const uint8_t* payload, size_t payloadLength) {
+    for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
+        writeFrame(hSerial, FRAME_DATA, seq, index, count, payload, payloadLength);
+        Frame reply;
+        while (readFrame(hSerial, reply, ACK_TIMEOUT_MS) == FRAME_RECEIVED) {
+            if (reply.type == FRAME_ACK && reply.seq == seq && reply.index == index) {
+                return true;
+            }
+            if (reply.type == FRAME_DATA && reply.seq == seq && reply.index == 0 && index + 1 == count) {
+                pendingFrame = reply;
+                hasPendingFrame = true;
+                return true;
+            }
+            if (reply.type == FRAME_DATA && reply.seq != seq) {
+                writeFrame(hSerial, FRAME_ACK, reply.seq, reply.index, 0, nullptr, 0);
+                continue;
+            }
+            if (reply.type == FRAME_NAK) {
                 break;
             }
         }
     }
+    return false;
+}
+
+/**
+ * @brief Sends a message as a sequence of acknowledged fragments.
+ *
+ * The message is split into fragments of at most FRAME_PAYLOAD_SIZE bytes. Each fragment is sent
+ * as a COBS-encoded frame with a CRC-16 and is retransmitted individually until the server
+ * acknowledges it, so a corrupted fragment is resent within milliseconds.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param message The message to send.
+ * @param messageLength The length of the message.
+ *
+ * @return true if every fragment was acknowledged, false if the retry limit was exceeded.
+ */
+static bool transmitMessage(HANDLE hSerial, const char* message, size_t messageLength) {
+    size_t count = (messageLength + FRAME_PAYLOAD_SIZE - 1) / FRAME_PAYLOAD_SIZE;
+    if (count == 0) {
+        count = 1;
+    }
+    if (count > 0xFF) {
+        return false;
+    }
+    txSeq++;
+    hasPendingFrame = false;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(message);
+    for (size_t index = 0; index < count; ++index) {
+        size_t offset = index * FRAME_PAYLOAD_SIZE;
+        size_t length = messageLength - offset;
+        if (length > FRAME_PAYLOAD_SIZE) {
+            length = FRAME_PAYLOAD_SIZE;
+        }
+        if (!sendFragment(hSerial, txSeq, static_cast<uint8_t>(index), static_cast<uint8_t>(count), data + offset, length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sends a message to the serial port.
+ *
+ * If the message cannot be delivered at a negotiated rate, the link is renegotiated from the
+ * base rate and the message is sent once more.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param message The message to send.
+ *
+ * @return true if every fragment was acknowledged, false if the retry limit was exceeded.
+ */
+bool sendMessage(HANDLE hSerial, const string& message) {
+    return sendMessage(hSerial, message.data(), message.length());
+}
+
+/**
+ * @brief Sends a message held in a transmit buffer to the serial port.
+ *
+ * If the message cannot be delivered at a negotiated rate, the link is renegotiated from the
+ * base rate and the message is sent once more.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param data The message to send.
+ * @param length The length of the message.
+ *
+ * @return true if every fragment was acknowledged, false if the retry limit was exceeded.
+ */
+bool sendMessage(HANDLE hSerial, const char* data, size_t length) {
+    if (transmitMessage(hSerial, data, length)) {
+        return true;
+    }
+    if (currentBaudRate == BASE_BAUD_RATE) {
+        return false;
+    }
+    negotiateBaudRate(hSerial, negotiationMaxRate);
+    return transmitMessage(hSerial, data, length);
+}
+
+/**
+ * @brief Reads the reply to the last sent message from the serial port.
+ *
+ * Fragments of the reply are acknowledged as they arrive in order. A corrupted frame or a missing
+ * fragment is answered with a NAK so the server resends it, and duplicates are acknowledged again.
+ * Instead of waiting forever the function gives up after MAX_RETRIES consecutive failures;
+ * at a negotiated rate the link is then renegotiated so that the next message can get through.
+ *
+ * The reply is assembled in the caller's buffer, which keeps its capacity between calls.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param message The buffer receiving the message.
+ *
+ * @return true if the complete message was received, false otherwise.
+ */
+bool readMessage(HANDLE hSerial, string& message) {
+    message.clear();
+    uint8_t next = 0;
+    uint8_t count = 0;
+    int failures = 0;
+    while (failures < MAX_RETRIES) {
+        Frame frame;
+        FrameStatus status;
+        if (hasPendingFrame) {
+            frame = pendingFrame;
+            hasPendingFrame = false;
+            status = FRAME_RECEIVED;
+        }
+        else {
+            status = readFrame(hSerial, frame, next == 0 ? RESPONSE_TIMEOUT_MS : ACK_TIMEOUT_MS);
+        }
+        if (status != FRAME_RECEIVED) {
+            if (status == FRAME_CORRUPTED || next > 0) {
+                writeFrame(hSerial, FRAME_NAK, txSeq, next, count, nullptr, 0);
+            }
+            failures++;
+            continue;
+        }
+        if (frame.type != FRAME_DATA || frame.seq != txSeq) {
+            continue;
+        }
+        if (frame.index < next) {
+            writeFrame(hSerial, FRAME_ACK, frame.seq, frame.index, 0, nullptr, 0);
+            continue;
+        }
+        if (frame.index != next || (next > 0 && frame.count != count)) {
+            writeFrame(hSerial, FRAME_NAK, txSeq, next, count, nullptr, 0);
+            failures++;
+            continue;
+        }
+        count = frame.count;
+        message.append(reinterpret_cast<const char*>(frame.payload), frame.payloadLength);
+        writeFrame(hSerial, FRAME_ACK, frame.seq, frame.index, 0, nullptr, 0);
+        failures = 0;
+        if (++next == count) {
+            return true;
+        }
+    }
+    message.clear();
+    if (currentBaudRate != BASE_BAUD_RATE) {
+        negotiateBaudRate(hSerial, negotiationMaxRate);
+    }
+    return false;
+}
+
+/**
+ * @brief Reads the reply to the last sent message from the serial port.
+ *
+ * @param hSerial Handle to the serial port.
+ *
+ * @return string The message read from the serial port, or an empty string if it could not be received.
+ */
+string readMessage(HANDLE hSerial) {
+    string result;
+    readMessage(hSerial, result);
     return result;
 }
 
@@ -133,30 +530,30 @@ wstring selectPort() {
 }
 
 /**
- * @brief Prompts the user to select a baud rate for serial communication.
+ * @brief Prompts the user to select the highest baud rate to negotiate.
  *
- * This function displays a list of available baud rates (9600, 115200, 19200) and prompts
- * the user to select one. The selected baud rate is returned as a DWORD value.
+ * This function displays a list of maximum baud rates and prompts the user to select one.
+ * The link always starts at BASE_BAUD_RATE and is negotiated up to the selected rate.
  *
- * @return DWORD The baud rate selected by the user (e.g., CBR_9600).
+ * @return DWORD The maximum baud rate selected by the user (e.g., CBR_1000000).
  */
 DWORD selectBaudRate() {
     cout << "=============================================\n";
-    cout << "      Available Baud Rates:\n";
+    cout << "      Maximum Baud Rate:\n";
     cout << "=============================================\n";
-    vector<DWORD> baudRates = { CBR_9600, CBR_115200, CBR_19200 };
-    vector<string> baudOptions = { "9600", "115200", "19200" };
+    vector<DWORD> baudRates = { CBR_1000000, CBR_500000, CBR_250000, CBR_115200, CBR_19200, CBR_9600 };
+    vector<string> baudOptions = { "1000000 (auto)", "500000", "250000", "115200", "19200", "9600" };
     for (size_t i = 0; i < baudOptions.size(); ++i) {
         cout << "  [" << i + 1 << "]  " << baudOptions[i] << " bps\n";
     }
     int baudChoice;
-    cout << "\nPlease, enter your choice (1-3): ";
+    cout << "\nPlease, enter your choice (1-" << baudRates.size() << "): ";
     cin >> baudChoice;
-    if (baudChoice >= 1 && baudChoice <= 3) {
+    if (baudChoice >= 1 && baudChoice <= static_cast<int>(baudRates.size())) {
         return baudRates[baudChoice - 1];
     }
     else {
-        cerr << "Invalid choice, using default (9600 bps)." << endl;
-        return CBR_9600;
+        cerr << "Invalid choice, using default (1000000 bps)." << endl;
+        return CBR_1000000;
     }
-}
\ No newline at end of file
+}
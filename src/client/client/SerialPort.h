@@ -6,10 +6,12 @@
 #pragma once
 
 #include <windows.h>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
+#include "Protocol.h"
 
 using namespace std;
 
@@ -19,6 +21,34 @@ using namespace std;
 #define CBR_9600            9600
 #define CBR_19200           19200
 #define CBR_115200          115200
+#define CBR_250000          250000
+#define CBR_500000          500000
+#define CBR_1000000         1000000
+
+/**
+ * @brief Rate the server listens on after a reset and falls back to on errors.
+ */
+#define BASE_BAUD_RATE      CBR_9600
+
+/**
+ * @brief Link protocol timing constants.
+ */
+#define ACK_TIMEOUT_MS          250
+#define RESPONSE_TIMEOUT_MS     3000
+#define MAX_RETRIES             5
+#define BAUD_SWITCH_DELAY_MS    20
+#define BAUD_PROBATION_MS       500
+#define BAUD_TEST_ROUNDS        3
+#define BAUD_ERROR_LIMIT        3
+
+/**
+ * @brief Result of waiting for a frame on the serial port.
+ */
+enum FrameStatus {
+    FRAME_RECEIVED,     ///< A valid frame was received.
+    FRAME_CORRUPTED,    ///< A frame was received but failed decoding or the CRC check.
+    FRAME_TIMEOUT       ///< No complete frame arrived before the timeout.
+};
 
   /**
    * @brief Opens a serial port with specified settings.
@@ -30,20 +60,94 @@ using namespace std;
    */
 HANDLE openSerialPort(const wstring& portName, DWORD baudRate);
 
+/**
+ * @brief Changes the baud rate of an open serial port.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param baudRate The new baud rate.
+ *
+ * @return true if the port accepted the new rate, false otherwise.
+ */
+bool setPortBaudRate(HANDLE hSerial, DWORD baudRate);
+
+/**
+ * @brief Negotiates the highest baud rate that works reliably with the server.
+ *
+ * The link starts at BASE_BAUD_RATE. Candidate rates up to maxRate are proposed from the fastest down;
+ * each one is verified with a test pattern echoed by the server and the first that passes is kept.
+ *
+ * @param hSerial Handle to the serial port, opened at BASE_BAUD_RATE.
+ * @param maxRate The highest rate to try.
+ *
+ * @return DWORD The negotiated baud rate (BASE_BAUD_RATE if no faster rate works).
+ */
+DWORD negotiateBaudRate(HANDLE hSerial, DWORD maxRate);
+
+/**
+ * @brief Writes a single frame to the serial port.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param type The frame type (FRAME_DATA, FRAME_ACK or FRAME_NAK).
+ * @param seq The message sequence number.
+ * @param index The fragment index.
+ * @param count The number of fragments in the message.
+ * @param payload The fragment payload (may be nullptr if payloadLength is 0).
+ * @param payloadLength The number of payload bytes.
+ */
+void writeFrame(HANDLE hSerial, uint8_t type, uint8_t seq, uint8_t index, uint8_t count, const uint8_t* payload, size_t payloadLength);
+
+/**
+ * @brief Waits for the next frame from the serial port.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param frame The frame to populate.
+ * @param timeoutMs The maximum time to wait in milliseconds.
+ *
+ * @return FrameStatus Whether a valid frame, a corrupted frame or nothing was received.
+ */
+FrameStatus readFrame(HANDLE hSerial, Frame& frame, DWORD timeoutMs);
+
 /**
  * @brief Sends a message to the serial port.
  *
+ * The message is split into fragments, each of which is retransmitted until the server acknowledges it.
+ * If the link fails at a negotiated rate, the port falls back to BASE_BAUD_RATE, renegotiates and
+ * sends the message once more.
+ *
  * @param hSerial Handle to the serial port.
- * @param message The message to send as a C-style string.
+ * @param message The message to send.
+ *
+ * @return true if every fragment was acknowledged, false if the retry limit was exceeded.
+ */
+bool sendMessage(HANDLE hSerial, const string& message);
+
+/**
+ * @brief Sends a message held in a transmit buffer to the serial port.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param data The message to send.
+ * @param length The length of the message.
+ *
+ * @return true if every fragment was acknowledged, false if the retry limit was exceeded.
+ */
+bool sendMessage(HANDLE hSerial, const char* data, size_t length);
+
+/**
+ * @brief Reads the reply to the last sent message into a reusable buffer.
+ *
+ * @param hSerial Handle to the serial port.
+ * @param message The buffer receiving the message; it keeps its capacity between calls.
+ *
+ * @return true if the complete message was received, false otherwise.
  */
-void sendMessage(HANDLE hSerial, const string& message);
+bool readMessage(HANDLE hSerial, string& message);
 
 /**
- * @brief Reads a message from the serial port.
+ * @brief Reads the reply to the last sent message from the serial port.
  *
  * @param hSerial Handle to the serial port.
  *
- * @return string The message read from the serial port.
+ * @return string The message read from the serial port, or an empty string if it could not be received.
  */
 string readMessage(HANDLE hSerial);
 
@@ -59,11 +163,11 @@ string readMessage(HANDLE hSerial);
 wstring selectPort();
 
 /**
- * @brief Prompts the user to select a baud rate for serial communication.
+ * @brief Prompts the user to select the highest baud rate to negotiate.
  *
- * This function displays a list of available baud rates (9600, 115200, 19200) and prompts
+ * This function displays a list of maximum baud rates (from 1 Mbps down to 9600) and prompts
  * the user to select one. The selected baud rate is returned as a DWORD value.
  *
- * @return DWORD The baud rate selected by the user (e.g., CBR_9600).
+ * @return DWORD The maximum baud rate selected by the user (e.g., CBR_1000000).
  */
 DWORD selectBaudRate();
\ No newline at end of file
@@ -114,6 +114,64 @@ static inline int TIXML_VSCPRINTF(const char* format, va_list va)
 #define TIXML_FTELL ftell
 #endif
 
+#if !defined(TINYXML2_NO_CHARCONV) && ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L)
+#   include <charconv>
+#   include <system_error>
+#   include <type_traits>
+// Only standard libraries with floating point support define __cpp_lib_to_chars.
+#   if defined(__cpp_lib_to_chars)
+#       define TIXML_CHARCONV
+#   endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <cerrno>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#   define TIXML_WRITEV
+#   if !defined(TINYXML2_NO_MMAP)
+#       include <sys/mman.h>
+#       define TIXML_MMAP_POSIX
+#       if !defined(MAP_ANONYMOUS)
+#           define MAP_ANONYMOUS MAP_ANON
+#       endif
+#   endif
+#elif defined(_WIN32) && !defined(WINCE) && !defined(TINYXML2_NO_MMAP)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#   include <io.h>
+#   define TIXML_MMAP_WIN32
+#endif
+
+
+#if !defined(TINYXML2_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+// SSE2 is part of every x64 processor; AVX2 is compiled in as well and used
+// only when the processor reports it at runtime.
+#   define TIXML_SCAN_SSE2
+#   define TIXML_SCAN_AVX2
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#       define TIXML_TARGET_AVX2
+#   else
+#       define TIXML_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+// The block loads may read past the null terminator (never past the page
+// holding it), which address sanitizers would otherwise report.
+#   if defined(__GNUC__)
+#       define TIXML_NO_SANITIZE __attribute__((no_sanitize_address))
+#   elif defined(_MSC_VER) && defined(__SANITIZE_ADDRESS__)
+#       define TIXML_NO_SANITIZE __declspec(no_sanitize_address)
+#   else
+#       define TIXML_NO_SANITIZE
+#   endif
+#endif
+
 
 static const char LINE_FEED = static_cast<char>(0x0a);			// all line endings are normalized to LF
 static const char LF = LINE_FEED;
@@ -149,6 +207,351 @@ namespace tinyxml2
     };
 
 
+    // ---------- Scan kernels ---------- //
+    // Whitespace is the C locale set: TAB through CR, and SPACE. Bytes with
+    // the high bit set are never whitespace (see XMLUtil::IsWhiteSpace).
+
+    static const char* SkipWhiteSpaceScalar(const char* p, int* curLineNumPtr)
+    {
+        while (XMLUtil::IsWhiteSpace(*p)) {
+            if (curLineNumPtr && *p == LF) {
+                ++(*curLineNumPtr);
+            }
+            ++p;
+        }
+        return p;
+    }
+
+    static char* FindTextStopScalar(char* p, char stopChar, int* curLineNumPtr)
+    {
+        while (*p && *p != stopChar) {
+            if (curLineNumPtr && *p == LF) {
+                ++(*curLineNumPtr);
+            }
+            ++p;
+        }
+        return p;
+    }
+
+    // Returns the first character in [p, end) equal to a, b or c, or end.
+    static const char* FindAnyOfScalar(const char* p, const char* end, char a, char b, char c)
+    {
+        while (p < end && *p != a && *p != b && *p != c) {
+            ++p;
+        }
+        return p;
+    }
+
+#if defined(TIXML_SCAN_SSE2)
+    // Smallest page size of the x86 processors; a load that stays inside one
+    // page cannot fault when any byte of that page is readable.
+    static const uintptr_t TIXML_SCAN_PAGE_SIZE = 4096;
+
+    static inline bool BlockFitsInPage(const char* p, uintptr_t blockSize)
+    {
+        return (reinterpret_cast<uintptr_t>(p) & (TIXML_SCAN_PAGE_SIZE - 1)) <= TIXML_SCAN_PAGE_SIZE - blockSize;
+    }
+
+    static inline int TrailingZeros(uint32_t mask)
+    {
+        TIXMLASSERT(mask != 0);
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    static inline int CountBits(uint32_t mask)
+    {
+        mask = mask - ((mask >> 1) & 0x55555555u);
+        mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+        return static_cast<int>((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+    }
+
+    // Adds the newlines in front of the first stop bit (or all of them) to the line count.
+    static inline void CountLines(uint32_t newlines, uint32_t stop, int* curLineNumPtr)
+    {
+        if (curLineNumPtr && newlines) {
+            if (stop) {
+                newlines &= (1u << TrailingZeros(stop)) - 1;
+            }
+            *curLineNumPtr += CountBits(newlines);
+        }
+    }
+
+    static inline uint32_t WhiteSpaceMaskSSE2(__m128i block)
+    {
+        const __m128i control = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+        const __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8('\r' - '\t')), control);
+        const __m128i isSpace = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(isControl, isSpace)));
+    }
+
+    static TIXML_NO_SANITIZE const char* SkipWhiteSpaceSSE2(const char* p, int* curLineNumPtr)
+    {
+        const __m128i lf = _mm_set1_epi8(LF);
+        for (;;) {
+            if (!BlockFitsInPage(p, 16)) {
+                if (!XMLUtil::IsWhiteSpace(*p)) {
+                    return p;
+                }
+                if (curLineNumPtr && *p == LF) {
+                    ++(*curLineNumPtr);
+                }
+                ++p;
+                continue;
+            }
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const uint32_t stop = ~WhiteSpaceMaskSSE2(block) & 0xFFFFu;
+            CountLines(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf))), stop, curLineNumPtr);
+            if (stop) {
+                return p + TrailingZeros(stop);
+            }
+            p += 16;
+        }
+    }
+
+    static TIXML_NO_SANITIZE char* FindTextStopSSE2(char* p, char stopChar, int* curLineNumPtr)
+    {
+        const __m128i lf = _mm_set1_epi8(LF);
+        const __m128i stopChars = _mm_set1_epi8(stopChar);
+        const __m128i zero = _mm_setzero_si128();
+        for (;;) {
+            if (!BlockFitsInPage(p, 16)) {
+                if (!*p || *p == stopChar) {
+                    return p;
+                }
+                if (curLineNumPtr && *p == LF) {
+                    ++(*curLineNumPtr);
+                }
+                ++p;
+                continue;
+            }
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const uint32_t stop = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(block, stopChars), _mm_cmpeq_epi8(block, zero))));
+            CountLines(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf))), stop, curLineNumPtr);
+            if (stop) {
+                return p + TrailingZeros(stop);
+            }
+            p += 16;
+        }
+    }
+
+    static const char* FindAnyOfSSE2(const char* p, const char* end, char a, char b, char c)
+    {
+        const __m128i charA = _mm_set1_epi8(a);
+        const __m128i charB = _mm_set1_epi8(b);
+        const __m128i charC = _mm_set1_epi8(c);
+        while (end - p >= 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i found = _mm_or_si128(_mm_cmpeq_epi8(block, charA),
+                _mm_or_si128(_mm_cmpeq_epi8(block, charB), _mm_cmpeq_epi8(block, charC)));
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(found));
+            if (mask) {
+                return p + TrailingZeros(mask);
+            }
+            p += 16;
+        }
+        return FindAnyOfScalar(p, end, a, b, c);
+    }
+#endif
+
+#if defined(TIXML_SCAN_AVX2)
+    static TIXML_TARGET_AVX2 inline uint32_t WhiteSpaceMaskAVX2(__m256i block)
+    {
+        const __m256i control = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+        const __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8('\r' - '\t')), control);
+        const __m256i isSpace = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' '));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(isControl, isSpace)));
+    }
+
+    static TIXML_NO_SANITIZE TIXML_TARGET_AVX2 const char* SkipWhiteSpaceAVX2(const char* p, int* curLineNumPtr)
+    {
+        const __m256i lf = _mm256_set1_epi8(LF);
+        for (;;) {
+            if (!BlockFitsInPage(p, 32)) {
+                if (!XMLUtil::IsWhiteSpace(*p)) {
+                    return p;
+                }
+                if (curLineNumPtr && *p == LF) {
+                    ++(*curLineNumPtr);
+                }
+                ++p;
+                continue;
+            }
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const uint32_t stop = ~WhiteSpaceMaskAVX2(block);
+            CountLines(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lf))), stop, curLineNumPtr);
+            if (stop) {
+                return p + TrailingZeros(stop);
+            }
+            p += 32;
+        }
+    }
+
+    static TIXML_NO_SANITIZE TIXML_TARGET_AVX2 char* FindTextStopAVX2(char* p, char stopChar, int* curLineNumPtr)
+    {
+        const __m256i lf = _mm256_set1_epi8(LF);
+        const __m256i stopChars = _mm256_set1_epi8(stopChar);
+        const __m256i zero = _mm256_setzero_si256();
+        for (;;) {
+            if (!BlockFitsInPage(p, 32)) {
+                if (!*p || *p == stopChar) {
+                    return p;
+                }
+                if (curLineNumPtr && *p == LF) {
+                    ++(*curLineNumPtr);
+                }
+                ++p;
+                continue;
+            }
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const uint32_t stop = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, stopChars), _mm256_cmpeq_epi8(block, zero))));
+            CountLines(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lf))), stop, curLineNumPtr);
+            if (stop) {
+                return p + TrailingZeros(stop);
+            }
+            p += 32;
+        }
+    }
+
+    static TIXML_TARGET_AVX2 const char* FindAnyOfAVX2(const char* p, const char* end, char a, char b, char c)
+    {
+        const __m256i charA = _mm256_set1_epi8(a);
+        const __m256i charB = _mm256_set1_epi8(b);
+        const __m256i charC = _mm256_set1_epi8(c);
+        while (end - p >= 32) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(block, charA),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, charB), _mm256_cmpeq_epi8(block, charC)));
+            const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+            if (mask) {
+                return p + TrailingZeros(mask);
+            }
+            p += 32;
+        }
+        return FindAnyOfSSE2(p, end, a, b, c);
+    }
+
+    static bool ProcessorSupportsAVX2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (!osSavesYmm || (info[2] & (1 << 28)) == 0) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif
+
+    static XMLScanKernel BestScanKernel()
+    {
+#if defined(TIXML_SCAN_AVX2)
+        if (ProcessorSupportsAVX2()) {
+            return XML_SCAN_AVX2;
+        }
+#endif
+#if defined(TIXML_SCAN_SSE2)
+        return XML_SCAN_SSE2;
+#else
+        return XML_SCAN_SCALAR;
+#endif
+    }
+
+    static XMLScanKernel& ActiveScanKernel()
+    {
+        static XMLScanKernel kernel = BestScanKernel();
+        return kernel;
+    }
+
+    // Returns the first character in [p, end) that GetStr() has to rewrite, or end.
+    static const char* FindProcessedChar(const char* p, const char* end, int flags)
+    {
+        // The text never holds a null character, so 0 stands for "nothing to find".
+        const char amp = (flags & StrPair::NEEDS_ENTITY_PROCESSING) ? '&' : 0;
+        const char cr = (flags & StrPair::NEEDS_NEWLINE_NORMALIZATION) ? CR : 0;
+        const char lf = (flags & StrPair::NEEDS_NEWLINE_NORMALIZATION) ? LF : 0;
+        switch (ActiveScanKernel()) {
+#if defined(TIXML_SCAN_AVX2)
+        case XML_SCAN_AVX2:
+            return FindAnyOfAVX2(p, end, amp, cr, lf);
+#endif
+#if defined(TIXML_SCAN_SSE2)
+        case XML_SCAN_SSE2:
+            return FindAnyOfSSE2(p, end, amp, cr, lf);
+#endif
+        default:
+            return FindAnyOfScalar(p, end, amp, cr, lf);
+        }
+    }
+
+
+    const char* XMLUtil::SkipWhiteSpaceRun(const char* p, int* curLineNumPtr)
+    {
+        TIXMLASSERT(p);
+        switch (ActiveScanKernel()) {
+#if defined(TIXML_SCAN_AVX2)
+        case XML_SCAN_AVX2:
+            return SkipWhiteSpaceAVX2(p, curLineNumPtr);
+#endif
+#if defined(TIXML_SCAN_SSE2)
+        case XML_SCAN_SSE2:
+            return SkipWhiteSpaceSSE2(p, curLineNumPtr);
+#endif
+        default:
+            return SkipWhiteSpaceScalar(p, curLineNumPtr);
+        }
+    }
+
+
+    char* XMLUtil::FindTextStop(char* p, char stopChar, int* curLineNumPtr)
+    {
+        TIXMLASSERT(p);
+        switch (ActiveScanKernel()) {
+#if defined(TIXML_SCAN_AVX2)
+        case XML_SCAN_AVX2:
+            return FindTextStopAVX2(p, stopChar, curLineNumPtr);
+#endif
+#if defined(TIXML_SCAN_SSE2)
+        case XML_SCAN_SSE2:
+            return FindTextStopSSE2(p, stopChar, curLineNumPtr);
+#endif
+        default:
+            return FindTextStopScalar(p, stopChar, curLineNumPtr);
+        }
+    }
+
+
+    XMLScanKernel XMLUtil::ScanKernel()
+    {
+        return ActiveScanKernel();
+    }
+
+
+    XMLScanKernel XMLUtil::SetScanKernel(XMLScanKernel kernel)
+    {
+        const XMLScanKernel best = BestScanKernel();
+        ActiveScanKernel() = (kernel > best) ? best : kernel;
+        return ActiveScanKernel();
+    }
+
+
     StrPair::~StrPair()
     {
         Reset();
@@ -166,17 +569,17 @@ namespace tinyxml2
         TIXMLASSERT(other != 0);
         TIXMLASSERT(other->_flags == 0);
         TIXMLASSERT(other->_start == 0);
-        TIXMLASSERT(other->_end == 0);
+        TIXMLASSERT(other->End() == 0);
 
         other->Reset();
 
         other->_flags = _flags;
         other->_start = _start;
-        other->_end = _end;
+        other->SetEnd(End());
 
         _flags = 0;
         _start = 0;
-        _end = 0;
+        SetEnd(0);
     }
 
 
@@ -187,7 +590,7 @@ namespace tinyxml2
         }
         _flags = 0;
         _start = 0;
-        _end = 0;
+        SetEnd(0);
     }
 
 
@@ -199,7 +602,7 @@ namespace tinyxml2
         TIXMLASSERT(_start == 0);
         _start = new char[len + 1];
         memcpy(_start, str, len + 1);
-        _end = _start + len;
+        SetEnd(_start + len);
         _flags = flags | NEEDS_DELETE;
     }
 
@@ -214,19 +617,19 @@ namespace tinyxml2
         const char  endChar = *endTag;
         size_t length = strlen(endTag);
 
-        // Inner loop of text parsing.
-        while (*p) {
-            if (*p == endChar && strncmp(p, endTag, length) == 0) {
+        // Inner loop of text parsing: the scan kernel jumps from one
+        // candidate end character to the next.
+        for (;;) {
+            p = XMLUtil::FindTextStop(p, endChar, curLineNumPtr);
+            if (!*p) {
+                return 0;
+            }
+            if (strncmp(p, endTag, length) == 0) {
                 Set(start, p, strFlags);
                 return p + length;
             }
-            else if (*p == '\n') {
-                ++(*curLineNumPtr);
-            }
             ++p;
-            TIXMLASSERT(p);
         }
-        return 0;
     }
 
 
@@ -255,7 +658,9 @@ namespace tinyxml2
         // Adjusting _start would cause undefined behavior on delete[]
         TIXMLASSERT((_flags & NEEDS_DELETE) == 0);
         // Trim leading space.
+        char* const end = End();
         _start = XMLUtil::SkipWhiteSpace(_start, 0);
+        SetEnd(end);
 
         if (*_start) {
             const char* p = _start;	// the read pointer
@@ -282,16 +687,28 @@ namespace tinyxml2
     const char* StrPair::GetStr()
     {
         TIXMLASSERT(_start);
-        TIXMLASSERT(_end);
         if (_flags & NEEDS_FLUSH) {
-            *_end = 0;
+            char* const end = End();
+            *end = 0;
             _flags ^= NEEDS_FLUSH;
 
             if (_flags) {
                 const char* p = _start;	// the read pointer
                 char* q = _start;	// the write pointer
 
-                while (p < _end) {
+                while (p < end) {
+                    // Move the run up to the next character to rewrite in one go.
+                    const char* special = FindProcessedChar(p, end, _flags);
+                    if (special != p) {
+                        if (q != p) {
+                            memmove(q, p, special - p);
+                        }
+                        q += special - p;
+                        p = special;
+                        if (p == end) {
+                            break;
+                        }
+                    }
                     if ((_flags & NEEDS_NEWLINE_NORMALIZATION) && *p == CR) {
                         // CR-LF pair becomes LF
                         // CR alone becomes LF
@@ -382,6 +799,84 @@ namespace tinyxml2
 
 
 
+    // --------- XMLArena ----------- //
+
+    XMLArena::XMLArena(void* buffer, size_t size) :
+        _buffer(static_cast<char*>(buffer)),
+        _size(buffer ? size : 0),
+        _used(0),
+        _overflow(0),
+        _overflowBytes(0)
+    {
+    }
+
+
+    XMLArena::~XMLArena()
+    {
+        Reset();
+    }
+
+
+    char* XMLArena::AlignUp(char* p, size_t alignment)
+    {
+        TIXMLASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+        const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        return p + ((alignment - (address & (alignment - 1))) & (alignment - 1));
+    }
+
+
+    void* XMLArena::Allocate(size_t size, size_t alignment)
+    {
+        if (_buffer) {
+            char* const start = AlignUp(_buffer + _used, alignment);
+            if (static_cast<size_t>(start - _buffer) <= _size && size <= _size - static_cast<size_t>(start - _buffer)) {
+                _used = static_cast<size_t>(start - _buffer) + size;
+                return start;
+            }
+        }
+        if (_overflow) {
+            char* const data = reinterpret_cast<char*>(_overflow + 1);
+            char* const start = AlignUp(data + _overflow->used, alignment);
+            if (static_cast<size_t>(start - data) <= _overflow->size && size <= _overflow->size - static_cast<size_t>(start - data)) {
+                _overflow->used = static_cast<size_t>(start - data) + size;
+                return start;
+            }
+        }
+        // Overflow chunks are at least as large as the buffer, so a batch
+        // that outgrows the buffer does not fall back to small allocations.
+        size_t chunkSize = size + alignment;
+        if (chunkSize < _size) {
+            chunkSize = _size;
+        }
+        if (chunkSize < 4 * 1024) {
+            chunkSize = 4 * 1024;
+        }
+        Chunk* const chunk = reinterpret_cast<Chunk*>(new char[sizeof(Chunk) + chunkSize]);
+        chunk->next = _overflow;
+        chunk->size = chunkSize;
+        chunk->used = 0;
+        _overflow = chunk;
+        _overflowBytes += chunkSize;
+
+        char* const data = reinterpret_cast<char*>(chunk + 1);
+        char* const start = AlignUp(data, alignment);
+        chunk->used = static_cast<size_t>(start - data) + size;
+        return start;
+    }
+
+
+    void XMLArena::Reset()
+    {
+        while (_overflow) {
+            Chunk* const next = _overflow->next;
+            delete[] reinterpret_cast<char*>(_overflow);
+            _overflow = next;
+        }
+        _used = 0;
+        _overflowBytes = 0;
+    }
+
+
     // --------- XMLUtil ----------- //
 
     const char* XMLUtil::writeBoolTrue = "true";
@@ -556,14 +1051,88 @@ namespace tinyxml2
         return p + 1;
     }
 
+#if defined(TIXML_CHARCONV)
+    // Writes v with std::to_chars and null terminates it. Fails if the
+    // buffer is too small, in which case the caller falls back to snprintf,
+    // which truncates.
+    template<typename T>
+    static bool ToChars(T v, char* buffer, int bufferSize)
+    {
+        if (bufferSize <= 0) {
+            return false;
+        }
+        const std::to_chars_result result = std::to_chars(buffer, buffer + bufferSize - 1, v);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        *result.ptr = 0;
+        return true;
+    }
+
+    // std::from_chars accepts neither the leading whitespace nor the '+'
+    // sign that sscanf does, so skip them first. Whatever from_chars still
+    // rejects (a '-' on an unsigned value, overflow, hexadecimal floating
+    // point) is left to the sscanf path, so both paths give the same results.
+    static const char* NumberStart(const char* str)
+    {
+        while (XMLUtil::IsWhiteSpace(*str)) {
+            ++str;
+        }
+        if (*str == '+' && str[1] != '+' && str[1] != '-') {
+            ++str;
+        }
+        return str;
+    }
+
+    template<typename T>
+    static bool IntegerFromChars(const char* str, T* value)
+    {
+        const char* first = NumberStart(str);
+        const char* last = first + strlen(first);
+        if (XMLUtil::IsPrefixHex(str)) {
+            // Like "%x", read the bits as unsigned.
+            typename std::make_unsigned<T>::type v;
+            if (std::from_chars(first + 2, last, v, 16).ec != std::errc()) {
+                return false;
+            }
+            *value = static_cast<T>(v);
+            return true;
+        }
+        return std::from_chars(first, last, *value).ec == std::errc();
+    }
+
+    template<typename T>
+    static bool FloatFromChars(const char* str, T* value)
+    {
+        const char* first = NumberStart(str);
+        T v;
+        const std::from_chars_result result = std::from_chars(first, first + strlen(first), v);
+        if (result.ec != std::errc() || *result.ptr == 'x' || *result.ptr == 'X') {
+            return false;
+        }
+        *value = v;
+        return true;
+    }
+#endif
+
     void XMLUtil::ToStr(int v, char* buffer, int bufferSize)
     {
+#if defined(TIXML_CHARCONV)
+        if (ToChars(v, buffer, bufferSize)) {
+            return;
+        }
+#endif
         TIXML_SNPRINTF(buffer, bufferSize, "%d", v);
     }
 
 
     void XMLUtil::ToStr(unsigned v, char* buffer, int bufferSize)
     {
+#if defined(TIXML_CHARCONV)
+        if (ToChars(v, buffer, bufferSize)) {
+            return;
+        }
+#endif
         TIXML_SNPRINTF(buffer, bufferSize, "%u", v);
     }
 
@@ -576,33 +1145,62 @@ namespace tinyxml2
     /*
         ToStr() of a number is a very tricky topic.
         https://github.com/leethomason/tinyxml2/issues/106
+        std::to_chars without a format writes the shortest text that reads
+        back to the same value (0.1 is "0.1", 1e6 is "1e+06"). Without it,
+        "%.8g" and "%.17g" are enough digits to round trip a float and a
+        double, at the cost of longer text such as "0.10000000000000001".
     */
     void XMLUtil::ToStr(float v, char* buffer, int bufferSize)
     {
+#if defined(TIXML_CHARCONV)
+        if (ToChars(v, buffer, bufferSize)) {
+            return;
+        }
+#endif
         TIXML_SNPRINTF(buffer, bufferSize, "%.8g", v);
     }
 
 
     void XMLUtil::ToStr(double v, char* buffer, int bufferSize)
     {
+#if defined(TIXML_CHARCONV)
+        if (ToChars(v, buffer, bufferSize)) {
+            return;
+        }
+#endif
         TIXML_SNPRINTF(buffer, bufferSize, "%.17g", v);
     }
 
 
     void XMLUtil::ToStr(int64_t v, char* buffer, int bufferSize)
     {
+#if defined(TIXML_CHARCONV)
+        if (ToChars(v, buffer, bufferSize)) {
+            return;
+        }
+#endif
         // horrible syntax trick to make the compiler happy about %lld
         TIXML_SNPRINTF(buffer, bufferSize, "%lld", static_cast<long long>(v));
     }
 
     void XMLUtil::ToStr(uint64_t v, char* buffer, int bufferSize)
     {
+#if defined(TIXML_CHARCONV)
+        if (ToChars(v, buffer, bufferSize)) {
+            return;
+        }
+#endif
         // horrible syntax trick to make the compiler happy about %llu
         TIXML_SNPRINTF(buffer, bufferSize, "%llu", static_cast<unsigned long long>(v));
     }
 
     bool XMLUtil::ToInt(const char* str, int* value)
     {
+#if defined(TIXML_CHARCONV)
+        if (IntegerFromChars(str, value)) {
+            return true;
+        }
+#endif
         if (IsPrefixHex(str)) {
             unsigned v;
             if (TIXML_SSCANF(str, "%x", &v) == 1) {
@@ -620,6 +1218,11 @@ namespace tinyxml2
 
     bool XMLUtil::ToUnsigned(const char* str, unsigned* value)
     {
+#if defined(TIXML_CHARCONV)
+        if (IntegerFromChars(str, value)) {
+            return true;
+        }
+#endif
         if (TIXML_SSCANF(str, IsPrefixHex(str) ? "%x" : "%u", value) == 1) {
             return true;
         }
@@ -654,6 +1257,11 @@ namespace tinyxml2
 
     bool XMLUtil::ToFloat(const char* str, float* value)
     {
+#if defined(TIXML_CHARCONV)
+        if (FloatFromChars(str, value)) {
+            return true;
+        }
+#endif
         if (TIXML_SSCANF(str, "%f", value) == 1) {
             return true;
         }
@@ -663,6 +1271,11 @@ namespace tinyxml2
 
     bool XMLUtil::ToDouble(const char* str, double* value)
     {
+#if defined(TIXML_CHARCONV)
+        if (FloatFromChars(str, value)) {
+            return true;
+        }
+#endif
         if (TIXML_SSCANF(str, "%lf", value) == 1) {
             return true;
         }
@@ -672,6 +1285,11 @@ namespace tinyxml2
 
     bool XMLUtil::ToInt64(const char* str, int64_t* value)
     {
+#if defined(TIXML_CHARCONV)
+        if (IntegerFromChars(str, value)) {
+            return true;
+        }
+#endif
         if (IsPrefixHex(str)) {
             unsigned long long v = 0;	// horrible syntax trick to make the compiler happy about %llx
             if (TIXML_SSCANF(str, "%llx", &v) == 1) {
@@ -691,6 +1309,11 @@ namespace tinyxml2
 
 
     bool XMLUtil::ToUnsigned64(const char* str, uint64_t* value) {
+#if defined(TIXML_CHARCONV)
+        if (IntegerFromChars(str, value)) {
+            return true;
+        }
+#endif
         unsigned long long v = 0;	// horrible syntax trick to make the compiler happy about %llu
         if (TIXML_SSCANF(str, IsPrefixHex(str) ? "%llx" : "%llu", &v) == 1) {
             *value = static_cast<uint64_t>(v);
@@ -802,9 +1425,13 @@ namespace tinyxml2
         _value(),
         _parseLineNum(0),
         _firstChild(0), _lastChild(0),
+#if defined(TINYXML2_COMPACT_NODES)
+        _prev(0), _next(0)
+#else
         _prev(0), _next(0),
         _userData(0),
         _memPool(0)
+#endif
     {
     }
 
@@ -861,6 +1488,10 @@ namespace tinyxml2
         else {
             _value.SetStr(str);
         }
+        XMLElement* element = ToElement();
+        if (element) {
+            element->_atom = (str && _document->_internNames) ? _document->InternName(str) : 0;
+        }
     }
 
     XMLNode* XMLNode::DeepClone(XMLDocument* target) const
@@ -1070,6 +1701,54 @@ namespace tinyxml2
     }
 
 
+    const XMLElement* XMLNode::FirstChildElement(XMLAtom atom) const
+    {
+        for (const XMLNode* node = _firstChild; node; node = node->_next) {
+            const XMLElement* element = node->ToElementWithAtom(atom);
+            if (element) {
+                return element;
+            }
+        }
+        return 0;
+    }
+
+
+    const XMLElement* XMLNode::LastChildElement(XMLAtom atom) const
+    {
+        for (const XMLNode* node = _lastChild; node; node = node->_prev) {
+            const XMLElement* element = node->ToElementWithAtom(atom);
+            if (element) {
+                return element;
+            }
+        }
+        return 0;
+    }
+
+
+    const XMLElement* XMLNode::NextSiblingElement(XMLAtom atom) const
+    {
+        for (const XMLNode* node = _next; node; node = node->_next) {
+            const XMLElement* element = node->ToElementWithAtom(atom);
+            if (element) {
+                return element;
+            }
+        }
+        return 0;
+    }
+
+
+    const XMLElement* XMLNode::PreviousSiblingElement(XMLAtom atom) const
+    {
+        for (const XMLNode* node = _prev; node; node = node->_prev) {
+            const XMLElement* element = node->ToElementWithAtom(atom);
+            if (element) {
+                return element;
+            }
+        }
+        return 0;
+    }
+
+
     char* XMLNode::ParseDeep(char* p, StrPair* parentEndTag, int* curLineNumPtr)
     {
         // This is a recursive method, but thinking about it "at the current level"
@@ -1154,7 +1833,7 @@ namespace tinyxml2
                     if (parentEndTag) {
                         ele->_value.TransferTo(parentEndTag);
                     }
-                    node->_memPool->SetTracked();   // created and then immediately deleted.
+                    node->Pool()->SetTracked();   // created and then immediately deleted.
                     DeleteNode(node);
                     return p;
                 }
@@ -1180,12 +1859,32 @@ namespace tinyxml2
                     _document->DeleteNode(node);
                     break;
                 }
+                if (_document->_internNames) {
+                    ele->_atom = _document->InternName(ele->Name());
+                }
             }
             InsertEndChild(node);
         }
         return 0;
     }
 
+    MemPool* XMLNode::Pool() const
+    {
+#if defined(TINYXML2_COMPACT_NODES)
+        // Every node type has its own pool, except comments, declarations
+        // and unknowns, which share one (see XMLDocument::Identify()).
+        if (ToElement()) {
+            return &_document->_elementPool;
+        }
+        if (ToText()) {
+            return &_document->_textPool;
+        }
+        return &_document->_commentPool;
+#else
+        return _memPool;
+#endif
+    }
+
     /*static*/ void XMLNode::DeleteNode(XMLNode* node)
     {
         if (node == 0) {
@@ -1196,7 +1895,7 @@ namespace tinyxml2
             node->_document->MarkInUse(node);
         }
 
-        MemPool* pool = node->_memPool;
+        MemPool* pool = node->Pool();
         node->~XMLNode();
         pool->Free(node);
     }
@@ -1211,7 +1910,7 @@ namespace tinyxml2
         }
         else {
             insertThis->_document->MarkInUse(insertThis);
-            insertThis->_memPool->SetTracked();
+            insertThis->Pool()->SetTracked();
         }
     }
 
@@ -1230,6 +1929,15 @@ namespace tinyxml2
         return 0;
     }
 
+    const XMLElement* XMLNode::ToElementWithAtom(XMLAtom atom) const
+    {
+        const XMLElement* element = this->ToElement();
+        if (element && atom._id != 0 && element->_atom == atom._id) {
+            return element;
+        }
+        return 0;
+    }
+
     // --------- XMLText ---------- //
     char* XMLText::ParseDeep(char* p, StrPair*, int* curLineNumPtr)
     {
@@ -1599,6 +2307,7 @@ namespace tinyxml2
     // --------- XMLElement ---------- //
     XMLElement::XMLElement(XMLDocument* doc) : XMLNode(doc),
         _closingType(OPEN),
+        _atom(0),
         _rootAttribute(0)
     {
     }
@@ -1973,9 +2682,8 @@ namespace tinyxml2
             if (XMLUtil::IsNameStartChar(static_cast<unsigned char>(*p))) {
                 XMLAttribute* attrib = CreateAttribute();
                 TIXMLASSERT(attrib);
-                attrib->_parseLineNum = _document->_parseCurLineNum;
-
-                const int attrLineNum = attrib->_parseLineNum;
+                const int attrLineNum = _document->_parseCurLineNum;
+                attrib->_parseLineNum = attrLineNum;
 
                 p = attrib->ParseDeep(p, _document->ProcessEntities(), curLineNumPtr);
                 if (!p || Attribute(attrib->Name())) {
@@ -2021,9 +2729,8 @@ namespace tinyxml2
         if (attribute == 0) {
             return;
         }
-        MemPool* pool = attribute->_memPool;
         attribute->~XMLAttribute();
-        pool->Free(attribute);
+        _document->_attributePool.Free(attribute);
     }
 
     XMLAttribute* XMLElement::CreateAttribute()
@@ -2031,8 +2738,7 @@ namespace tinyxml2
         TIXMLASSERT(sizeof(XMLAttribute) == _document->_attributePool.ItemSize());
         XMLAttribute* attrib = new (_document->_attributePool.Alloc()) XMLAttribute();
         TIXMLASSERT(attrib);
-        attrib->_memPool = &_document->_attributePool;
-        attrib->_memPool->SetTracked();
+        _document->_attributePool.SetTracked();
         return attrib;
     }
 
@@ -2189,14 +2895,24 @@ namespace tinyxml2
         _whitespaceMode(whitespaceMode),
         _errorStr(),
         _errorLineNum(0),
+        _retainMemory(false),
+        _poolBlockSize(4 * 1024),
+        _arena(0),
         _charBuffer(0),
+        _charBufferCapacity(0),
+        _mappedFile(0),
+        _mappedSize(0),
         _parseCurLineNum(0),
         _parsingDepth(0),
         _unlinked(),
         _elementPool(),
         _attributePool(),
         _textPool(),
-        _commentPool()
+        _commentPool(),
+        _internNames(false),
+        _atomSlots(),
+        _atomEntries(),
+        _atomNames()
     {
         // avoid VC++ C4355 warning about 'this' in initializer list (C4355 is off by default in VS2012+)
         _document = this;
@@ -2205,6 +2921,7 @@ namespace tinyxml2
 
     XMLDocument::~XMLDocument()
     {
+        _retainMemory = false;
         Clear();
     }
 
@@ -2228,31 +2945,182 @@ namespace tinyxml2
         while (_unlinked.Size()) {
             DeleteNode(_unlinked[0]);	// Will remove from _unlinked as part of delete.
         }
+        UnmapFile();
+
+#ifdef TINYXML2_DEBUG
+        const bool hadError = Error();
+#endif
+        ClearError();
+
+        if (_arena) {
+            // Every node is gone, so the blocks and the character buffer
+            // can be handed back to the arena by its owner.
+            _elementPool.Clear();
+            _attributePool.Clear();
+            _textPool.Clear();
+            _commentPool.Clear();
+            _charBuffer = 0;
+            _charBufferCapacity = 0;
+        }
+        else if (!_retainMemory) {
+            delete[] _charBuffer;
+            _charBuffer = 0;
+            _charBufferCapacity = 0;
+        }
+        _parsingDepth = 0;
+
+#if 0
+        _textPool.Trace("text");
+        _elementPool.Trace("element");
+        _commentPool.Trace("comment");
+        _attributePool.Trace("attribute");
+#endif
+
+#ifdef TINYXML2_DEBUG
+        if (!hadError) {
+            TIXMLASSERT(_elementPool.CurrentAllocs() == _elementPool.Untracked());
+            TIXMLASSERT(_attributePool.CurrentAllocs() == _attributePool.Untracked());
+            TIXMLASSERT(_textPool.CurrentAllocs() == _textPool.Untracked());
+            TIXMLASSERT(_commentPool.CurrentAllocs() == _commentPool.Untracked());
+        }
+#endif
+    }
+
+
+    char* XMLDocument::ReserveCharBuffer(size_t size)
+    {
+        if (_charBuffer && _charBufferCapacity >= size) {
+            return _charBuffer;
+        }
+        if (_arena) {
+            _charBuffer = static_cast<char*>(_arena->Allocate(size, 1));
+        }
+        else {
+            delete[] _charBuffer;
+            _charBuffer = new char[size];
+        }
+        _charBufferCapacity = size;
+        return _charBuffer;
+    }
+
+
+    void XMLDocument::ReleaseMemory()
+    {
+        const bool retain = _retainMemory;
+        _retainMemory = false;
+        Clear();
+        _retainMemory = retain;
+        _elementPool.Clear();
+        _attributePool.Clear();
+        _textPool.Clear();
+        _commentPool.Clear();
+    }
+
+
+    void XMLDocument::SetPoolBlockSize(size_t bytes)
+    {
+        ReleaseMemory();
+        _poolBlockSize = bytes;
+        _elementPool.SetBlockSize(bytes);
+        _attributePool.SetBlockSize(bytes);
+        _textPool.SetBlockSize(bytes);
+        _commentPool.SetBlockSize(bytes);
+    }
+
+
+    void XMLDocument::SetArena(XMLArena* arena)
+    {
+        ReleaseMemory();
+        _arena = arena;
+        _elementPool.SetArena(arena);
+        _attributePool.SetArena(arena);
+        _textPool.SetArena(arena);
+        _commentPool.SetArena(arena);
+    }
+
+
+    XMLMemoryStats XMLDocument::MemoryStats() const
+    {
+        XMLMemoryStats stats;
+        stats.elements = _elementPool.Stats();
+        stats.attributes = _attributePool.Stats();
+        stats.texts = _textPool.Stats();
+        stats.comments = _commentPool.Stats();
+        stats.charBufferBytes = _charBufferCapacity;
+        stats.mappedBytes = _mappedSize;
+        stats.totalBytes = stats.elements.bytes + stats.attributes.bytes + stats.texts.bytes
+            + stats.comments.bytes + stats.charBufferBytes;
+        return stats;
+    }
+
+    XMLAtom XMLDocument::Atom(const char* name)
+    {
+        if (!_internNames || !name) {
+            return XMLAtom();
+        }
+        return XMLAtom(InternName(name));
+    }
+
+
+    unsigned XMLDocument::InternName(const char* name)
+    {
+        TIXMLASSERT(name);
+        // FNV-1a
+        unsigned hash = 2166136261u;
+        size_t length = 0;
+        for (; name[length]; ++length) {
+            hash = (hash ^ static_cast<unsigned char>(name[length])) * 16777619u;
+        }
+
+        if (_atomSlots.Empty()) {
+            GrowAtomSlots();
+        }
+        const size_t mask = _atomSlots.Size() - 1;
+        for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+            const unsigned id = _atomSlots[slot];
+            if (id == 0) {
+                break;
+            }
+            const AtomEntry& entry = _atomEntries[id - 1];
+            if (entry.hash == hash && entry.length == length && memcmp(_atomNames.Mem() + entry.offset, name, length) == 0) {
+                return id;
+            }
+        }
 
-#ifdef TINYXML2_DEBUG
-        const bool hadError = Error();
-#endif
-        ClearError();
-
-        delete[] _charBuffer;
-        _charBuffer = 0;
-        _parsingDepth = 0;
+        // Not interned yet: keep the table at most half full.
+        if ((_atomEntries.Size() + 1) * 2 > _atomSlots.Size()) {
+            GrowAtomSlots();
+        }
+        AtomEntry entry = { hash, _atomNames.Size(), length };
+        if (length) {
+            memcpy(_atomNames.PushArr(length), name, length);
+        }
+        _atomEntries.Push(entry);
+        const unsigned id = static_cast<unsigned>(_atomEntries.Size());
+        const size_t newMask = _atomSlots.Size() - 1;
+        size_t slot = hash & newMask;
+        while (_atomSlots[slot] != 0) {
+            slot = (slot + 1) & newMask;
+        }
+        _atomSlots[slot] = id;
+        return id;
+    }
 
-#if 0
-        _textPool.Trace("text");
-        _elementPool.Trace("element");
-        _commentPool.Trace("comment");
-        _attributePool.Trace("attribute");
-#endif
 
-#ifdef TINYXML2_DEBUG
-        if (!hadError) {
-            TIXMLASSERT(_elementPool.CurrentAllocs() == _elementPool.Untracked());
-            TIXMLASSERT(_attributePool.CurrentAllocs() == _attributePool.Untracked());
-            TIXMLASSERT(_textPool.CurrentAllocs() == _textPool.Untracked());
-            TIXMLASSERT(_commentPool.CurrentAllocs() == _commentPool.Untracked());
+    void XMLDocument::GrowAtomSlots()
+    {
+        const size_t size = _atomSlots.Empty() ? 64 : _atomSlots.Size() * 2;
+        _atomSlots.Clear();
+        unsigned* slots = _atomSlots.PushArr(size);
+        memset(slots, 0, size * sizeof(unsigned));
+        const size_t mask = size - 1;
+        for (size_t i = 0; i < _atomEntries.Size(); ++i) {
+            size_t slot = _atomEntries[i].hash & mask;
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = static_cast<unsigned>(i + 1);
         }
-#endif
     }
 
 
@@ -2335,7 +3203,7 @@ namespace tinyxml2
             // Use the parent delete.
             // Also, we need to mark it tracked: we 'know'
             // it was never used.
-            node->_memPool->SetTracked();
+            node->Pool()->SetTracked();
             // Call the static XMLNode version:
             XMLNode::DeleteNode(node);
         }
@@ -2400,8 +3268,12 @@ namespace tinyxml2
         }
 
         const size_t size = static_cast<size_t>(filelength);
-        TIXMLASSERT(_charBuffer == 0);
-        _charBuffer = new char[size + 1];
+        if (size >= TINYXML2_MMAP_THRESHOLD && MapFile(fp, size)) {
+            TIXMLASSERT(_mappedFile[size] == 0);
+            ParseBuffer(_mappedFile);
+            return _errorID;
+        }
+        ReserveCharBuffer(size + 1);
         const size_t read = fread(_charBuffer, 1, size, fp);
         if (read != size) {
             SetError(XML_ERROR_FILE_READ_ERROR, 0, 0);
@@ -2410,11 +3282,143 @@ namespace tinyxml2
 
         _charBuffer[size] = 0;
 
-        Parse();
+        ParseBuffer(_charBuffer);
         return _errorID;
     }
 
 
+    bool XMLDocument::MapFile(FILE* fp, size_t size)
+    {
+        TIXMLASSERT(!_mappedFile);
+#if defined(TIXML_MMAP_POSIX)
+        // Reserve one byte more than the file and map the file over the start
+        // of the reservation: the null terminator then lands in zero filled
+        // memory whether or not the file ends on a page boundary. The mapping
+        // is private, so parsing in place never writes to the file.
+        const size_t length = size + 1;
+        void* base = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fileno(fp), 0) == MAP_FAILED) {
+            munmap(base, length);
+            return false;
+        }
+#   if defined(MADV_SEQUENTIAL)
+        madvise(base, size, MADV_SEQUENTIAL);
+#   endif
+        _mappedFile = static_cast<char*>(base);
+        _mappedSize = length;
+        return true;
+#elif defined(TIXML_MMAP_WIN32)
+        // A view cannot extend past the end of the file; the null terminator
+        // goes in the zero filled tail of the last page, so the file must not
+        // end on a page boundary.
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        if (size % info.dwPageSize == 0) {
+            return false;
+        }
+        HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+        if (!mapping) {
+            return false;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, size);
+        CloseHandle(mapping);	// the view keeps the mapping alive
+        if (!view) {
+            return false;
+        }
+        _mappedFile = static_cast<char*>(view);
+        _mappedSize = size;
+        return true;
+#else
+        (void)fp;
+        (void)size;
+        return false;
+#endif
+    }
+
+
+    void XMLDocument::UnmapFile()
+    {
+        if (!_mappedFile) {
+            return;
+        }
+#if defined(TIXML_MMAP_POSIX)
+        munmap(_mappedFile, _mappedSize);
+#elif defined(TIXML_MMAP_WIN32)
+        UnmapViewOfFile(_mappedFile);
+#endif
+        _mappedFile = 0;
+        _mappedSize = 0;
+    }
+
+
+    // Writes a buffer to a file in chunks of TINYXML2_WRITE_CHUNK_SIZE bytes.
+    static void WriteChunks(FILE* fp, const char* data, size_t size)
+    {
+#if defined(TIXML_WRITEV)
+        // Hand the kernel a batch of chunks per call, bypassing stdio.
+        static const int BATCH = 16;
+        fflush(fp);
+        const int fd = fileno(fp);
+        while (size > 0) {
+            struct iovec chunks[BATCH];
+            int count = 0;
+            for (size_t queued = 0; count < BATCH && queued < size; ++count) {
+                const size_t chunk = (size - queued < TINYXML2_WRITE_CHUNK_SIZE) ? size - queued : TINYXML2_WRITE_CHUNK_SIZE;
+                chunks[count].iov_base = const_cast<char*>(data + queued);
+                chunks[count].iov_len = chunk;
+                queued += chunk;
+            }
+            const ssize_t written = writev(fd, chunks, count);
+            if (written <= 0) {
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+#else
+        // Large fwrite calls go straight to the file instead of through the
+        // stdio buffer; stdio still applies the text mode translation.
+        while (size > 0) {
+            const size_t chunk = (size < TINYXML2_WRITE_CHUNK_SIZE) ? size : TINYXML2_WRITE_CHUNK_SIZE;
+            if (fwrite(data, 1, chunk, fp) != chunk) {
+                return;
+            }
+            data += chunk;
+            size -= chunk;
+        }
+#endif
+    }
+
+
+    void XMLBufferSink::Write(const char* data, size_t size)
+    {
+        if (size > _capacity - _size) {
+            size = _capacity - _size;
+            _overflowed = true;
+        }
+        if (size > 0) {
+            memcpy(_buffer + _size, data, size);
+            _size += size;
+        }
+    }
+
+
+    void XMLFileSink::Write(const char* data, size_t size)
+    {
+        WriteChunks(_fp, data, size);
+    }
+
+
     XMLError XMLDocument::SaveFile(const char* filename, bool compact)
     {
         if (!filename) {
@@ -2439,8 +3443,10 @@ namespace tinyxml2
         // Clear any error from the last save, otherwise it will get reported
         // for *this* call.
         ClearError();
-        XMLPrinter stream(fp, compact);
+        XMLFileSink sink(fp);
+        XMLPrinter stream(sink, compact, 0, TINYXML2_WRITE_CHUNK_SIZE);
         Print(&stream);
+        stream.Flush();
         return _errorID;
     }
 
@@ -2456,23 +3462,57 @@ namespace tinyxml2
         if (nBytes == static_cast<size_t>(-1)) {
             nBytes = strlen(xml);
         }
-        TIXMLASSERT(_charBuffer == 0);
-        _charBuffer = new char[nBytes + 1];
+        ReserveCharBuffer(nBytes + 1);
         memcpy(_charBuffer, xml, nBytes);
         _charBuffer[nBytes] = 0;
 
-        Parse();
+        ParseBuffer(_charBuffer);
+        if (Error()) {
+            DeleteParsedNodes();
+        }
+        return _errorID;
+    }
+
+
+    XMLError XMLDocument::ParseInSitu(char* xml, size_t nBytes)
+    {
+        Clear();
+
+        if (nBytes == 0 || !xml || !*xml) {
+            SetError(XML_ERROR_EMPTY_DOCUMENT, 0, 0);
+            return _errorID;
+        }
+        if (nBytes != static_cast<size_t>(-1)) {
+            xml[nBytes] = 0;
+        }
+
+        ParseBuffer(xml);
         if (Error()) {
-            // clean up now essentially dangling memory.
-            // and the parse fail can put objects in the
-            // pools that are dead and inaccessible.
-            DeleteChildren();
+            DeleteParsedNodes();
+        }
+        return _errorID;
+    }
+
+
+    void XMLDocument::DeleteParsedNodes()
+    {
+        // clean up now essentially dangling memory.
+        // and the parse fail can put objects in the
+        // pools that are dead and inaccessible.
+        DeleteChildren();
+        if (_retainMemory) {
+            _unlinked.Clear();
+            _elementPool.Reset();
+            _attributePool.Reset();
+            _textPool.Reset();
+            _commentPool.Reset();
+        }
+        else {
             _elementPool.Clear();
             _attributePool.Clear();
             _textPool.Clear();
             _commentPool.Clear();
         }
-        return _errorID;
     }
 
 
@@ -2548,13 +3588,12 @@ namespace tinyxml2
         return ErrorIDToName(_errorID);
     }
 
-    void XMLDocument::Parse()
+    void XMLDocument::ParseBuffer(char* p)
     {
         TIXMLASSERT(NoChildren()); // Clear() must have been called previously
-        TIXMLASSERT(_charBuffer);
+        TIXMLASSERT(p);
         _parseCurLineNum = 1;
         _parseLineNum = 1;
-        char* p = _charBuffer;
         p = XMLUtil::SkipWhiteSpace(p, &_parseCurLineNum);
         p = const_cast<char*>(XMLUtil::ReadBOM(p, &_writeBOM));
         if (!*p) {
@@ -2583,6 +3622,8 @@ namespace tinyxml2
         _stack(),
         _firstElement(true),
         _fp(file),
+        _sink(0),
+        _chunkSize(0),
         _depth(depth),
         _textDepth(-1),
         _processEntities(true),
@@ -2606,6 +3647,31 @@ namespace tinyxml2
     }
 
 
+    XMLPrinter::XMLPrinter(XMLSink& sink, bool compact, int depth, size_t chunkSize) :
+        XMLPrinter(static_cast<FILE*>(0), compact, depth)
+    {
+        _sink = &sink;
+        _chunkSize = chunkSize;
+        _buffer.Reserve(chunkSize + 1);
+    }
+
+
+    XMLPrinter::~XMLPrinter()
+    {
+        Flush();
+    }
+
+
+    void XMLPrinter::Flush()
+    {
+        if (_sink && _buffer.Size() > 1) {
+            _sink->Write(_buffer.Mem(), _buffer.Size() - 1);
+            _buffer.Clear();
+            _buffer.Push(0);
+        }
+    }
+
+
     void XMLPrinter::Print(const char* format, ...)
     {
         va_list     va;
@@ -2623,6 +3689,9 @@ namespace tinyxml2
             TIXMLASSERT(_buffer.Size() > 0 && _buffer[_buffer.Size() - 1] == 0);
             char* p = _buffer.PushArr(len) - 1;	// back up over the null terminator.
             TIXML_VSNPRINTF(p, len + 1, format, va);
+            if (_sink && _buffer.Size() - 1 >= _chunkSize) {
+                Flush();
+            }
         }
         va_end(va);
     }
@@ -2634,6 +3703,17 @@ namespace tinyxml2
             fwrite(data, sizeof(char), size, _fp);
         }
         else {
+            if (_sink) {
+                // Keep the staged output within one chunk: hand it over
+                // before it would overflow, and pass large pieces through.
+                if (_buffer.Size() - 1 + size > _chunkSize) {
+                    Flush();
+                }
+                if (size >= _chunkSize) {
+                    _sink->Write(data, size);
+                    return;
+                }
+            }
             char* p = _buffer.PushArr(static_cast<int>(size)) - 1;   // back up over the null terminator.
             memcpy(p, data, size);
             p[size] = 0;
@@ -2646,6 +3726,9 @@ namespace tinyxml2
         if (_fp) {
             fputc(ch, _fp);
         }
+        else if (_sink) {
+            Write(&ch, 1);
+        }
         else {
             char* p = _buffer.PushArr(sizeof(char)) - 1;   // back up over the null terminator.
             p[0] = ch;
@@ -3018,4 +4101,421 @@ namespace tinyxml2
         return true;
     }
 
+
+    // --------- XMLReader ----------- //
+
+    XMLReader::XMLReader(FILE* fp, bool processEntities, size_t chunkSize) :
+        _fp(fp),
+        _memory(0),
+        _memoryLeft(0)
+    {
+        Init(processEntities, chunkSize);
+    }
+
+
+    XMLReader::XMLReader(const char* xml, size_t nBytes, bool processEntities, size_t chunkSize) :
+        _fp(0),
+        _memory(xml),
+        _memoryLeft(0)
+    {
+        if (xml) {
+            _memoryLeft = (nBytes == static_cast<size_t>(-1)) ? strlen(xml) : nBytes;
+        }
+        Init(processEntities, chunkSize);
+    }
+
+
+    void XMLReader::Init(bool processEntities, size_t chunkSize)
+    {
+        // The buffer must at least hold the longest token header, "<![CDATA[".
+        static const size_t minCapacity = 16;
+
+        _eof = false;
+        _atStart = true;
+        _processEntities = processEntities;
+        _capacity = (chunkSize > minCapacity) ? chunkSize : minCapacity;
+        _buffer = new char[_capacity + 1];
+        _buffer[0] = 0;
+        _size = 0;
+        _pos = 0;
+        _event = XML_READ_NONE;
+        _errorID = XML_SUCCESS;
+        _nameStr = 0;
+        _textStr = 0;
+        _cdata = false;
+        _pendingEnd = false;
+        _restoreTag = false;
+        _sawElement = false;
+        _sawNode = false;
+        _depth = 0;
+        _lineNum = 1;
+        _eventLineNum = 0;
+    }
+
+
+    XMLReader::~XMLReader()
+    {
+        delete[] _buffer;
+    }
+
+
+    XMLReadEvent XMLReader::Next()
+    {
+        if (_event == XML_READ_END_DOCUMENT || _event == XML_READ_ERROR) {
+            return _event;
+        }
+        if (_restoreTag) {
+            // The text of the last event was terminated on the '<' of the next token.
+            _buffer[_pos] = '<';
+            _restoreTag = false;
+        }
+        _attributes.Clear();
+        if (_pendingEnd) {
+            // Second event of an empty element; the name is still in the buffer.
+            _pendingEnd = false;
+            _event = XML_READ_END_ELEMENT;
+            return _event;
+        }
+
+        for (;;) {
+            switch (ReadToken()) {
+            case TOKEN_READ:
+            case TOKEN_FAILED:
+                return _event;
+            case TOKEN_INCOMPLETE:
+                if (!Fill()) {
+                    return _event;
+                }
+                break;
+            case TOKEN_END:
+                if (!_openNameStarts.Empty()) {
+                    Fail(XML_ERROR_PARSING_ELEMENT);
+                }
+                else if (!_sawElement) {
+                    Fail(XML_ERROR_EMPTY_DOCUMENT);
+                }
+                else {
+                    _event = XML_READ_END_DOCUMENT;
+                    _depth = 0;
+                }
+                return _event;
+            case TOKEN_SKIPPED:
+                break;
+            }
+        }
+    }
+
+
+    bool XMLReader::Fill()
+    {
+        TIXMLASSERT(!_eof);
+        if (_pos > 0) {
+            memmove(_buffer, _buffer + _pos, _size - _pos);
+            _size -= _pos;
+            _pos = 0;
+        }
+        if (_size == _capacity) {
+            // A single token fills the buffer.
+            char* larger = new char[2 * _capacity + 1];
+            memcpy(larger, _buffer, _size);
+            delete[] _buffer;
+            _buffer = larger;
+            _capacity *= 2;
+        }
+
+        const size_t wanted = _capacity - _size;
+        size_t read = 0;
+        if (_fp) {
+            read = fread(_buffer + _size, 1, wanted, _fp);
+            if (read < wanted) {
+                if (ferror(_fp)) {
+                    Fail(XML_ERROR_FILE_READ_ERROR);
+                    return false;
+                }
+                _eof = true;
+            }
+        }
+        else {
+            read = (_memoryLeft < wanted) ? _memoryLeft : wanted;
+            if (read > 0) {
+                memcpy(_buffer + _size, _memory, read);
+            }
+            _memory += read;
+            _memoryLeft -= read;
+            _eof = (_memoryLeft == 0);
+        }
+        _size += read;
+        _buffer[_size] = 0;
+        return true;
+    }
+
+
+    XMLReader::TokenResult XMLReader::ReadToken()
+    {
+        if (_atStart) {
+            if (_size < 3 && !_eof) {
+                return TOKEN_INCOMPLETE;
+            }
+            bool hasBOM = false;
+            _pos = XMLUtil::ReadBOM(_buffer, &hasBOM) - _buffer;
+            _atStart = false;
+        }
+
+        char* const start = _buffer + _pos;
+        char* const end = _buffer + _size;
+        int lineNum = _lineNum;
+        char* p = XMLUtil::SkipWhiteSpace(start, &lineNum);
+        _eventLineNum = lineNum;
+        if (p == end) {
+            if (!_eof) {
+                return TOKEN_INCOMPLETE;
+            }
+            Consume(p, lineNum);
+            return TOKEN_END;
+        }
+        if (*p != '<') {
+            // Text keeps its leading whitespace, as in XMLDocument.
+            _sawNode = true;
+            lineNum = _lineNum;
+            return ReadText(start, false, &lineNum);
+        }
+
+        // The longest header to identify is "<![CDATA[".
+        static const size_t cdataHeaderLen = 9;
+        if (static_cast<size_t>(end - p) < cdataHeaderLen && !_eof) {
+            return TOKEN_INCOMPLETE;
+        }
+        if (XMLUtil::StringEqual(p, "<?", 2)) {
+            // As in XMLDocument, declarations must come before anything else.
+            if (_sawNode) {
+                return Fail(XML_ERROR_PARSING_DECLARATION);
+            }
+            return ReadSkipped(p + 2, "?>", XML_ERROR_PARSING_DECLARATION, &lineNum);
+        }
+        _sawNode = true;
+        if (XMLUtil::StringEqual(p, "<!--", 4)) {
+            return ReadSkipped(p + 4, "-->", XML_ERROR_PARSING_COMMENT, &lineNum);
+        }
+        if (XMLUtil::StringEqual(p, "<![CDATA[", cdataHeaderLen)) {
+            return ReadText(p + cdataHeaderLen, true, &lineNum);
+        }
+        if (XMLUtil::StringEqual(p, "<!", 2)) {
+            return ReadSkipped(p + 2, ">", XML_ERROR_PARSING_UNKNOWN, &lineNum);
+        }
+        return ReadElement(p + 1, &lineNum);
+    }
+
+
+    XMLReader::TokenResult XMLReader::ReadSkipped(char* p, const char* endTag, XMLError error, int* lineNum)
+    {
+        StrPair value;
+        p = value.ParseText(p, endTag, StrPair::COMMENT, lineNum);
+        if (!p) {
+            return Incomplete(error);
+        }
+        Consume(p, *lineNum);
+        return TOKEN_SKIPPED;
+    }
+
+
+    XMLReader::TokenResult XMLReader::ReadText(char* p, bool cdata, int* lineNum)
+    {
+        StrPair text;
+        if (cdata) {
+            p = text.ParseText(p, "]]>", StrPair::NEEDS_NEWLINE_NORMALIZATION, lineNum);
+            if (!p) {
+                return Incomplete(XML_ERROR_PARSING_CDATA);
+            }
+        }
+        else {
+            const int flags = _processEntities ? StrPair::TEXT_ELEMENT : StrPair::TEXT_ELEMENT_LEAVE_ENTITIES;
+            p = text.ParseText(p, "<", flags, lineNum);
+            if (!p) {
+                return Incomplete(XML_ERROR_PARSING_TEXT);
+            }
+            // Leave the '<' to the next token.
+            --p;
+            _restoreTag = true;
+        }
+        Consume(p, *lineNum);
+        _textStr = text.GetStr();
+        _cdata = cdata;
+        _depth = static_cast<int>(_openNameStarts.Size());
+        _event = XML_READ_TEXT;
+        return TOKEN_READ;
+    }
+
+
+    XMLReader::TokenResult XMLReader::ReadElement(char* p, int* lineNum)
+    {
+        char* const end = _buffer + _size;
+        StrPair name;
+
+        if (*p == '/') {
+            char* q = name.ParseName(p + 1);
+            if (!q) {
+                return (p + 1 == end) ? Incomplete(XML_ERROR_PARSING_ELEMENT) : Fail(XML_ERROR_PARSING_ELEMENT);
+            }
+            p = XMLUtil::SkipWhiteSpace(q, lineNum);
+            if (p == end) {
+                return Incomplete(XML_ERROR_PARSING_ELEMENT);
+            }
+            if (*p != '>') {
+                return Fail(XML_ERROR_PARSING_ELEMENT);
+            }
+            Consume(p + 1, *lineNum);
+            _nameStr = name.GetStr();
+            if (_openNameStarts.Empty() || !XMLUtil::StringEqual(&_openNames[_openNameStarts.PeekTop()], _nameStr)) {
+                return Fail(XML_ERROR_MISMATCHED_ELEMENT);
+            }
+            PopOpenName();
+            _depth = static_cast<int>(_openNameStarts.Size());
+            _event = XML_READ_END_ELEMENT;
+            return TOKEN_READ;
+        }
+
+        char* q = name.ParseName(p);
+        if (!q) {
+            return (p == end) ? Incomplete(XML_ERROR_PARSING_ELEMENT) : Fail(XML_ERROR_PARSING_ELEMENT);
+        }
+        p = q;
+
+        // Find the extent of every attribute first: the strings are only
+        // processed (and terminated in the buffer) once the whole tag is read.
+        const int valueFlags = _processEntities ? StrPair::ATTRIBUTE_VALUE : StrPair::ATTRIBUTE_VALUE_LEAVE_ENTITIES;
+        bool empty = false;
+        _attributeRanges.Clear();
+        for (;;) {
+            p = XMLUtil::SkipWhiteSpace(p, lineNum);
+            if (p == end) {
+                return Incomplete(XML_ERROR_PARSING_ELEMENT);
+            }
+            if (*p == '>') {
+                ++p;
+                break;
+            }
+            if (*p == '/') {
+                if (p + 1 == end) {
+                    return Incomplete(XML_ERROR_PARSING_ELEMENT);
+                }
+                if (*(p + 1) != '>') {
+                    return Fail(XML_ERROR_PARSING_ELEMENT);
+                }
+                p += 2;
+                empty = true;
+                break;
+            }
+            if (!XMLUtil::IsNameStartChar(static_cast<unsigned char>(*p))) {
+                return Fail(XML_ERROR_PARSING_ELEMENT);
+            }
+
+            StrPair attributeName;
+            char* const nameStart = p;
+            char* const nameEnd = attributeName.ParseName(p);
+            p = XMLUtil::SkipWhiteSpace(nameEnd, lineNum);
+            if (p == end) {
+                return Incomplete(XML_ERROR_PARSING_ATTRIBUTE);
+            }
+            if (*p != '=') {
+                return Fail(XML_ERROR_PARSING_ATTRIBUTE);
+            }
+            p = XMLUtil::SkipWhiteSpace(p + 1, lineNum);
+            if (p == end) {
+                return Incomplete(XML_ERROR_PARSING_ATTRIBUTE);
+            }
+            if (*p != SINGLE_QUOTE && *p != DOUBLE_QUOTE) {
+                return Fail(XML_ERROR_PARSING_ATTRIBUTE);
+            }
+            const char endTag[2] = { *p, 0 };
+            StrPair value;
+            char* const valueStart = p + 1;
+            p = value.ParseText(valueStart, endTag, valueFlags, lineNum);
+            if (!p) {
+                return Incomplete(XML_ERROR_PARSING_ATTRIBUTE);
+            }
+            _attributeRanges.Push(nameStart);
+            _attributeRanges.Push(nameEnd);
+            _attributeRanges.Push(valueStart);
+            _attributeRanges.Push(p - 1);
+        }
+
+        const size_t depth = _openNameStarts.Size();
+        if (depth + 1 >= static_cast<size_t>(TINYXML2_MAX_ELEMENT_DEPTH)) {
+            return Fail(XML_ELEMENT_DEPTH_EXCEEDED);
+        }
+        Consume(p, *lineNum);
+        _nameStr = name.GetStr();
+        for (size_t i = 0; i < _attributeRanges.Size(); i += 4) {
+            StrPair attributeName;
+            StrPair value;
+            attributeName.Set(_attributeRanges[i], _attributeRanges[i + 1], 0);
+            value.Set(_attributeRanges[i + 2], _attributeRanges[i + 3], valueFlags);
+            const char* attributeStr = attributeName.GetStr();
+            // Like XMLDocument, reject an element that repeats an attribute.
+            if (Attribute(attributeStr)) {
+                return Fail(XML_ERROR_PARSING_ATTRIBUTE);
+            }
+            _attributes.Push(attributeStr);
+            _attributes.Push(value.GetStr());
+        }
+        if (empty) {
+            _pendingEnd = true;
+        }
+        else {
+            PushOpenName(_nameStr);
+        }
+        _sawElement = true;
+        _depth = static_cast<int>(depth);
+        _event = XML_READ_START_ELEMENT;
+        return TOKEN_READ;
+    }
+
+
+    XMLReader::TokenResult XMLReader::Incomplete(XMLError error)
+    {
+        // A token cut by the end of the buffer is only an error at the end of the input.
+        return _eof ? Fail(error) : TOKEN_INCOMPLETE;
+    }
+
+
+    XMLReader::TokenResult XMLReader::Fail(XMLError error)
+    {
+        _errorID = error;
+        _event = XML_READ_ERROR;
+        return TOKEN_FAILED;
+    }
+
+
+    void XMLReader::Consume(char* p, int lineNum)
+    {
+        TIXMLASSERT(p >= _buffer + _pos && p <= _buffer + _size);
+        _pos = p - _buffer;
+        _lineNum = lineNum;
+    }
+
+
+    const char* XMLReader::Attribute(const char* name) const
+    {
+        for (size_t i = 0; i < _attributes.Size(); i += 2) {
+            if (XMLUtil::StringEqual(_attributes[i], name)) {
+                return _attributes[i + 1];
+            }
+        }
+        return 0;
+    }
+
+
+    void XMLReader::PushOpenName(const char* name)
+    {
+        const size_t length = strlen(name) + 1;
+        _openNameStarts.Push(_openNames.Size());
+        memcpy(_openNames.PushArr(length), name, length);
+    }
+
+
+    void XMLReader::PopOpenName()
+    {
+        _openNames.PopArr(_openNames.Size() - _openNameStarts.Pop());
+    }
+
 }   // namespace tinyxml2
\ No newline at end of file
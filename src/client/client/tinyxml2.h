@@ -112,6 +112,34 @@ static const int TIXML2_PATCH_VERSION = 0;
 // so there needs to be a limit in place.
 static const int TINYXML2_MAX_ELEMENT_DEPTH = 500;
 
+// Number of bytes XMLReader reads from its input at a time.
+static const size_t TINYXML2_READER_CHUNK_SIZE = 64 * 1024;
+
+// Files at least this large are memory mapped by XMLDocument::LoadFile()
+// instead of being read into the character buffer. Define TINYXML2_NO_MMAP
+// to always read them.
+static const size_t TINYXML2_MMAP_THRESHOLD = 256 * 1024;
+
+// Number of bytes XMLDocument::SaveFile() hands to the operating system
+// per write.
+static const size_t TINYXML2_WRITE_CHUNK_SIZE = 1024 * 1024;
+
+// Number of bytes an XMLPrinter printing to an XMLSink stages before
+// handing them to the sink.
+static const size_t TINYXML2_PRINTER_CHUNK_SIZE = 4 * 1024;
+
+// Define TINYXML2_COMPACT_NODES to build the DOM with a smaller node layout,
+// meant for 64-bit builds that load large documents. Nodes still link to
+// each other through pointers, so the saving is modest: on x64 an element
+// shrinks from 120 to 96 bytes, a text node from 112 to 88 and an attribute
+// from 72 to 56, which takes about 18% off the DOM of a game archive. The
+// option changes the public API and is off by default:
+// - strings store a 32-bit length instead of an end pointer, so a single
+//   name, value or text is limited to 4 GB;
+// - nodes do not store the pool they were allocated from;
+// - nodes do not carry user data, and SetUserData()/GetUserData() are not
+//   available.
+
 namespace tinyxml2
 {
     class XMLDocument;
@@ -147,7 +175,11 @@ namespace tinyxml2
             COMMENT = NEEDS_NEWLINE_NORMALIZATION
         };
 
+#if defined(TINYXML2_COMPACT_NODES)
+        StrPair() : _start(0), _length(0), _flags(0) {}
+#else
         StrPair() : _flags(0), _start(0), _end(0) {}
+#endif
         ~StrPair();
 
         void Set(char* start, char* end, int flags) {
@@ -155,19 +187,20 @@ namespace tinyxml2
             TIXMLASSERT(end);
             Reset();
             _start = start;
-            _end = end;
+            SetEnd(end);
             _flags = flags | NEEDS_FLUSH;
         }
 
         const char* GetStr();
 
         bool Empty() const {
-            return _start == _end;
+            return _start == End();
         }
 
         void SetInternedStr(const char* str) {
             Reset();
             _start = const_cast<char*>(str);
+            SetEnd(_start + strlen(str));
         }
 
         void SetStr(const char* str, int flags = 0);
@@ -186,9 +219,24 @@ namespace tinyxml2
             NEEDS_DELETE = 0x200
         };
 
+#if defined(TINYXML2_COMPACT_NODES)
+        char* End() const { return _start + _length; }
+        void SetEnd(char* end) {
+            TIXMLASSERT(static_cast<size_t>(end - _start) <= 0xffffffffU);
+            _length = static_cast<uint32_t>(end - _start);
+        }
+
+        char* _start;
+        uint32_t _length;
+        int     _flags;
+#else
+        char* End() const { return _end; }
+        void SetEnd(char* end) { _end = end; }
+
         int     _flags;
         char* _start;
         char* _end;
+#endif
 
         StrPair(const StrPair& other);	// not supported
         void operator=(const StrPair& other);	// not supported, use TransferTo()
@@ -247,6 +295,12 @@ namespace tinyxml2
             _size -= count;
         }
 
+        void Reserve(size_t cap) {
+            if (cap > 0) {
+                EnsureCapacity(cap);
+            }
+        }
+
         bool Empty() const {
             return _size == 0;
         }
@@ -320,6 +374,71 @@ namespace tinyxml2
     };
 
 
+    /**
+        A monotonic arena. Memory is handed out by bumping a pointer through a
+        caller-supplied buffer and is only given back all at once by Reset().
+        Requests that do not fit in the buffer are served from overflow chunks
+        on the heap, which Reset() and the destructor free.
+
+        An arena is not thread safe; see XMLDocument::SetArena().
+    */
+    class TINYXML2_LIB XMLArena
+    {
+    public:
+        /// Creates an arena over the buffer, which must outlive the arena. The buffer may be null.
+        XMLArena(void* buffer, size_t size);
+        ~XMLArena();
+
+        /// Returns size bytes aligned to alignment, which must be a power of two.
+        void* Allocate(size_t size, size_t alignment);
+        /// Gives back every allocation and frees the overflow chunks.
+        void Reset();
+
+        /// Bytes of the buffer in use, including alignment padding.
+        size_t Used() const {
+            return _used;
+        }
+        /// Size of the buffer.
+        size_t Capacity() const {
+            return _size;
+        }
+        /// Bytes held by the overflow chunks.
+        size_t OverflowBytes() const {
+            return _overflowBytes;
+        }
+
+    private:
+        XMLArena(const XMLArena&);	// not supported
+        void operator=(const XMLArena&);	// not supported
+
+        struct Chunk {
+            Chunk* next;
+            size_t size;
+            size_t used;
+        };
+        static char* AlignUp(char* p, size_t alignment);
+
+        char* _buffer;
+        size_t _size;
+        size_t _used;
+        Chunk* _overflow;
+        size_t _overflowBytes;
+    };
+
+
+    /// Allocation statistics of one memory pool. See XMLDocument::MemoryStats().
+    struct XMLPoolStats
+    {
+        size_t itemSize;        ///< Bytes per item.
+        size_t currentAllocs;   ///< Items in use.
+        size_t totalAllocs;     ///< Items allocated since the pool was created or released.
+        size_t maxAllocs;       ///< Most items in use at once (the watermark).
+        size_t untracked;       ///< Items allocated but not yet linked into the document.
+        size_t blocks;          ///< Blocks held by the pool.
+        size_t bytes;           ///< Bytes held by the blocks.
+    };
+
+
     /*
         Parent virtual class of a pool for fast allocation
         and deallocation of objects.
@@ -344,16 +463,18 @@ namespace tinyxml2
     class MemPoolT : public MemPool
     {
     public:
-        MemPoolT() : _blockPtrs(), _root(0), _currentAllocs(0), _nAllocs(0), _maxAllocs(0), _nUntracked(0) {}
+        MemPoolT() : _blockPtrs(), _root(0), _itemsPerBlock(ITEMS_PER_BLOCK), _arena(0), _currentAllocs(0), _nAllocs(0), _maxAllocs(0), _nUntracked(0) {}
         ~MemPoolT() {
             MemPoolT< ITEM_SIZE >::Clear();
         }
 
         void Clear() {
-            // Delete the blocks.
+            // Delete the blocks. Blocks of an arena are given back by the arena.
             while (!_blockPtrs.Empty()) {
-                Block* lastBlock = _blockPtrs.Pop();
-                delete lastBlock;
+                Item* lastBlock = _blockPtrs.Pop();
+                if (!_arena) {
+                    delete[] lastBlock;
+                }
             }
             _root = 0;
             _currentAllocs = 0;
@@ -369,17 +490,63 @@ namespace tinyxml2
             return _currentAllocs;
         }
 
+        /**
+            Sets the size in bytes of the blocks items are allocated from,
+            rounded down to a whole number of items (at least one). Releases
+            every block first, so any item still in use becomes invalid.
+        */
+        void SetBlockSize(size_t bytes) {
+            Clear();
+            _itemsPerBlock = bytes / sizeof(Item);
+            if (_itemsPerBlock == 0) {
+                _itemsPerBlock = 1;
+            }
+        }
+        size_t BlockSize() const {
+            return _itemsPerBlock * sizeof(Item);
+        }
+
+        /**
+            Allocates the blocks from the arena instead of the heap, or from
+            the heap again if arena is null. Releases every block first, so
+            any item still in use becomes invalid.
+        */
+        void SetArena(XMLArena* arena) {
+            Clear();
+            _arena = arena;
+        }
+
+        /**
+            Returns every item to the free list but keeps the blocks, so the
+            pool can be refilled without allocating. Any item still in use
+            becomes invalid.
+        */
+        void Reset() {
+            _root = 0;
+            for (size_t i = _blockPtrs.Size(); i > 0; --i) {
+                Item* blockItems = _blockPtrs[i - 1];
+                for (size_t j = 0; j < _itemsPerBlock - 1; ++j) {
+                    blockItems[j].next = &(blockItems[j + 1]);
+                }
+                blockItems[_itemsPerBlock - 1].next = _root;
+                _root = blockItems;
+            }
+            _currentAllocs = 0;
+            _nUntracked = 0;
+        }
+
         virtual void* Alloc() override {
             if (!_root) {
                 // Need a new block.
-                Block* block = new Block;
-                _blockPtrs.Push(block);
+                Item* blockItems = _arena
+                    ? static_cast<Item*>(_arena->Allocate(_itemsPerBlock * sizeof(Item), alignof(Item)))
+                    : new Item[_itemsPerBlock];
+                _blockPtrs.Push(blockItems);
 
-                Item* blockItems = block->items;
-                for (size_t i = 0; i < ITEMS_PER_BLOCK - 1; ++i) {
+                for (size_t i = 0; i < _itemsPerBlock - 1; ++i) {
                     blockItems[i].next = &(blockItems[i + 1]);
                 }
-                blockItems[ITEMS_PER_BLOCK - 1].next = 0;
+                blockItems[_itemsPerBlock - 1].next = 0;
                 _root = blockItems;
             }
             Item* const result = _root;
@@ -421,6 +588,18 @@ namespace tinyxml2
             return _nUntracked;
         }
 
+        XMLPoolStats Stats() const {
+            XMLPoolStats stats;
+            stats.itemSize = ITEM_SIZE;
+            stats.currentAllocs = _currentAllocs;
+            stats.totalAllocs = _nAllocs;
+            stats.maxAllocs = _maxAllocs;
+            stats.untracked = _nUntracked;
+            stats.blocks = _blockPtrs.Size();
+            stats.bytes = _blockPtrs.Size() * BlockSize();
+            return stats;
+        }
+
         // This number is perf sensitive. 4k seems like a good tradeoff on my machine.
         // The test file is large, 170k.
         // Release:		VS2010 gcc(no opt)
@@ -432,6 +611,7 @@ namespace tinyxml2
         //		64k:	4000	21000
         // Declared public because some compilers do not accept to use ITEMS_PER_BLOCK
         // in private part if ITEMS_PER_BLOCK is private
+        // It is the default; XMLDocument::SetPoolBlockSize() changes it per document.
         enum { ITEMS_PER_BLOCK = (4 * 1024) / ITEM_SIZE };
 
     private:
@@ -442,11 +622,10 @@ namespace tinyxml2
             Item* next;
             char    itemData[static_cast<size_t>(ITEM_SIZE)];
         };
-        struct Block {
-            Item items[ITEMS_PER_BLOCK];
-        };
-        DynArray< Block*, 10 > _blockPtrs;
+        DynArray< Item*, 10 > _blockPtrs;
         Item* _root;
+        size_t _itemsPerBlock;
+        XMLArena* _arena;
 
         size_t _currentAllocs;
         size_t _nAllocs;
@@ -542,6 +721,18 @@ namespace tinyxml2
     };
 
 
+    /**
+        Instruction set used to scan whitespace, text and character data
+        while parsing. By default the best kernel supported by the processor
+        is selected at runtime; every kernel gives the same result.
+    */
+    enum XMLScanKernel {
+        XML_SCAN_SCALAR = 0,
+        XML_SCAN_SSE2,
+        XML_SCAN_AVX2
+    };
+
+
     /*
         Utility functionality.
     */
@@ -551,12 +742,11 @@ namespace tinyxml2
         static const char* SkipWhiteSpace(const char* p, int* curLineNumPtr) {
             TIXMLASSERT(p);
 
-            while (IsWhiteSpace(*p)) {
-                if (curLineNumPtr && *p == '\n') {
-                    ++(*curLineNumPtr);
-                }
-                ++p;
+            // Most calls see no whitespace at all; only runs go to the scan kernel.
+            if (!IsWhiteSpace(*p)) {
+                return p;
             }
+            p = SkipWhiteSpaceRun(p, curLineNumPtr);
             TIXMLASSERT(p);
             return p;
         }
@@ -564,6 +754,24 @@ namespace tinyxml2
             return const_cast<char*>(SkipWhiteSpace(const_cast<const char*>(p), curLineNumPtr));
         }
 
+        // Skips the whitespace starting at p with the active scan kernel,
+        // counting the newlines passed over.
+        static const char* SkipWhiteSpaceRun(const char* p, int* curLineNumPtr);
+
+        // Returns the first character from p that is stopChar or the null
+        // terminator, counting the newlines passed over.
+        static char* FindTextStop(char* p, char stopChar, int* curLineNumPtr);
+
+        /// Returns the scan kernel used by the parser.
+        static XMLScanKernel ScanKernel();
+
+        /** Selects the scan kernel used by the parser, mainly for testing
+            and benchmarking. A kernel the processor does not support is
+            replaced by the best supported one. Not thread safe: call it
+            while no document is being parsed. Returns the kernel in use.
+        */
+        static XMLScanKernel SetScanKernel(XMLScanKernel kernel);
+
         // Anything in the high order range of UTF-8 is assumed to not be whitespace. This isn't
         // correct, but simple, and usually works.
         static bool IsWhiteSpace(char p) {
@@ -614,6 +822,9 @@ namespace tinyxml2
         static void ConvertUTF32ToUTF8(unsigned long input, char* output, int* length);
 
         // converts primitive types to strings
+        // With C++17 the conversions use std::to_chars / std::from_chars:
+        // floating point values are written in the shortest form that reads
+        // back to the same value, and parsing does not depend on the locale.
         static void ToStr(int v, char* buffer, int bufferSize);
         static void ToStr(unsigned v, char* buffer, int bufferSize);
         static void ToStr(bool v, char* buffer, int bufferSize);
@@ -643,6 +854,50 @@ namespace tinyxml2
     };
 
 
+    /** An interned element name.
+
+        When name interning is enabled with XMLDocument::SetInternNames(),
+        every element of the document carries the atom of its name, and
+        the atom based lookups (FirstChildElement(XMLAtom) and friends)
+        compare integers instead of strings. Atoms are obtained from
+        XMLDocument::Atom() and are only meaningful for the document that
+        issued them; they stay valid for the lifetime of that document,
+        across Clear() and subsequent parses.
+
+        @verbatim
+        XMLAtom rowAtom = doc.Atom( "Row" );
+        for( XMLElement* row = board->FirstChildElement( rowAtom ); row; row = row->NextSiblingElement( rowAtom ) ) {
+            ...
+        }
+        @endverbatim
+    */
+    class TINYXML2_LIB XMLAtom
+    {
+        friend class XMLDocument;
+        friend class XMLNode;
+        friend class XMLElement;
+    public:
+        /// An invalid atom, which matches no element.
+        XMLAtom() : _id(0) {}
+
+        /// Returns false for the invalid atom.
+        bool IsValid() const {
+            return _id != 0;
+        }
+        bool operator==(const XMLAtom& other) const {
+            return _id == other._id;
+        }
+        bool operator!=(const XMLAtom& other) const {
+            return _id != other._id;
+        }
+
+    private:
+        explicit XMLAtom(unsigned id) : _id(id) {}
+
+        unsigned _id;
+    };
+
+
     /** XMLNode is a base class for every object that is in the
         XML Document Object Model (DOM), except XMLAttributes.
         Nodes have siblings, a parent, and children which can
@@ -786,6 +1041,13 @@ namespace tinyxml2
             return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->FirstChildElement(name));
         }
 
+        /// Get the first child element, matching the name by its atom. See XMLAtom.
+        const XMLElement* FirstChildElement(XMLAtom atom) const;
+
+        XMLElement* FirstChildElement(XMLAtom atom) {
+            return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->FirstChildElement(atom));
+        }
+
         /// Get the last child node, or null if none exists.
         const XMLNode* LastChild() const {
             return _lastChild;
@@ -804,6 +1066,13 @@ namespace tinyxml2
             return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->LastChildElement(name));
         }
 
+        /// Get the last child element, matching the name by its atom. See XMLAtom.
+        const XMLElement* LastChildElement(XMLAtom atom) const;
+
+        XMLElement* LastChildElement(XMLAtom atom) {
+            return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->LastChildElement(atom));
+        }
+
         /// Get the previous (left) sibling node of this node.
         const XMLNode* PreviousSibling() const {
             return _prev;
@@ -820,6 +1089,13 @@ namespace tinyxml2
             return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->PreviousSiblingElement(name));
         }
 
+        /// Get the previous sibling element, matching the name by its atom. See XMLAtom.
+        const XMLElement* PreviousSiblingElement(XMLAtom atom) const;
+
+        XMLElement* PreviousSiblingElement(XMLAtom atom) {
+            return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->PreviousSiblingElement(atom));
+        }
+
         /// Get the next (right) sibling node of this node.
         const XMLNode* NextSibling() const {
             return _next;
@@ -836,6 +1112,13 @@ namespace tinyxml2
             return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->NextSiblingElement(name));
         }
 
+        /// Get the next sibling element, matching the name by its atom. See XMLAtom.
+        const XMLElement* NextSiblingElement(XMLAtom atom) const;
+
+        XMLElement* NextSiblingElement(XMLAtom atom) {
+            return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->NextSiblingElement(atom));
+        }
+
         /**
             Add a child node as the last (right) child.
             If the child node is already part of the document,
@@ -934,6 +1217,7 @@ namespace tinyxml2
         */
         virtual bool Accept(XMLVisitor* visitor) const = 0;
 
+#if !defined(TINYXML2_COMPACT_NODES)
         /**
             Set user data into the XMLNode. TinyXML-2 in
             no way processes or interprets user data.
@@ -947,6 +1231,7 @@ namespace tinyxml2
             It is initially 0.
         */
         void* GetUserData() const { return _userData; }
+#endif
 
     protected:
         explicit XMLNode(XMLDocument*);
@@ -965,14 +1250,20 @@ namespace tinyxml2
         XMLNode* _prev;
         XMLNode* _next;
 
+#if !defined(TINYXML2_COMPACT_NODES)
         void* _userData;
+#endif
 
     private:
+#if !defined(TINYXML2_COMPACT_NODES)
         MemPool* _memPool;
+#endif
+        MemPool* Pool() const;
         void Unlink(XMLNode* child);
         static void DeleteNode(XMLNode* node);
         void InsertChildPreamble(XMLNode* insertThis) const;
         const XMLElement* ToElementWithName(const char* name) const;
+        const XMLElement* ToElementWithAtom(XMLAtom atom) const;
 
         XMLNode(const XMLNode&);	// not supported
         XMLNode& operator=(const XMLNode&);	// not supported
@@ -1243,7 +1534,7 @@ namespace tinyxml2
     private:
         enum { BUF_SIZE = 200 };
 
-        XMLAttribute() : _name(), _value(), _parseLineNum(0), _next(0), _memPool(0) {}
+        XMLAttribute() : _name(), _value(), _parseLineNum(0), _next(0) {}
         virtual ~XMLAttribute() {}
 
         XMLAttribute(const XMLAttribute&);	// not supported
@@ -1256,7 +1547,6 @@ namespace tinyxml2
         mutable StrPair _value;
         int             _parseLineNum;
         XMLAttribute* _next;
-        MemPool* _memPool;
     };
 
 
@@ -1267,6 +1557,7 @@ namespace tinyxml2
     class TINYXML2_LIB XMLElement : public XMLNode
     {
         friend class XMLDocument;
+        friend class XMLNode;
     public:
         /// Get the name of an element (which is the Value() of the node.)
         const char* Name() const {
@@ -1276,6 +1567,12 @@ namespace tinyxml2
         void SetName(const char* str, bool staticMem = false) {
             SetValue(str, staticMem);
         }
+        /** Get the atom of the element name. This is the invalid atom
+            unless the document interned the name; see XMLDocument::SetInternNames().
+        */
+        XMLAtom NameAtom() const {
+            return XMLAtom(_atom);
+        }
 
         virtual XMLElement* ToElement() override {
             return this;
@@ -1693,11 +1990,12 @@ namespace tinyxml2
 
         XMLAttribute* FindOrCreateAttribute(const char* name);
         char* ParseAttributes(char* p, int* curLineNumPtr);
-        static void DeleteAttribute(XMLAttribute* attribute);
+        void DeleteAttribute(XMLAttribute* attribute);
         XMLAttribute* CreateAttribute();
 
         enum { BUF_SIZE = 200 };
         ElementClosingType _closingType;
+        unsigned _atom;
         // The attribute list is ordered; there is no 'lastAttribute'
         // because the list needs to be scanned for dupes before adding
         // a new attribute.
@@ -1712,6 +2010,19 @@ namespace tinyxml2
     };
 
 
+    /// Memory held by an XMLDocument. See XMLDocument::MemoryStats().
+    struct XMLMemoryStats
+    {
+        XMLPoolStats elements;      ///< The element pool.
+        XMLPoolStats attributes;    ///< The attribute pool.
+        XMLPoolStats texts;         ///< The text pool.
+        XMLPoolStats comments;      ///< The pool of comments, declarations and unknowns.
+        size_t charBufferBytes;     ///< Capacity of the character buffer.
+        size_t mappedBytes;         ///< Size of the memory mapped file, if any.
+        size_t totalBytes;          ///< Bytes held by the pools and the character buffer.
+    };
+
+
     /** A Document binds together all the functionality.
         It can be saved, loaded, and printed to the screen.
         All Nodes are connected and allocated to a Document.
@@ -1753,6 +2064,21 @@ namespace tinyxml2
         */
         XMLError Parse(const char* xml, size_t nBytes = static_cast<size_t>(-1));
 
+        /**
+            Parse an XML document in place, from a character buffer owned
+            by the caller. Unlike Parse(), the input is not copied: the
+            document borrows the buffer, and its nodes point into it until
+            the document is cleared, parses again or is destroyed. The buffer
+            must stay valid and unchanged for that time, and is modified by
+            the parse, so it cannot be parsed a second time.
+
+            If 'nBytes' is given, the buffer must have room for nBytes + 1
+            characters: the null terminator is written at xml[nBytes].
+            Otherwise 'xml' must be a null terminated string.
+            Returns XML_SUCCESS (0) on success, or an errorID.
+        */
+        XMLError ParseInSitu(char* xml, size_t nBytes = static_cast<size_t>(-1));
+
         /**
             Load an XML file from disk.
             Returns XML_SUCCESS (0) on success, or
@@ -1768,11 +2094,23 @@ namespace tinyxml2
             not text in order for TinyXML-2 to correctly
             do newline normalization.
 
+            Files of at least TINYXML2_MMAP_THRESHOLD bytes are
+            mapped into memory with a private copy-on-write mapping
+            and parsed in place, so loading them costs no copy of
+            the file. The mapping is released by Clear(). Smaller
+            files, and files that cannot be mapped, are read into
+            the character buffer.
+
             Returns XML_SUCCESS (0) on success, or
             an errorID.
         */
         XMLError LoadFile(FILE*);
 
+        /// Returns true if the document was parsed from a memory mapped file.
+        bool IsFileMapped() const {
+            return _mappedFile != 0;
+        }
+
         /**
             Save the XML file to disk.
             Returns XML_SUCCESS (0) on success, or
@@ -1784,6 +2122,10 @@ namespace tinyxml2
             Save the XML file to disk. You are responsible
             for providing and closing the FILE*.
 
+            The document is printed through an XMLFileSink in chunks
+            of TINYXML2_WRITE_CHUNK_SIZE bytes, instead of one stdio
+            call per token.
+
             Returns XML_SUCCESS (0) on success, or
             an errorID.
         */
@@ -1808,6 +2150,87 @@ namespace tinyxml2
             _writeBOM = useBOM;
         }
 
+        /**
+            Returns true if Clear() keeps the memory of the document for reuse.
+        */
+        bool RetainsMemory() const {
+            return _retainMemory;
+        }
+        /** Sets whether Clear() keeps the memory of the document for reuse.
+            When set, Clear() (and therefore Parse() and LoadFile()) still
+            deletes every node, but keeps the blocks of the memory pools and
+            the character buffer. A document that repeatedly parses input of
+            similar size then performs no heap allocation after the first parse.
+            The memory is released by the destructor.
+        */
+        void SetRetainMemory(bool retain) {
+            _retainMemory = retain;
+        }
+
+        /**
+            Returns the size in bytes of the blocks the memory pools allocate
+            nodes from. See SetPoolBlockSize().
+        */
+        size_t PoolBlockSize() const {
+            return _poolBlockSize;
+        }
+        /** Sets the size in bytes of the blocks the memory pools allocate
+            nodes from; the default is 4 KB. Larger blocks need fewer
+            allocations for large documents, smaller blocks waste less memory
+            on small ones. Clears the document and releases its memory.
+        */
+        void SetPoolBlockSize(size_t bytes);
+
+        /**
+            Returns the arena backing the document, or null. See SetArena().
+        */
+        XMLArena* Arena() const {
+            return _arena;
+        }
+        /** Backs the memory pools and the character buffer with an arena,
+            or with the heap again if arena is null. Clears the document and
+            releases its memory.
+
+            With an arena, Clear() (and therefore Parse() and LoadFile())
+            drops the memory of the document instead of keeping or freeing
+            it, whatever SetRetainMemory() says. Once the document is cleared
+            or destroyed the caller may Reset() the arena, so importing a
+            batch of documents costs one arena reset per document instead of
+            a heap allocation per block. The arena must outlive the memory the
+            document takes from it, and must not be shared across threads.
+        */
+        void SetArena(XMLArena* arena);
+
+        /**
+            Returns the allocation statistics of the four memory pools and
+            the capacity of the character buffer. ParseInSitu() and memory
+            mapped loads do not use the character buffer; a mapping is
+            reported on its own and not counted in totalBytes.
+        */
+        XMLMemoryStats MemoryStats() const;
+
+        /**
+            Returns true if element names are interned. See SetInternNames().
+        */
+        bool InternsNames() const {
+            return _internNames;
+        }
+        /** Sets whether element names are interned. When set, every element
+            parsed, created or renamed afterwards is given the atom of its
+            name, so the XMLAtom overloads of FirstChildElement(),
+            NextSiblingElement() and friends find elements by comparing
+            integers. Documents with many repeated tags are traversed
+            substantially faster this way. Enable it before parsing.
+        */
+        void SetInternNames(bool intern) {
+            _internNames = intern;
+        }
+        /** Returns the atom of an element name, adding the name to the
+            table if needed. Returns the invalid atom, which matches no
+            element, if name interning is off.
+        */
+        XMLAtom Atom(const char* name);
+
         /** Return the root element of DOM. Equivalent to FirstChildElement().
             To get the first node, use FirstChild().
         */
@@ -1907,6 +2330,7 @@ namespace tinyxml2
         }
 
         /// Clear the document, resetting it to the initial state.
+        /// See SetRetainMemory() for keeping the allocated memory.
         void Clear();
 
         /**
@@ -1924,6 +2348,9 @@ namespace tinyxml2
         // internal
         void MarkInUse(const XMLNode* const);
 
+        // internal
+        char* ReserveCharBuffer(size_t size);
+
         virtual XMLNode* ShallowClone(XMLDocument* /*document*/) const override {
             return 0;
         }
@@ -1941,7 +2368,13 @@ namespace tinyxml2
         Whitespace		_whitespaceMode;
         mutable StrPair	_errorStr;
         int             _errorLineNum;
+        bool            _retainMemory;
+        size_t          _poolBlockSize;
+        XMLArena*       _arena;
         char* _charBuffer;
+        size_t          _charBufferCapacity;
+        char* _mappedFile;
+        size_t          _mappedSize;
         int				_parseCurLineNum;
         int				_parsingDepth;
         // Memory tracking does add some overhead.
@@ -1957,9 +2390,28 @@ namespace tinyxml2
         MemPoolT< sizeof(XMLText) >		 _textPool;
         MemPoolT< sizeof(XMLComment) >	 _commentPool;
 
+        // The name interning table: an open addressing hash table of atom
+        // ids (0 marks a free slot), the interned names by atom id - 1,
+        // and the characters of the names.
+        struct AtomEntry {
+            unsigned hash;
+            size_t offset;
+            size_t length;
+        };
+        bool                    _internNames;
+        DynArray<unsigned, 64>  _atomSlots;
+        DynArray<AtomEntry, 16> _atomEntries;
+        DynArray<char, 256>     _atomNames;
+
         static const char* _errorNames[XML_ERROR_COUNT];
 
-        void Parse();
+        void ParseBuffer(char* p);
+        bool MapFile(FILE* fp, size_t size);
+        void UnmapFile();
+        unsigned InternName(const char* name);
+        void GrowAtomSlots();
+        void DeleteParsedNodes();
+        void ReleaseMemory();
 
         void SetError(XMLError error, int lineNum, const char* format, ...);
 
@@ -1992,7 +2444,9 @@ namespace tinyxml2
         TIXMLASSERT(sizeof(NodeType) == pool.ItemSize());
         NodeType* returnNode = new (pool.Alloc()) NodeType(this);
         TIXMLASSERT(returnNode);
+#if !defined(TINYXML2_COMPACT_NODES)
         returnNode->_memPool = &pool;
+#endif
 
         _unlinked.Push(returnNode);
         return returnNode;
@@ -2196,6 +2650,71 @@ namespace tinyxml2
     };
 
 
+    /**
+        The destination of an XMLPrinter constructed with a sink. Implement
+        Write() to send the output anywhere: a fixed buffer, a file
+        descriptor, a serial transport.
+    */
+    class TINYXML2_LIB XMLSink
+    {
+    public:
+        virtual ~XMLSink() {}
+        /// Receives the next size bytes of output.
+        virtual void Write(const char* data, size_t size) = 0;
+    };
+
+
+    /**
+        A sink filling a buffer provided by the caller. The output is not
+        null terminated. Output that does not fit is dropped and reported
+        by Overflowed().
+    */
+    class TINYXML2_LIB XMLBufferSink : public XMLSink
+    {
+    public:
+        XMLBufferSink(char* buffer, size_t capacity) : _buffer(buffer), _capacity(capacity), _size(0), _overflowed(false) {}
+
+        virtual void Write(const char* data, size_t size) override;
+
+        /// Number of bytes written to the buffer.
+        size_t Size() const {
+            return _size;
+        }
+        /// Returns true if the output did not fit in the buffer.
+        bool Overflowed() const {
+            return _overflowed;
+        }
+        /// Starts over at the beginning of the buffer.
+        void Clear() {
+            _size = 0;
+            _overflowed = false;
+        }
+
+    private:
+        char* _buffer;
+        size_t _capacity;
+        size_t _size;
+        bool _overflowed;
+    };
+
+
+    /**
+        A sink writing to a FILE. Each piece of output is handed to the
+        operating system in chunks of TINYXML2_WRITE_CHUNK_SIZE bytes,
+        bypassing the stdio buffer where the platform allows.
+    */
+    class TINYXML2_LIB XMLFileSink : public XMLSink
+    {
+    public:
+        explicit XMLFileSink(FILE* fp) : _fp(fp) {}
+
+        virtual void Write(const char* data, size_t size) override;
+
+    private:
+        FILE* _fp;
+    };
+
+
     /**
         Printing functionality. The XMLPrinter gives you more
         options than the XMLDocument::Print() method.
@@ -2203,6 +2722,7 @@ namespace tinyxml2
         It can:
         -# Print to memory.
         -# Print to a file you provide.
+        -# Print to a sink you provide.
         -# Print XML without a XMLDocument.
 
         Print to Memory
@@ -2221,6 +2741,19 @@ namespace tinyxml2
         doc.Print( &printer );
         @endverbatim
 
+        Print to a Sink
+
+        The output is staged in a buffer allocated once, and handed to
+        the sink in chunks.
+        @verbatim
+        char tx[512];
+        XMLBufferSink sink( tx, sizeof( tx ) );
+        XMLPrinter printer( sink, true );
+        doc.Print( &printer );
+        printer.Flush();
+        // tx holds sink.Size() bytes of XML
+        @endverbatim
+
         Print without a XMLDocument
 
         When loading, an XML parser is very useful. However, sometimes
@@ -2248,7 +2781,18 @@ namespace tinyxml2
             with only required whitespace and newlines.
         */
         XMLPrinter(FILE* file = 0, bool compact = false, int depth = 0);
-        virtual ~XMLPrinter() {}
+        /** Construct a printer writing to a sink. The output is staged in
+            a buffer of chunkSize bytes, allocated up front, and handed to
+            the sink whenever the next piece would not fit, and by Flush().
+            Pieces of at least chunkSize bytes go straight to the sink, so
+            a chunkSize of 0 writes through without staging. Call Flush()
+            once the output is complete; the destructor flushes as well.
+        */
+        XMLPrinter(XMLSink& sink, bool compact = false, int depth = 0, size_t chunkSize = TINYXML2_PRINTER_CHUNK_SIZE);
+        virtual ~XMLPrinter();
+
+        /// If printing to a sink, hand the staged output to the sink.
+        void Flush();
 
         /** If streaming, write the BOM and declaration. */
         void PushHeader(bool writeBOM, bool writeDeclaration);
@@ -2327,6 +2871,14 @@ namespace tinyxml2
             _buffer.Push(0);
             _firstElement = resetToFirstElement;
         }
+        /**
+            If in print to memory mode, make room for capacity bytes of
+            output up front, so printing a document of known size does not
+            regrow the buffer.
+        */
+        void ReserveBuffer(size_t capacity) {
+            _buffer.Reserve(capacity + 1);
+        }
 
     protected:
         virtual bool CompactMode(const XMLElement&) { return _compactMode; }
@@ -2355,6 +2907,8 @@ namespace tinyxml2
 
         bool _firstElement;
         FILE* _fp;
+        XMLSink* _sink;
+        size_t _chunkSize;
         int _depth;
         int _textDepth;
         bool _processEntities;
@@ -2375,6 +2929,180 @@ namespace tinyxml2
     };
 
 
+
+    /// Event reported by XMLReader::Next().
+    enum XMLReadEvent {
+        XML_READ_NONE,
+        XML_READ_START_ELEMENT,
+        XML_READ_END_ELEMENT,
+        XML_READ_TEXT,
+        XML_READ_END_DOCUMENT,
+        XML_READ_ERROR
+    };
+
+
+    /**
+        A pull parser reading an XML document as a sequence of events,
+        without building a DOM.
+
+        The input is read in chunks of a fixed size into a buffer that only
+        holds the token being parsed, so memory stays bounded by the chunk
+        size and the largest single token, however large the document.
+        The tokens are parsed with the same StrPair and XMLUtil code as
+        XMLDocument, in place in the buffer.
+
+        @verbatim
+        XMLReader reader( fp );
+        for ( XMLReadEvent e = reader.Next(); e != XML_READ_END_DOCUMENT; e = reader.Next() ) {
+            if ( e == XML_READ_ERROR ) {
+                printf( "%s on line %d\n", reader.ErrorName(), reader.LineNum() );
+                break;
+            }
+            if ( e == XML_READ_START_ELEMENT && strcmp( reader.Name(), "GameState" ) == 0 ) {
+                ...
+            }
+        }
+        @endverbatim
+
+        Each call to Next() returns the next start element, end element or
+        text event. An empty element (<a/>) gives a start and an end event.
+        Declarations, comments and DTDs are skipped, and so is text made of
+        whitespace only. The strings returned for an event are valid until
+        the next call to Next().
+
+        The reader accepts the documents XMLDocument accepts and reports the
+        same content, except that a document without an element, text
+        outside the root element and an end tag without a start tag are
+        errors, where XMLDocument accepts them or stops parsing silently.
+    */
+    class TINYXML2_LIB XMLReader
+    {
+    public:
+        /// Reads the document from an open file, which must stay open while reading.
+        XMLReader(FILE* fp, bool processEntities = true, size_t chunkSize = TINYXML2_READER_CHUNK_SIZE);
+        /** Reads the document from memory. If 'nBytes' is not given,
+            'xml' must be a null terminated string. The memory must stay
+            valid while reading.
+        */
+        XMLReader(const char* xml, size_t nBytes = static_cast<size_t>(-1), bool processEntities = true, size_t chunkSize = TINYXML2_READER_CHUNK_SIZE);
+        ~XMLReader();
+
+        /** Advances to the next event and returns it. Once the end of the
+            document or an error is reached, the same event is returned again.
+        */
+        XMLReadEvent Next();
+
+        /// The current event.
+        XMLReadEvent Event() const {
+            return _event;
+        }
+        /// The element name of a start or end element event, null otherwise.
+        const char* Name() const {
+            return (_event == XML_READ_START_ELEMENT || _event == XML_READ_END_ELEMENT) ? _nameStr : 0;
+        }
+        /// The text of a text event, with entities and newlines processed; null otherwise.
+        const char* Text() const {
+            return (_event == XML_READ_TEXT) ? _textStr : 0;
+        }
+        /// True if the text event came from a CDATA section.
+        bool CData() const {
+            return _cdata;
+        }
+
+        /// The number of attributes of a start element event.
+        int AttributeCount() const {
+            return static_cast<int>(_attributes.Size() / 2);
+        }
+        /// The name of an attribute of a start element event.
+        const char* AttributeName(int index) const {
+            return _attributes[2 * index];
+        }
+        /// The value of an attribute of a start element event.
+        const char* AttributeValue(int index) const {
+            return _attributes[2 * index + 1];
+        }
+        /// The value of the named attribute of a start element event, or null.
+        const char* Attribute(const char* name) const;
+
+        /// The number of elements enclosing the current event.
+        int Depth() const {
+            return _depth;
+        }
+        /// The line on which the current event starts.
+        int LineNum() const {
+            return _eventLineNum;
+        }
+        /// The error after Next() returned XML_READ_ERROR, XML_SUCCESS otherwise.
+        XMLError ErrorID() const {
+            return _errorID;
+        }
+        /// The name of the error; see XMLDocument::ErrorIDToName().
+        const char* ErrorName() const {
+            return XMLDocument::ErrorIDToName(_errorID);
+        }
+        /// The size of the input buffer, which only grows for tokens larger than a chunk.
+        size_t BufferCapacity() const {
+            return _capacity;
+        }
+
+    private:
+        enum TokenResult {
+            TOKEN_READ,
+            TOKEN_SKIPPED,
+            TOKEN_INCOMPLETE,
+            TOKEN_END,
+            TOKEN_FAILED
+        };
+
+        void Init(bool processEntities, size_t chunkSize);
+        bool Fill();
+        TokenResult ReadToken();
+        TokenResult ReadElement(char* p, int* lineNum);
+        TokenResult ReadSkipped(char* p, const char* endTag, XMLError error, int* lineNum);
+        TokenResult ReadText(char* p, bool cdata, int* lineNum);
+        TokenResult Incomplete(XMLError error);
+        TokenResult Fail(XMLError error);
+        void Consume(char* p, int lineNum);
+        void PushOpenName(const char* name);
+        void PopOpenName();
+
+        FILE* _fp;
+        const char* _memory;
+        size_t _memoryLeft;
+        bool _eof;
+        bool _atStart;
+        bool _processEntities;
+
+        // The buffer holds _size bytes followed by a null terminator;
+        // everything before _pos has been consumed.
+        char* _buffer;
+        size_t _capacity;
+        size_t _size;
+        size_t _pos;
+
+        XMLReadEvent _event;
+        XMLError _errorID;
+        const char* _nameStr;
+        const char* _textStr;
+        bool _cdata;
+        bool _pendingEnd;
+        bool _restoreTag;
+        bool _sawElement;
+        bool _sawNode;
+        int _depth;
+        int _lineNum;
+        int _eventLineNum;
+        DynArray< char*, 32 > _attributeRanges;
+        DynArray< const char*, 16 > _attributes;
+        DynArray< char, 256 > _openNames;
+        DynArray< size_t, 16 > _openNameStarts;
+
+        // Prohibit cloning, intentionally not implemented
+        XMLReader(const XMLReader&);
+        XMLReader& operator=(const XMLReader&);
+    };
+
+
 } // namespace tinyxml2
 
 #if defined(_MSC_VER)
@@ -0,0 +1,336 @@
+/**
+ * @file TicTacToeCore.h
+ * @brief Contains the typed game state and the game rules shared by the server and the client.
+ *
+ * The header depends on nothing but the C library, so the same rules compile into the AVR sketch
+ * and into the host client. Game modes and statuses are enums and the board is a pair of 9-bit
+ * masks, so the rules never compare strings; names are only looked up where a game state is read
+ * from or written to XML.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Game modes, in the order of the mode index used by the journal and the archive.
+ */
+enum class GameMode : uint8_t {
+  ManVsMan,
+  ManVsAI,
+  AIVsMan,
+  AIVsAI
+};
+
+/**
+ * @brief Game statuses. The first four are the compact status codes (0 NextMove, 1 Win X, 2 Win O, 3 Draw).
+ */
+enum class GameStatus : uint8_t {
+  NextMove,
+  WinX,
+  WinO,
+  Draw,
+  Start
+};
+
+/**
+ * @brief Number of game modes and game statuses.
+ */
+const uint8_t GAME_MODE_COUNT = 4;
+const uint8_t GAME_STATUS_COUNT = 5;
+
+/**
+ * @brief Names of the game modes and statuses as written in XML, indexed by the enums.
+ */
+const char* const GAME_MODE_NAMES[GAME_MODE_COUNT] = { "Man vs Man", "Man vs AI", "AI vs Man", "AI vs AI" };
+const char* const GAME_STATUS_NAMES[GAME_STATUS_COUNT] = { "NextMove", "Win X", "Win O", "Draw", "Start" };
+
+/**
+ * @brief Cell index reported when no move is possible.
+ */
+const uint8_t NO_MOVE = 0x0F;
+
+/**
+ * @brief Mask of a full board and masks of the eight winning lines, bit i for cell i (row * 3 + column).
+ */
+const uint16_t FULL_BOARD = 0x1FF;
+const uint16_t WIN_LINES[8] = { 0x007, 0x038, 0x1C0, 0x049, 0x092, 0x124, 0x111, 0x054 };
+
+/**
+ * @brief Weights the AI picks a cell by when it can neither win nor block: center, then corners, then edges.
+ */
+const uint8_t CELL_WEIGHTS[9] = { 3, 1, 3, 1, 5, 1, 3, 1, 3 };
+
+/**
+ * @brief A game state with the board packed into two masks.
+ */
+struct CoreState {
+  uint16_t x;           ///< Cells holding 'X', bit i for cell i (row * 3 + column).
+  uint16_t o;           ///< Cells holding 'O'.
+  char player;          ///< The player to move ('X' or 'O').
+  GameMode mode;        ///< The game mode.
+  GameStatus status;    ///< The game status.
+};
+
+/**
+ * @brief Returns the name of a game mode.
+ *
+ * @param mode The game mode.
+ * @return The name (e.g., "Man vs AI").
+ */
+inline const char* gameModeName(GameMode mode) {
+  return GAME_MODE_NAMES[static_cast<uint8_t>(mode)];
+}
+
+/**
+ * @brief Returns the name of a game status.
+ *
+ * @param status The game status.
+ * @return The name (e.g., "Win X").
+ */
+inline const char* gameStatusName(GameStatus status) {
+  return GAME_STATUS_NAMES[static_cast<uint8_t>(status)];
+}
+
+/**
+ * @brief Returns the index of the name that matches a text.
+ *
+ * @param names The names.
+ * @param count The number of names.
+ * @param text The text, which need not be null-terminated.
+ * @param length The length of the text.
+ * @return The index of the matching name, or count if no name matches.
+ */
+inline uint8_t findName(const char* const names[], uint8_t count, const char* text, size_t length) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (strncmp(names[i], text, length) == 0 && names[i][length] == '\0') {
+      return i;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Looks up a game mode by name.
+ *
+ * @param text The name, which need not be null-terminated.
+ * @param length The length of the name.
+ * @param mode Receives the game mode.
+ * @return true if the name is a game mode, false otherwise.
+ */
+inline bool findGameMode(const char* text, size_t length, GameMode& mode) {
+  uint8_t index = findName(GAME_MODE_NAMES, GAME_MODE_COUNT, text, length);
+  if (index == GAME_MODE_COUNT) {
+    return false;
+  }
+  mode = static_cast<GameMode>(index);
+  return true;
+}
+
+/**
+ * @brief Looks up a game status by name.
+ *
+ * @param text The name, which need not be null-terminated.
+ * @param length The length of the name.
+ * @param status Receives the game status.
+ * @return true if the name is a game status, false otherwise.
+ */
+inline bool findGameStatus(const char* text, size_t length, GameStatus& status) {
+  uint8_t index = findName(GAME_STATUS_NAMES, GAME_STATUS_COUNT, text, length);
+  if (index == GAME_STATUS_COUNT) {
+    return false;
+  }
+  status = static_cast<GameStatus>(index);
+  return true;
+}
+
+/**
+ * @brief Checks if a status ends the game.
+ *
+ * @param status The game status.
+ * @return true for Win X, Win O and Draw, false otherwise.
+ */
+inline bool isGameOver(GameStatus status) {
+  return status == GameStatus::WinX || status == GameStatus::WinO || status == GameStatus::Draw;
+}
+
+/**
+ * @brief Returns the opponent of a player.
+ *
+ * @param player The player ('X' or 'O').
+ * @return The other player.
+ */
+inline char otherPlayer(char player) {
+  return (player == 'X') ? 'O' : 'X';
+}
+
+/**
+ * @brief Returns the symbol in a cell.
+ *
+ * @param state The game state.
+ * @param cell The cell index (0-8).
+ * @return 'X', 'O' or '_'.
+ */
+inline char cellSymbol(const CoreState& state, uint8_t cell) {
+  uint16_t bit = 1 << cell;
+  return (state.x & bit) ? 'X' : (state.o & bit) ? 'O' : '_';
+}
+
+/**
+ * @brief Sets the symbol in a cell.
+ *
+ * @param state The game state.
+ * @param cell The cell index (0-8).
+ * @param symbol 'X', 'O' or '_'.
+ * @return true if the symbol is valid, false otherwise.
+ */
+inline bool setCellSymbol(CoreState& state, uint8_t cell, char symbol) {
+  uint16_t bit = 1 << cell;
+  state.x &= ~bit;
+  state.o &= ~bit;
+  if (symbol == 'X') {
+    state.x |= bit;
+  } else if (symbol == 'O') {
+    state.o |= bit;
+  }
+  return symbol == 'X' || symbol == 'O' || symbol == '_';
+}
+
+/**
+ * @brief Places the symbol of the player to move in a cell.
+ *
+ * @param state The game state.
+ * @param cell The cell index (0-8).
+ * @return true if the cell was empty, false otherwise.
+ */
+inline bool playCell(CoreState& state, uint8_t cell) {
+  uint16_t bit = 1 << cell;
+  if ((state.x | state.o) & bit) {
+    return false;
+  }
+  if (state.player == 'X') {
+    state.x |= bit;
+  } else {
+    state.o |= bit;
+  }
+  return true;
+}
+
+/**
+ * @brief Checks if a set of cells completes a winning line.
+ *
+ * @param cells The cells of one player.
+ * @return true if the cells hold a whole row, column or diagonal, false otherwise.
+ */
+inline bool hasWon(uint16_t cells) {
+  for (uint8_t i = 0; i < 8; i++) {
+    if ((cells & WIN_LINES[i]) == WIN_LINES[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Determines the status of a board.
+ *
+ * @param state The game state.
+ * @return Win X or Win O if a player has a line (X first), Draw if the board is full, NextMove otherwise.
+ */
+inline GameStatus evaluateBoard(const CoreState& state) {
+  if (hasWon(state.x)) {
+    return GameStatus::WinX;
+  }
+  if (hasWon(state.o)) {
+    return GameStatus::WinO;
+  }
+  if ((state.x | state.o) == FULL_BOARD) {
+    return GameStatus::Draw;
+  }
+  return GameStatus::NextMove;
+}
+
+/**
+ * @brief Chooses the AI's move: a winning cell, else a cell that blocks the opponent, else the empty
+ * cell with the highest weight. Ties go to the first cell in row-major order.
+ *
+ * @param state The game state.
+ * @param player The player the AI moves for ('X' or 'O').
+ * @return The cell index (0-8), or NO_MOVE if the board is full.
+ */
+inline uint8_t weightedMove(const CoreState& state, char player) {
+  uint16_t own = (player == 'X') ? state.x : state.o;
+  uint16_t opponent = (player == 'X') ? state.o : state.x;
+  uint16_t empty = FULL_BOARD & ~(state.x | state.o);
+  for (uint8_t cell = 0; cell < 9; cell++) {
+    if ((empty & (1 << cell)) && hasWon(own | (1 << cell))) {
+      return cell;
+    }
+  }
+  for (uint8_t cell = 0; cell < 9; cell++) {
+    if ((empty & (1 << cell)) && hasWon(opponent | (1 << cell))) {
+      return cell;
+    }
+  }
+  uint8_t best = NO_MOVE;
+  for (uint8_t cell = 0; cell < 9; cell++) {
+    if ((empty & (1 << cell)) && (best == NO_MOVE || CELL_WEIGHTS[cell] > CELL_WEIGHTS[best])) {
+      best = cell;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Advances a game by one request: applies the move the client made and plays the AI's reply.
+ *
+ * A finished game is left as is. Otherwise, by game mode:
+ * - Man vs Man: the turn passes to the other player.
+ * - Man vs AI: the AI answers the player's move with a weighted move.
+ * - AI vs Man: the AI makes a weighted move, after the player's move unless the game is starting.
+ * - AI vs AI: both sides play random moves until the game ends.
+ * The status is re-evaluated after every move.
+ *
+ * @param state The game state received from the client, updated in place.
+ * @param randomMove Chooses a random empty cell of a board that is not full.
+ */
+inline void advanceGame(CoreState& state, uint8_t (*randomMove)(const CoreState& state)) {
+  if (state.status != GameStatus::Start && state.status != GameStatus::NextMove) {
+    return;
+  }
+  switch (state.mode) {
+    case GameMode::ManVsMan:
+      state.player = otherPlayer(state.player);
+      state.status = evaluateBoard(state);
+      break;
+    case GameMode::AIVsMan:
+      if (state.status != GameStatus::Start) {
+        state.player = otherPlayer(state.player);
+      }
+      state.status = evaluateBoard(state);
+      if (!isGameOver(state.status)) {
+        playCell(state, weightedMove(state, state.player));
+        state.player = otherPlayer(state.player);
+        state.status = evaluateBoard(state);
+      }
+      break;
+    case GameMode::ManVsAI:
+      state.status = evaluateBoard(state);
+      if (!isGameOver(state.status)) {
+        state.player = otherPlayer(state.player);
+        playCell(state, weightedMove(state, state.player));
+        state.player = otherPlayer(state.player);
+        state.status = evaluateBoard(state);
+      }
+      break;
+    case GameMode::AIVsAI:
+      state.status = evaluateBoard(state);
+      while (!isGameOver(state.status)) {
+        playCell(state, randomMove(state));
+        state.player = otherPlayer(state.player);
+        state.status = evaluateBoard(state);
+      }
+      break;
+  }
+}
@@ -1,323 +1,844 @@
+#include "TicTacToeCore.h"
+
+/**
+ * @brief Frame types used by the link protocol.
+ */
+const uint8_t FRAME_DATA = 0x01;
+const uint8_t FRAME_ACK = 0x02;
+const uint8_t FRAME_NAK = 0x03;
+const uint8_t FRAME_BAUD = 0x04;
+const uint8_t FRAME_TEST = 0x05;
+
+/**
+ * @brief Frame layout constants.
+ *
+ * A frame is a 4-byte header (type, sequence number, fragment index, fragment count), up to
+ * FRAME_PAYLOAD_SIZE bytes of payload and a big-endian CRC-16/CCITT, COBS-encoded and terminated
+ * by a zero byte. The payload size keeps a whole frame inside the 64-byte serial receive buffer.
+ */
+const uint8_t FRAME_HEADER_SIZE = 4;
+const uint8_t FRAME_CRC_SIZE = 2;
+const uint8_t FRAME_PAYLOAD_SIZE = 48;
+const uint8_t FRAME_MAX_SIZE = FRAME_HEADER_SIZE + FRAME_PAYLOAD_SIZE + FRAME_CRC_SIZE;
+const uint8_t FRAME_MAX_ENCODED_SIZE = FRAME_MAX_SIZE + 2;
+
 /**
- * @brief Checks if a player has won.
+ * @brief Link protocol timing constants.
+ */
+const unsigned long ACK_TIMEOUT_MS = 250;
+const uint8_t MAX_RETRIES = 5;
+
+/**
+ * @brief Baud rate negotiation constants.
  * 
- * Checks all possible combinations for a player to win on a 3x3 board.
+ * The link starts at BASE_BAUD_RATE. A newly requested rate is on probation until the client
+ * confirms it; without a valid frame for BAUD_PROBATION_MS, or after BAUD_ERROR_LIMIT corrupted
+ * frames in a row at a faster rate, the server falls back to BASE_BAUD_RATE.
+ * 1 Mbps, 500 kbps and 250 kbps divide the 16 MHz clock exactly.
+ */
+const unsigned long BASE_BAUD_RATE = 9600;
+const unsigned long SUPPORTED_BAUD_RATES[] = { 1000000, 500000, 250000, 115200, 57600, 38400, 19200, 9600 };
+const unsigned long BAUD_PROBATION_MS = 500;
+const uint8_t BAUD_ERROR_LIMIT = 3;
+
+/**
+ * @brief Maximum length of a request or response message.
+ */
+const int MESSAGE_CAPACITY = 384;
+
+/**
+ * @brief Binary request types. XML requests always start with '<', so they never collide with these.
+ */
+const uint8_t MSG_PLAY_GAMES = 0x01;
+const uint8_t MSG_EVAL_BATCH = 0x02;
+
+/**
+ * @brief Maximum number of games played per MSG_PLAY_GAMES request (a game record takes at most 6 bytes).
+ */
+const uint8_t PLAY_GAMES_MAX = 60;
+
+/**
+ * @brief Maximum number of positions per MSG_EVAL_BATCH request (a packed position takes 3 bytes).
+ */
+const uint8_t EVAL_BATCH_MAX = 120;
+
+/**
+ * @brief Error codes reported when a game state request is rejected.
+ */
+const uint8_t PARSE_OK = 0;
+const uint8_t PARSE_ERROR_SYNTAX = 1;
+const uint8_t PARSE_ERROR_UNEXPECTED_ELEMENT = 2;
+const uint8_t PARSE_ERROR_DUPLICATE_FIELD = 3;
+const uint8_t PARSE_ERROR_MISSING_FIELD = 4;
+const uint8_t PARSE_ERROR_CELL_COUNT = 5;
+const uint8_t PARSE_ERROR_INVALID_VALUE = 6;
+
+/**
+ * @brief Elements of a game state request, indexing TAG_NAMES and TAG_DEPTHS.
+ */
+const uint8_t TAG_GAME_STATE = 0;
+const uint8_t TAG_PLAYER = 1;
+const uint8_t TAG_GAME_TYPE = 2;
+const uint8_t TAG_BOARD = 3;
+const uint8_t TAG_ROW = 4;
+const uint8_t TAG_CELL = 5;
+const uint8_t TAG_STATUS = 6;
+const uint8_t TAG_UNKNOWN = 7;
+const char* const TAG_NAMES[] = { "GameState", "Player", "GameType", "Board", "Row", "Cell", "Status" };
+
+/**
+ * @brief Nesting depth at which each element may open, and the element closing each depth.
+ */
+const uint8_t TAG_DEPTHS[] = { 0, 1, 1, 1, 2, 3, 1 };
+const uint8_t TAG_CONTAINERS[] = { TAG_GAME_STATE, TAG_BOARD, TAG_ROW };
+
+/**
+ * @brief Elements that must appear exactly once in a game state request, one bit per TAG_* constant.
+ */
+const uint8_t GAME_STATE_FIELDS = (1 << TAG_GAME_STATE) | (1 << TAG_PLAYER) | (1 << TAG_GAME_TYPE) |
+                                  (1 << TAG_BOARD) | (1 << TAG_STATUS);
+
+/**
+ * @brief Receive state of the frame currently being assembled.
+ */
+uint8_t rxFrame[FRAME_MAX_ENCODED_SIZE];
+uint8_t rxFrameLength = 0;
+bool rxFrameOverflow = false;
+
+/**
+ * @brief The last decoded frame.
+ */
+uint8_t frameType;
+uint8_t frameSeq;
+uint8_t frameIndex;
+uint8_t frameCount;
+uint8_t framePayload[FRAME_PAYLOAD_SIZE];
+uint8_t framePayloadLength;
+
+/**
+ * @brief Message buffer shared by the request being received and the response being sent.
+ */
+char message[MESSAGE_CAPACITY + 1];
+int messageLength = 0;
+uint8_t rxSeq = 0;
+uint8_t rxNext = 0;
+uint8_t rxCount = 0;
+bool responseReady = false;
+bool framePending = false;
+
+/**
+ * @brief Baud rate negotiation state.
+ */
+unsigned long currentBaudRate = BASE_BAUD_RATE;
+bool baudOnProbation = false;
+unsigned long lastValidFrameMs = 0;
+uint8_t consecutiveErrors = 0;
+
+/**
+ * @brief Chooses a random empty cell for the AI.
  * 
- * @param player The player's symbol ('X' or 'O').
- * @param board The game board (3x3 array).
- * @return true if the player has won, false otherwise.
+ * @param state The game state, whose board must not be full.
+ * @return The index of the chosen cell (row * 3 + column).
  */
-bool checkWin(char player, char board[3][3]) {
-  for (int i = 0; i < 3; i++) {
-    if (board[i][0] == player && board[i][1] == player && board[i][2] == player) {
-      return true;
-    }
+uint8_t randomMove(const CoreState& state) {
+  uint8_t cell;
+  do {
+    cell = random(0, 9);
+  } while ((state.x | state.o) & (1 << cell));
+  return cell;
+}
+
+/**
+ * @brief Reads the tag at the cursor and moves the cursor past it.
+ * 
+ * Only the bare tags the game state format uses are recognized; a tag with attributes is unknown.
+ * 
+ * @param p The cursor, pointing at '<'.
+ * @param closing Set to true if the tag is a closing tag.
+ * @return One of the TAG_* constants, TAG_UNKNOWN for any other or an unterminated tag.
+ */
+uint8_t readTag(const char*& p, bool& closing) {
+  p++;
+  closing = (*p == '/');
+  if (closing) {
+    p++;
   }
-  for (int i = 0; i < 3; i++) {
-    if (board[0][i] == player && board[1][i] == player && board[2][i] == player) {
-      return true;
+  const char* name = p;
+  while (*p && *p != '>') {
+    p++;
+  }
+  if (*p != '>') {
+    return TAG_UNKNOWN;
+  }
+  size_t length = p - name;
+  p++;
+  for (uint8_t tag = 0; tag < TAG_UNKNOWN; tag++) {
+    if (strncmp(TAG_NAMES[tag], name, length) == 0 && TAG_NAMES[tag][length] == '\0') {
+      return tag;
     }
   }
-  if ((board[0][0] == player && board[1][1] == player && board[2][2] == player) || 
-      (board[0][2] == player && board[1][1] == player && board[2][0] == player)) {
-    return true;
+  return TAG_UNKNOWN;
+}
+
+/**
+ * @brief Reads the text of a field and moves the cursor past the closing tag of the field.
+ * 
+ * @param p The cursor, pointing just after the opening tag.
+ * @param tag The TAG_* constant of the field.
+ * @param text Receives the start of the text, which is not null-terminated.
+ * @param length Receives the length of the text.
+ * @return PARSE_OK, or PARSE_ERROR_SYNTAX if the closing tag is not next.
+ */
+uint8_t readFieldText(const char*& p, uint8_t tag, const char*& text, size_t& length) {
+  text = p;
+  while (*p && *p != '<') {
+    p++;
+  }
+  length = p - text;
+  bool closing;
+  if (*p != '<' || readTag(p, closing) != tag || !closing) {
+    return PARSE_ERROR_SYNTAX;
   }
-  return false;
+  return PARSE_OK;
 }
 
 /**
- * @brief Checks if the game has resulted in a draw.
+ * @brief Parses and validates a game state request in a single pass.
  * 
- * Checks if the board is full and no player has won, indicating a draw.
+ * The request is walked once from start to end, recognizing each tag as it is reached, instead of
+ * searching the whole request again for every field and cell. The request must hold exactly one
+ * Player, GameType, Board and Status inside GameState, and the board exactly 3 rows of 3 cells,
+ * each with an allowed value. An XML declaration and whitespace between tags are skipped, and
+ * nothing but whitespace may follow the closing GameState tag.
  * 
- * @param board The game board (3x3 array).
- * @return true if the game is a draw, false otherwise.
+ * @param xml The request.
+ * @param state Receives the game state.
+ * @return PARSE_OK if the request is a valid game state, one of the PARSE_ERROR_* codes otherwise.
  */
-bool checkDraw(char board[3][3]) {
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      if (board[i][j] == '_') {
-        return false;
+uint8_t parseGameState(const char* xml, CoreState& state) {
+  const char* p = xml;
+  uint8_t fields = 0;
+  uint8_t depth = 0;
+  uint8_t rows = 0;
+  uint8_t cells = 0;
+  state.x = 0;
+  state.o = 0;
+  while (*p) {
+    if (*p != '<') {
+      if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+        return PARSE_ERROR_SYNTAX;
+      }
+      p++;
+      continue;
+    }
+    if (p[1] == '?') {
+      if (fields != 0) {
+        return PARSE_ERROR_SYNTAX;
+      }
+      while (*p && !(p[0] == '?' && p[1] == '>')) {
+        p++;
+      }
+      if (!*p) {
+        return PARSE_ERROR_SYNTAX;
+      }
+      p += 2;
+      continue;
+    }
+    bool closing;
+    uint8_t tag = readTag(p, closing);
+    if (tag == TAG_UNKNOWN) {
+      return (p[-1] == '>') ? PARSE_ERROR_UNEXPECTED_ELEMENT : PARSE_ERROR_SYNTAX;
+    }
+    if (closing) {
+      if (depth == 0 || tag != TAG_CONTAINERS[depth - 1]) {
+        return PARSE_ERROR_SYNTAX;
+      }
+      if ((tag == TAG_ROW && cells != 3) || (tag == TAG_BOARD && rows != 3)) {
+        return PARSE_ERROR_CELL_COUNT;
+      }
+      if (--depth == 0) {
+        break;
+      }
+      continue;
+    }
+    if (TAG_DEPTHS[tag] != depth) {
+      return PARSE_ERROR_UNEXPECTED_ELEMENT;
+    }
+    if (tag == TAG_ROW) {
+      if (rows == 3) {
+        return PARSE_ERROR_CELL_COUNT;
+      }
+      rows++;
+      cells = 0;
+      depth++;
+      continue;
+    }
+    if (tag == TAG_CELL) {
+      if (cells == 3) {
+        return PARSE_ERROR_CELL_COUNT;
+      }
+    } else if (fields & (1 << tag)) {
+      return PARSE_ERROR_DUPLICATE_FIELD;
+    } else {
+      fields |= 1 << tag;
+      if (tag == TAG_GAME_STATE || tag == TAG_BOARD) {
+        depth++;
+        continue;
       }
     }
+    const char* text;
+    size_t length;
+    uint8_t result = readFieldText(p, tag, text, length);
+    if (result != PARSE_OK) {
+      return result;
+    }
+    bool valid;
+    if (tag == TAG_CELL) {
+      valid = length == 1 && setCellSymbol(state, (rows - 1) * 3 + cells++, text[0]);
+    } else if (tag == TAG_PLAYER) {
+      valid = length == 1 && (text[0] == 'X' || text[0] == 'O');
+      state.player = text[0];
+    } else if (tag == TAG_GAME_TYPE) {
+      valid = findGameMode(text, length, state.mode);
+    } else {
+      valid = findGameStatus(text, length, state.status);
+    }
+    if (!valid) {
+      return PARSE_ERROR_INVALID_VALUE;
+    }
+  }
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+    p++;
+  }
+  if (*p) {
+    return PARSE_ERROR_SYNTAX;
   }
-  return true;
+  if (!(fields & (1 << TAG_GAME_STATE))) {
+    return PARSE_ERROR_MISSING_FIELD;
+  }
+  if (depth != 0) {
+    return PARSE_ERROR_SYNTAX;
+  }
+  if (fields != GAME_STATE_FIELDS) {
+    return PARSE_ERROR_MISSING_FIELD;
+  }
+  return PARSE_OK;
 }
 
 /**
- * @brief Makes a random move for the AI.
+ * @brief Reads the XML game data and updates the game logic.
  * 
- * Selects an empty spot on the board and places the AI's symbol there.
+ * This function parses the XML data into a typed game state, advances it by the rules shared with
+ * the client, which make the AI moves when needed, and writes the result back as XML. A request
+ * that is not a valid game state is answered with an error carrying the PARSE_ERROR_* code.
  * 
- * @param aiSymbol The AI's symbol ('X' or 'O').
- * @param board The game board (3x3 array).
+ * @param xmlData The game data in XML format.
  */
-void aiMove(char aiSymbol, char board[3][3]) {
-  int row, col;
-  do {
-    row = random(0, 3);
-    col = random(0, 3);
-  } while (board[row][col] != '_');
-  board[row][col] = aiSymbol;
+void readAndUpdateGameLogic(const char* xmlData) {
+  CoreState state;
+  uint8_t error = parseGameState(xmlData, state);
+  if (error != PARSE_OK) {
+    messageLength = 0;
+    appendToMessage("Error: invalid game state, code ");
+    appendToMessage((char)('0' + error));
+    appendToMessage(".");
+    return;
+  }
+  advanceGame(state, randomMove);
+  exportGameStateXML(state);
 }
 
 /**
- * @brief Makes a move for the AI with dynamic weights.
+ * @brief Exports the game state to XML format.
  * 
- * The AI attempts to win or block the opponent from winning. If no such move is possible,
- * it selects the best move based on predefined weights.
+ * Converts the current game state (player, game type, status, and board) to XML format
+ * and writes it into the message buffer, replacing the request.
  * 
- * @param aiSymbol The AI's symbol ('X' or 'O').
- * @param board The game board (3x3 array).
+ * @param state The game state.
  */
-void aiMoveWithDynamicWeights(char aiSymbol, char board[3][3]) {
-  // Try to win
+void exportGameStateXML(const CoreState& state) {
+  messageLength = 0;
+  appendToMessage("<?xml version=\"1.0\" encoding=\"utf-8\"?>");
+  appendToMessage("<GameState>");
+  appendToMessage("<Player>");
+  appendToMessage(state.player);
+  appendToMessage("</Player>");
+  appendToMessage("<GameType>");
+  appendToMessage(gameModeName(state.mode));
+  appendToMessage("</GameType>");
+  appendToMessage("<Board>");
   for (int i = 0; i < 3; i++) {
+    appendToMessage("<Row>");
     for (int j = 0; j < 3; j++) {
-      if (board[i][j] == '_') {
-        board[i][j] = aiSymbol;
-        if (checkWin(board, aiSymbol)) {
-          return;
-        }
-        board[i][j] = '_';
+      appendToMessage("<Cell>");
+      appendToMessage(cellSymbol(state, i * 3 + j));
+      appendToMessage("</Cell>");
+    }
+    appendToMessage("</Row>");
+  }
+  appendToMessage("</Board>");
+  appendToMessage("<Status>");
+  appendToMessage(gameStatusName(state.status));
+  appendToMessage("</Status>");
+  appendToMessage("</GameState>");
+}
+
+/**
+ * @brief Appends a string to the message buffer.
+ * 
+ * Text that does not fit into MESSAGE_CAPACITY is dropped; the buffer is always null-terminated.
+ * 
+ * @param text The null-terminated string to append.
+ */
+void appendToMessage(const char* text) {
+  while (*text && messageLength < MESSAGE_CAPACITY) {
+    message[messageLength++] = *text++;
+  }
+  message[messageLength] = '\0';
+}
+
+/**
+ * @brief Appends a single character to the message buffer.
+ * 
+ * @param c The character to append.
+ */
+void appendToMessage(char c) {
+  if (messageLength < MESSAGE_CAPACITY) {
+    message[messageLength++] = c;
+  }
+  message[messageLength] = '\0';
+}
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE checksum of a block of data.
+ * 
+ * Uses the polynomial 0x1021 with an initial value of 0xFFFF, the same variant the client computes.
+ * 
+ * @param data The data to checksum.
+ * @param length The number of bytes in data.
+ * @return The 16-bit checksum.
+ */
+uint16_t crc16(const uint8_t* data, uint8_t length) {
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Decodes a block of COBS-encoded data in place.
+ * 
+ * @param data The encoded data without the zero delimiter; receives the decoded data.
+ * @param length The number of bytes in data.
+ * @return The number of decoded bytes, or 0 if the input is malformed.
+ */
+uint8_t cobsDecode(uint8_t* data, uint8_t length) {
+  uint8_t readIndex = 0;
+  uint8_t writeIndex = 0;
+  while (readIndex < length) {
+    uint8_t code = data[readIndex];
+    if (code == 0 || readIndex + code > length) {
+      return 0;
+    }
+    readIndex++;
+    for (uint8_t i = 1; i < code; i++) {
+      data[writeIndex++] = data[readIndex++];
+    }
+    if (code != 0xFF && readIndex != length) {
+      data[writeIndex++] = 0;
+    }
+  }
+  return writeIndex;
+}
+
+/**
+ * @brief Writes a single COBS-encoded frame to the serial output.
+ * 
+ * The frame is encoded on the fly: each run of non-zero bytes is written after its code byte,
+ * so no second buffer is needed. Frames are shorter than 254 bytes, so a run never needs splitting.
+ * 
+ * @param type The frame type (FRAME_DATA, FRAME_ACK or FRAME_NAK).
+ * @param seq The message sequence number.
+ * @param index The fragment index.
+ * @param count The number of fragments in the message.
+ * @param payload The fragment payload (may be NULL if payloadLength is 0).
+ * @param payloadLength The number of payload bytes.
+ */
+void writeFrame(uint8_t type, uint8_t seq, uint8_t index, uint8_t count, const uint8_t* payload, uint8_t payloadLength) {
+  uint8_t raw[FRAME_MAX_SIZE];
+  raw[0] = type;
+  raw[1] = seq;
+  raw[2] = index;
+  raw[3] = count;
+  for (uint8_t i = 0; i < payloadLength; i++) {
+    raw[FRAME_HEADER_SIZE + i] = payload[i];
+  }
+  uint8_t rawLength = FRAME_HEADER_SIZE + payloadLength;
+  uint16_t crc = crc16(raw, rawLength);
+  raw[rawLength++] = crc >> 8;
+  raw[rawLength++] = crc & 0xFF;
+  uint8_t runStart = 0;
+  for (uint8_t i = 0; i <= rawLength; i++) {
+    if (i == rawLength || raw[i] == 0) {
+      Serial.write((uint8_t)(i - runStart + 1));
+      Serial.write(raw + runStart, i - runStart);
+      runStart = i + 1;
+    }
+  }
+  Serial.write((uint8_t)0);
+}
+
+/**
+ * @brief Reads available serial input and decodes a frame once its delimiter arrives.
+ * 
+ * On success the frame fields are stored in frameType, frameSeq, frameIndex, frameCount and framePayload.
+ * 
+ * @return 1 if a valid frame was decoded, -1 if a corrupted frame was received, 0 if no frame is complete yet.
+ */
+int pollFrame() {
+  while (Serial.available() > 0) {
+    uint8_t value = Serial.read();
+    if (value != 0) {
+      if (rxFrameLength < FRAME_MAX_ENCODED_SIZE) {
+        rxFrame[rxFrameLength++] = value;
+      } else {
+        rxFrameOverflow = true;
       }
+      continue;
+    }
+    uint8_t length = rxFrameLength;
+    bool overflow = rxFrameOverflow;
+    rxFrameLength = 0;
+    rxFrameOverflow = false;
+    if (length == 0 && !overflow) {
+      continue;
+    }
+    if (overflow) {
+      return -1;
+    }
+    length = cobsDecode(rxFrame, length);
+    if (length < FRAME_HEADER_SIZE + FRAME_CRC_SIZE || length > FRAME_MAX_SIZE) {
+      return -1;
+    }
+    length -= FRAME_CRC_SIZE;
+    uint16_t expected = ((uint16_t)rxFrame[length] << 8) | rxFrame[length + 1];
+    if (crc16(rxFrame, length) != expected) {
+      return -1;
     }
+    frameType = rxFrame[0];
+    frameSeq = rxFrame[1];
+    frameIndex = rxFrame[2];
+    frameCount = rxFrame[3];
+    framePayloadLength = length - FRAME_HEADER_SIZE;
+    memcpy(framePayload, rxFrame + FRAME_HEADER_SIZE, framePayloadLength);
+    return 1;
   }
-  
-  // Block opponent from winning
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      if (board[i][j] == '_') {
-        char playerSymbol = (aiSymbol == 'X') ? 'X' : 'O';
-        board[i][j] = playerSymbol;
-        if (checkWin(board, playerSymbol)) {
-          board[i][j] = aiSymbol;
+  return 0;
+}
+
+/**
+ * @brief Waits for the next frame until the timeout expires.
+ * 
+ * @param timeoutMs The maximum time to wait in milliseconds.
+ * @return 1 if a valid frame was decoded, -1 if a corrupted frame was received, 0 on timeout.
+ */
+int waitForFrame(unsigned long timeoutMs) {
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs) {
+    int result = pollFrame();
+    if (result != 0) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Sends the response held in the message buffer.
+ * 
+ * The response is split into fragments carrying the sequence number of the request. Each fragment
+ * is retransmitted on a NAK or when no ACK arrives within ACK_TIMEOUT_MS. A data frame with a new
+ * sequence number, a baud rate request or a test pattern means the client has moved on, so sending
+ * stops and the frame is left pending for loop() to dispatch. Stale ACKs and repeated fragments of
+ * the request are skipped.
+ */
+void sendResponse() {
+  uint8_t count = (messageLength + FRAME_PAYLOAD_SIZE - 1) / FRAME_PAYLOAD_SIZE;
+  if (count == 0) {
+    count = 1;
+  }
+  for (uint8_t index = 0; index < count; index++) {
+    int offset = index * FRAME_PAYLOAD_SIZE;
+    uint8_t length = min(messageLength - offset, (int)FRAME_PAYLOAD_SIZE);
+    bool acknowledged = false;
+    for (uint8_t attempt = 0; attempt < MAX_RETRIES && !acknowledged; attempt++) {
+      writeFrame(FRAME_DATA, rxSeq, index, count, (const uint8_t*)message + offset, length);
+      int result;
+      while ((result = waitForFrame(ACK_TIMEOUT_MS)) == 1) {
+        if (frameType == FRAME_ACK && frameSeq == rxSeq && frameIndex == index) {
+          acknowledged = true;
+          break;
+        }
+        if (frameType == FRAME_NAK) {
+          break;
+        }
+        if (frameType != FRAME_ACK && (frameType != FRAME_DATA || frameSeq != rxSeq)) {
+          framePending = true;
           return;
         }
-        board[i][j] = '_';
       }
     }
+    if (!acknowledged) {
+      return;
+    }
   }
-  
-  // Select the best move based on predefined weights
-  int weights[3][3] = {
-    { 3, 1, 3 },
-    { 1, 5, 1 },
-    { 3, 1, 3 }
-  };
-  int bestRow = -1, bestCol = -1;
-  int maxWeight = -1;
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      if (board[i][j] == '_' && weights[i][j] > maxWeight) {
-        maxWeight = weights[i][j];
-        bestRow = i;
-        bestCol = j;
-      }
+}
+
+/**
+ * @brief Handles a received data frame.
+ * 
+ * In-order fragments are appended to the message buffer and acknowledged; duplicates are
+ * acknowledged again and anything else is answered with a NAK. Once the last fragment of a
+ * request arrives the request is processed and the response is sent. If the last fragment is
+ * received again after processing (its ACK was lost), the stored response is resent as is.
+ */
+void handleDataFrame() {
+  if (frameSeq == rxSeq && frameIndex < rxNext) {
+    writeFrame(FRAME_ACK, frameSeq, frameIndex, 0, NULL, 0);
+    if (responseReady && frameIndex + 1 == rxCount) {
+      sendResponse();
     }
+    return;
+  }
+  if (frameIndex == 0) {
+    rxSeq = frameSeq;
+    rxCount = frameCount;
+    rxNext = 0;
+    messageLength = 0;
+    responseReady = false;
   }
-  if (bestRow != -1 && bestCol != -1) {
-    board[bestRow][bestCol] = aiSymbol;
+  if (frameSeq != rxSeq || frameIndex != rxNext || frameCount != rxCount ||
+      messageLength + framePayloadLength > MESSAGE_CAPACITY) {
+    writeFrame(FRAME_NAK, frameSeq, rxNext, rxCount, NULL, 0);
+    return;
+  }
+  memcpy(message + messageLength, framePayload, framePayloadLength);
+  messageLength += framePayloadLength;
+  rxNext++;
+  writeFrame(FRAME_ACK, frameSeq, frameIndex, 0, NULL, 0);
+  if (rxNext == rxCount) {
+    message[messageLength] = '\0';
+    processRequest();
+    responseReady = true;
+    sendResponse();
   }
 }
 
 /**
- * @brief Updates the game status based on the current board state.
+ * @brief Plays a complete AI vs AI game and appends its compact record to the message buffer.
  * 
- * Determines whether the game is still ongoing, or if there's a winner or a draw.
+ * Both sides play random moves, as in the "AI vs AI" mode. The record is one header byte
+ * (status code in bits 7-6, first player in bit 4 with 1 for 'O', move count in bits 3-0)
+ * followed by the cell indices of the moves packed two per byte, high nibble first.
  * 
- * @param board The game board (3x3 array).
- * @param status The current game status (Win X, Win O, Draw, NextMove).
+ * @param firstPlayer The player who moves first ('X' or 'O').
  */
-void updateGameStateStatus(char board[3][3], char* status) {
-  if (checkWin('X', board)) {
-    strcpy(status, "Win X");
-  } else if (checkWin('O', board)) {
-    strcpy(status, "Win O");
-  } else if (checkDraw(board)) {
-    strcpy(status, "Draw");
-  } else {
-    strcpy(status, "NextMove");
+void playGame(char firstPlayer) {
+  CoreState state = { 0, 0, firstPlayer, GameMode::AIVsAI, GameStatus::NextMove };
+  uint8_t moves[9];
+  uint8_t moveCount = 0;
+  while (state.status == GameStatus::NextMove) {
+    moves[moveCount] = randomMove(state);
+    playCell(state, moves[moveCount++]);
+    state.player = otherPlayer(state.player);
+    state.status = evaluateBoard(state);
+  }
+  appendToMessage((char)(((uint8_t)state.status << 6) | ((firstPlayer == 'O') ? 0x10 : 0) | moveCount));
+  for (uint8_t i = 0; i < moveCount; i += 2) {
+    uint8_t low = (i + 1 < moveCount) ? moves[i + 1] : 0;
+    appendToMessage((char)((moves[i] << 4) | low));
   }
 }
 
 /**
- * @brief Extracts text between specified XML tags.
+ * @brief Handles a MSG_PLAY_GAMES request.
  * 
- * Extracts the value enclosed between <tag> and </tag> in the provided XML string.
- * 
- * @param xml The XML string.
- * @param tag The tag name (e.g., "Player").
- * @param output The buffer to store the extracted text.
- * @param outputSize The size of the output buffer.
+ * The request is [MSG_PLAY_GAMES][first player][number of games]. The server plays all games
+ * itself and responds with [MSG_PLAY_GAMES][number of games] followed by one compact record
+ * per game, replacing a round-trip per move with a single exchange.
  */
-void extractTextBetweenTags(const char* xml, const char* tag, char* output, int outputSize) {
-  char openTag[20];
-  char closeTag[20];
-  snprintf(openTag, sizeof(openTag), "<%s>", tag);
-  snprintf(closeTag, sizeof(closeTag), "</%s>", tag);
-  const char* startPos = strstr(xml, openTag);
-  if (!startPos) {
-    output[0] = '\0';
+void playGames() {
+  char firstPlayer = message[1];
+  uint8_t count = (uint8_t)message[2];
+  messageLength = 0;
+  if ((firstPlayer != 'X' && firstPlayer != 'O') || count == 0 || count > PLAY_GAMES_MAX) {
+    appendToMessage("Error: invalid game request.");
     return;
   }
-  startPos += strlen(openTag);
-  const char* endPos = strstr(startPos, closeTag);
-  if (!endPos) {
-    output[0] = '\0';
-    return;
+  appendToMessage((char)MSG_PLAY_GAMES);
+  appendToMessage((char)count);
+  for (uint8_t i = 0; i < count; i++) {
+    playGame(firstPlayer);
   }
-  int length = endPos - startPos;
-  if (length >= outputSize) length = outputSize - 1;
-  strncpy(output, startPos, length);
-  output[length] = '\0';
 }
 
 /**
- * @brief Extracts the game board from the provided XML data.
- * 
- * Extracts a 3x3 game board from the XML string.
- * 
- * @param xml The XML string.
- * @param board The game board (3x3 array) to populate.
- */
-void extractBoard(const char* xml, char board[3][3]) {
-  const char* boardStart = strstr(xml, "<Board>");
-  if (!boardStart) return;
-  int row = 0;
-  const char* rowPos = boardStart;
-  while (row < 3 && (rowPos = strstr(rowPos, "<Row>"))) {
-    int col = 0;
-    const char* cellPos = rowPos;
-    while (col < 3 && (cellPos = strstr(cellPos, "<Cell>"))) {
-      cellPos += 6;
-      const char* cellEnd = strstr(cellPos, "</Cell>");
-      if (!cellEnd) return;
-      board[row][col] = *cellPos;
-      col++;
-      cellPos = cellEnd;
+ * @brief Handles a MSG_EVAL_BATCH request.
+ * 
+ * The request is [MSG_EVAL_BATCH][number of positions] followed by 3 bytes per position: a 24-bit
+ * big-endian value holding 2 bits per cell (cell i in bits 2i+1..2i; 0 empty, 1 'X', 2 'O') and the
+ * side to move in bit 18 (1 for 'O'). The response is [MSG_EVAL_BATCH][number of positions] followed
+ * by one byte per position: the status code in bits 7-6 and, if the game is not over, the cell the AI
+ * would play for the side to move in bits 3-0 (NO_MOVE otherwise).
+ * The response never exceeds the request in size, so it is written over the request in place.
+ */
+void evaluateBatch() {
+  uint8_t count = (uint8_t)message[1];
+  if (count == 0 || count > EVAL_BATCH_MAX || messageLength != 2 + count * 3) {
+    messageLength = 0;
+    appendToMessage("Error: invalid evaluation request.");
+    return;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t* packed = (const uint8_t*)message + 2 + i * 3;
+    unsigned long value = ((unsigned long)packed[0] << 16) | ((unsigned long)packed[1] << 8) | packed[2];
+    CoreState state = { 0, 0, (value & 0x40000UL) ? 'O' : 'X', GameMode::AIVsAI, GameStatus::NextMove };
+    for (uint8_t cell = 0; cell < 9; cell++) {
+      uint8_t code = (value >> (cell * 2)) & 0x03;
+      setCellSymbol(state, cell, (code == 1) ? 'X' : (code == 2) ? 'O' : '_');
+    }
+    state.status = evaluateBoard(state);
+    uint8_t move = NO_MOVE;
+    if (state.status == GameStatus::NextMove) {
+      move = weightedMove(state, state.player);
     }
-    row++;
-    rowPos = strstr(rowPos, "</Row>");
+    message[2 + i] = (char)(((uint8_t)state.status << 6) | move);
   }
+  messageLength = 2 + count;
+  message[messageLength] = '\0';
 }
 
 /**
- * @brief Reads the XML game data and updates the game logic.
+ * @brief Processes the complete request in the message buffer and leaves the response in its place.
+ */
+void processRequest() {
+  if ((uint8_t)message[0] == MSG_PLAY_GAMES && messageLength == 3) {
+    playGames();
+  } else if ((uint8_t)message[0] == MSG_EVAL_BATCH && messageLength >= 2) {
+    evaluateBatch();
+  } else {
+    readAndUpdateGameLogic(message);
+  }
+}
+
+/**
+ * @brief Switches the serial port to a new baud rate.
  * 
- * This function parses the XML data, updates the game state, and makes AI moves when needed.
+ * Waits for pending output to be sent first and discards any partially received frame.
  * 
- * @param xmlData The game data in XML format.
+ * @param rate The new baud rate.
  */
-void readAndUpdateGameLogic(const String& xmlData) {
-  char player[2];
-  char gameType[20];
-  char status[10];
-  char board[3][3];
-  const char* xmlCString = xmlData.c_str();
-  extractTextBetweenTags(xmlCString, "Player", player, sizeof(player));
-  extractTextBetweenTags(xmlCString, "GameType", gameType, sizeof(gameType));
-  extractTextBetweenTags(xmlCString, "Status", status, sizeof(status));
-  extractBoard(xmlCString, board);
-  if (strcmp(gameType, "Man vs Man") == 0 && (strcmp(status, "Start") == 0 || strcmp(status, "NextMove") == 0)) {
-    player[0] = (player[0] == 'X') ? 'O' : 'X';
-    updateGameStateStatus(board, status);
-  }
-  if (strcmp(gameType, "AI vs Man") == 0 && (strcmp(status, "Start") == 0 || strcmp(status, "NextMove") == 0)) {
-    if (strcmp(status, "Start") != 0)
-      player[0] = (player[0] == 'X') ? 'O' : 'X';
-    updateGameStateStatus(board, status);
-    if (strcmp(status, "Win X") != 0 && strcmp(status, "Win O") != 0 && strcmp(status, "Draw") != 0) {
-      aiMoveWithDynamicWeights(player[0], board);
-      player[0] = (player[0] == 'X') ? 'O' : 'X';
-      updateGameStateStatus(board, status);
-    }
+void switchBaudRate(unsigned long rate) {
+  Serial.flush();
+  Serial.end();
+  Serial.begin(rate);
+  currentBaudRate = rate;
+  rxFrameLength = 0;
+  rxFrameOverflow = false;
+  consecutiveErrors = 0;
+  lastValidFrameMs = millis();
+}
+
+/**
+ * @brief Handles a baud rate request.
+ * 
+ * A request for a different supported rate is acknowledged at the current rate, after which
+ * the server switches and puts the new rate on probation. A request for the current rate
+ * confirms it and ends the probation. Unsupported rates are answered with a NAK.
+ */
+void handleBaudFrame() {
+  if (framePayloadLength != 4) {
+    writeFrame(FRAME_NAK, frameSeq, frameIndex, frameCount, NULL, 0);
+    return;
   }
-  if (strcmp(gameType, "Man vs AI") == 0 && (strcmp(status, "Start") == 0 || strcmp(status, "NextMove") == 0)) {
-    updateGameStateStatus(board, status);
-    if (strcmp(status, "Win X") != 0 && strcmp(status, "Win O") != 0 && strcmp(status, "Draw") != 0) {
-      player[0] = (player[0] == 'X') ? 'O' : 'X';
-      aiMoveWithDynamicWeights(player[0], board);
-      player[0] = (player[0] == 'X') ? 'O' : 'X';
-      updateGameStateStatus(board, status);
+  unsigned long rate = ((unsigned long)framePayload[0] << 24) | ((unsigned long)framePayload[1] << 16) |
+                       ((unsigned long)framePayload[2] << 8) | framePayload[3];
+  bool supported = false;
+  for (uint8_t i = 0; i < sizeof(SUPPORTED_BAUD_RATES) / sizeof(SUPPORTED_BAUD_RATES[0]); i++) {
+    if (SUPPORTED_BAUD_RATES[i] == rate) {
+      supported = true;
     }
   }
-  if (strcmp(gameType, "AI vs AI") == 0 && (strcmp(status, "Start") == 0 || strcmp(status, "NextMove") == 0)) {
-    updateGameStateStatus(board, status);
-    if (strcmp(status, "Win X") != 0 && strcmp(status, "Win O") != 0 && strcmp(status, "Draw") != 0) {
-      for (int i = 0; i < 9; i++) {
-        if (strcmp(status, "Win X") != 0 && strcmp(status, "Win O") != 0 && strcmp(status, "Draw") != 0) {
-          aiMove(player[0], board);
-          player[0] = (player[0] == 'X') ? 'O' : 'X';
-          updateGameStateStatus(board, status);
-        }
-      }
-    }
+  if (!supported) {
+    writeFrame(FRAME_NAK, frameSeq, frameIndex, frameCount, NULL, 0);
+    return;
+  }
+  writeFrame(FRAME_ACK, frameSeq, frameIndex, 0, NULL, 0);
+  if (rate == currentBaudRate) {
+    baudOnProbation = false;
+    return;
   }
-  exportGameStateXML(player, gameType, status, board);
+  switchBaudRate(rate);
+  baudOnProbation = (rate != BASE_BAUD_RATE);
 }
 
 /**
- * @brief Exports the game state to XML format.
+ * @brief Dispatches the last decoded frame by its type.
  * 
- * Converts the current game state (player, game type, status, and board) to XML format
- * and sends it to the serial output.
- * 
- * @param player The current player ('X' or 'O').
- * @param gameType The type of game (e.g., "Man vs Man", "AI vs Man").
- * @param status The current game status (e.g., "NextMove", "Win X", "Draw").
- * @param board The current game board (3x3 array).
- */
-void exportGameStateXML(const char* player, const char* gameType, const char* status, char board[3][3]) {
-  Serial.print("<?xml version=\"1.0\" encoding=\"utf-8\"?>");
-  Serial.print("<GameState>");
-  Serial.print("<Player>");
-  Serial.print(player);
-  Serial.print("</Player>");
-  Serial.print("<GameType>");
-  Serial.print(gameType);
-  Serial.print("</GameType>");
-  Serial.print("<Board>");
-  for (int i = 0; i < 3; i++) {
-    Serial.print("<Row>");
-    for (int j = 0; j < 3; j++) {
-      Serial.print("<Cell>");
-      Serial.print(board[i][j]);
-      Serial.print("</Cell>");
-    }
-    Serial.print("</Row>");
+ * Data frames go to handleDataFrame(), baud rate requests to handleBaudFrame() and test patterns
+ * are echoed back. ACK and NAK frames outside of sendResponse() are ignored.
+ */
+void dispatchFrame() {
+  consecutiveErrors = 0;
+  lastValidFrameMs = millis();
+  if (frameType == FRAME_DATA) {
+    handleDataFrame();
+  } else if (frameType == FRAME_BAUD) {
+    handleBaudFrame();
+  } else if (frameType == FRAME_TEST) {
+    writeFrame(FRAME_TEST, frameSeq, frameIndex, frameCount, framePayload, framePayloadLength);
   }
-  Serial.print("</Board>");
-  Serial.print("<Status>");
-  Serial.print(status);
-  Serial.print("</Status>");
-  Serial.print("</GameState>");
 }
 
 /**
  * @brief Initializes the game and serial communication.
  * 
- * Initializes the serial communication and sets the random seed based on analog input.
+ * Initializes the serial communication at the base rate and sets the random seed based on analog input.
  */
 void setup() {
-  Serial.begin(9600);
+  Serial.begin(BASE_BAUD_RATE);
   randomSeed(analogRead(0));
 }
 
 /**
  * @brief Main game loop.
  * 
- * Continuously checks for incoming data, reads and processes the XML data, updates
- * the game state, and exports the updated game state back to the serial output.
+ * Continuously polls the serial input for frames. Corrupted frames are answered with a NAK,
+ * data frames are assembled into a request which is processed once complete, and the updated
+ * game state is sent back as a framed response. Baud rate requests and test patterns used for
+ * rate negotiation are handled here too, as is the fallback to the base rate.
  */
 void loop() {
-  if (Serial.available() > 0) {
-    String xmlData = Serial.readStringUntil('\r\n');
-    if (xmlData.indexOf("</GameState>") != -1) {
-      readAndUpdateGameLogic(xmlData);
-      Serial.println();
-    } else {
-      Serial.println("Error: </GameState> not found.");
+  if (framePending) {
+    framePending = false;
+    dispatchFrame();
+    return;
+  }
+  int result = pollFrame();
+  if (result < 0) {
+    writeFrame(FRAME_NAK, rxSeq, rxNext, rxCount, NULL, 0);
+    if (currentBaudRate != BASE_BAUD_RATE && ++consecutiveErrors >= BAUD_ERROR_LIMIT) {
+      switchBaudRate(BASE_BAUD_RATE);
+      baudOnProbation = false;
     }
+  } else if (result > 0) {
+    dispatchFrame();
+  } else if (baudOnProbation && millis() - lastValidFrameMs > BAUD_PROBATION_MS) {
+    switchBaudRate(BASE_BAUD_RATE);
+    baudOnProbation = false;
   }
 }
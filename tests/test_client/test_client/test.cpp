@@ -0,0 +1,1977 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include "GameArchive.h"
+#include "GameJournal.h"
+#include "GameLogic.h"
+#include "GameStateBinder.h"
+#include "GameStateDocument.h"
+#include "GameStateParser.h"
+#include "GameStats.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static atomic<size_t> allocationCount(0);
+static atomic<size_t> allocatedBytes(0);
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    allocatedBytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+string makeStateXml(char player, GameMode gameType, Board board, GameStatus status) {
+    string xml;
+    serializeGameState(xml, player, gameType, board, status);
+    return xml;
+}
+
+TEST(ClientTest, TestMakeMove) {
+    Board board = emptyBoard();
+    EXPECT_TRUE(makeMove(board, 1, 'X'));
+    EXPECT_EQ(board.at(0, 0), 'X');
+    EXPECT_FALSE(makeMove(board, 1, 'O'));
+    EXPECT_FALSE(makeMove(board, 0, 'O'));
+    EXPECT_FALSE(makeMove(board, 10, 'O'));
+    EXPECT_TRUE(makeMove(board, 9, 'O'));
+    EXPECT_EQ(board[8], 'O');
+}
+
+TEST(ClientTest, TestSerializeParseRoundTrip) {
+    Board board = emptyBoard();
+    board[0] = 'X';
+    board[4] = 'O';
+    string xml = makeStateXml('X', GameMode::ManVsAI, board, GameStatus::NextMove);
+
+    char player = 0;
+    GameMode gameMode;
+    Board parsed = emptyBoard();
+    GameStatus status;
+    ASSERT_TRUE(parseGameState(xml, player, gameMode, parsed, status));
+    EXPECT_EQ(player, 'X');
+    EXPECT_EQ(gameMode, GameMode::ManVsAI);
+    EXPECT_EQ(parsed.cells, board.cells);
+    EXPECT_EQ(status, GameStatus::NextMove);
+}
+
+TEST(ClientTest, TestRetainedDocumentDoesNotAllocate) {
+    tinyxml2::XMLDocument doc;
+    doc.SetRetainMemory(true);
+    string xml = makeStateXml('O', GameMode::ManVsMan, emptyBoard(), GameStatus::NextMove);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+
+    size_t before = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+        ASSERT_NE(doc.FirstChildElement("GameState"), nullptr);
+    }
+    EXPECT_EQ(allocationCount, before);
+}
+
+TEST(ClientTest, TestParseGameStateDoesNotAllocate) {
+    Board board = emptyBoard();
+    board[2] = 'X';
+    string xml = makeStateXml('O', GameMode::ManVsAI, board, GameStatus::NextMove);
+    char player;
+    GameMode gameMode;
+    Board parsed;
+    GameStatus status;
+    ASSERT_TRUE(parseGameState(xml, player, gameMode, parsed, status));
+
+    size_t before = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(parseGameState(xml, player, gameMode, parsed, status));
+    }
+    EXPECT_EQ(allocationCount, before);
+    EXPECT_EQ(parsed[2], 'X');
+}
+
+TEST(ClientTest, TestRetainedDocumentReparsesAfterError) {
+    tinyxml2::XMLDocument doc;
+    doc.SetRetainMemory(true);
+    string xml = makeStateXml('X', GameMode::AIVsAI, emptyBoard(), GameStatus::WinX);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+
+    string broken = xml.substr(0, xml.size() / 2);
+    EXPECT_NE(doc.Parse(broken.data(), broken.size()), XML_SUCCESS);
+    EXPECT_EQ(doc.FirstChildElement("GameState"), nullptr);
+
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    const XMLElement* status = doc.FirstChildElement("GameState")->FirstChildElement("Status");
+    ASSERT_NE(status, nullptr);
+    EXPECT_STREQ(status->GetText(), "Win X");
+}
+
+TEST(ClientTest, TestClearReleasesMemoryByDefault) {
+    tinyxml2::XMLDocument doc;
+    EXPECT_FALSE(doc.RetainsMemory());
+    string xml = makeStateXml('X', GameMode::ManVsMan, emptyBoard(), GameStatus::NextMove);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    doc.Clear();
+    EXPECT_EQ(doc.FirstChild(), nullptr);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    EXPECT_NE(doc.FirstChildElement("GameState"), nullptr);
+}
+
+TEST(ClientTest, TestParseInSituBorrowsBuffer) {
+    Board board = emptyBoard();
+    board[4] = 'X';
+    string xml = makeStateXml('O', GameMode::ManVsAI, board, GameStatus::NextMove);
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.ParseInSitu(&xml[0], xml.size()), XML_SUCCESS);
+    const char* status = doc.FirstChildElement("GameState")->FirstChildElement("Status")->GetText();
+    EXPECT_STREQ(status, "NextMove");
+    EXPECT_GE(status, xml.data());
+    EXPECT_LT(status, xml.data() + xml.size());
+
+    string empty;
+    EXPECT_EQ(doc.ParseInSitu(&empty[0], empty.size()), XML_ERROR_EMPTY_DOCUMENT);
+}
+
+TEST(ClientTest, TestParseGameStateInSituDoesNotAllocate) {
+    Board board = emptyBoard();
+    board[6] = 'O';
+    const string reply = makeStateXml('X', GameMode::AIVsMan, board, GameStatus::NextMove);
+    string buffer;
+    buffer.reserve(reply.size());
+    char player;
+    GameMode gameMode;
+    Board parsed;
+    GameStatus status;
+    buffer.assign(reply);
+    ASSERT_EQ(parseGameStateInSitu(buffer, player, gameMode, parsed, status), XML_SUCCESS);
+
+    size_t before = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        buffer.assign(reply);
+        ASSERT_EQ(parseGameStateInSitu(buffer, player, gameMode, parsed, status), XML_SUCCESS);
+    }
+    EXPECT_EQ(allocationCount, before);
+    EXPECT_EQ(player, 'X');
+    EXPECT_EQ(gameMode, GameMode::AIVsMan);
+    EXPECT_EQ(parsed.cells, board.cells);
+}
+
+TEST(ClientTest, TestParseGameStateInSituReadsRepliesTheBinderRejects) {
+    string reply = "<GameState version=\"1\"><!-- reply --><Player>O</Player><GameType>Man vs AI</GameType><Board>"
+        "<Row><Cell>X</Cell><Cell>_</Cell><Cell>_</Cell></Row>"
+        "<Row><Cell>_</Cell><Cell>O</Cell><Cell>_</Cell></Row>"
+        "<Row><Cell>_</Cell><Cell>_</Cell><Cell>X</Cell></Row>"
+        "</Board><Status>NextMove</Status></GameState>";
+    char player = 0;
+    GameMode gameMode;
+    Board parsed = emptyBoard();
+    GameStatus status;
+    EXPECT_FALSE(parseGameState(reply, player, gameMode, parsed, status));
+    ASSERT_EQ(parseGameStateInSitu(reply, player, gameMode, parsed, status), XML_SUCCESS);
+    EXPECT_EQ(player, 'O');
+    EXPECT_EQ(gameMode, GameMode::ManVsAI);
+    EXPECT_EQ(parsed[0], 'X');
+    EXPECT_EQ(parsed[4], 'O');
+    EXPECT_EQ(parsed[8], 'X');
+    EXPECT_EQ(status, GameStatus::NextMove);
+
+    string malformed = "<GameState><Player>O</Player>";
+    EXPECT_FALSE(parseGameState(malformed, player, gameMode, parsed, status));
+    EXPECT_NE(parseGameStateInSitu(malformed, player, gameMode, parsed, status), XML_SUCCESS);
+
+    string foreign = "<Reply><Player>O</Player></Reply>";
+    EXPECT_EQ(parseGameStateInSitu(foreign, player, gameMode, parsed, status), XML_ERROR_PARSING_ELEMENT);
+}
+
+TEST(ClientTest, TestBindGameState) {
+    Board board = emptyBoard();
+    board[0] = 'X';
+    board[8] = 'O';
+    string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" + makeStateXml('O', GameMode::AIVsMan, board, GameStatus::WinO) + "\n";
+    GameState state;
+    BindError error;
+    ASSERT_TRUE(bindGameState(xml.data(), xml.size(), state, error));
+    EXPECT_EQ(state.player, 'O');
+    EXPECT_EQ(state.gameMode, GameMode::AIVsMan);
+    EXPECT_EQ(state.board.cells, board.cells);
+    EXPECT_EQ(state.status, GameStatus::WinO);
+}
+
+TEST(ClientTest, TestBindGameStateRejectsSchemaViolations) {
+    const string xml = makeStateXml('X', GameMode::ManVsMan, emptyBoard(), GameStatus::NextMove);
+    GameState state;
+    BindError error;
+
+    string badValue = xml;
+    size_t player = badValue.find("<Player>X") + 8;
+    badValue[player] = 'Z';
+    EXPECT_FALSE(bindGameState(badValue.data(), badValue.size(), state, error));
+    EXPECT_EQ(error.offset, player);
+    EXPECT_STREQ(error.expected, "a valid value");
+
+    string reordered = xml;
+    size_t status = reordered.find("<Status>");
+    reordered.replace(status, 1, "<Stat");
+    EXPECT_FALSE(bindGameState(reordered.data(), reordered.size(), state, error));
+    EXPECT_EQ(error.offset, status);
+    EXPECT_STREQ(error.expected, "<Status>");
+
+    string trailing = xml + "<GameState/>";
+    EXPECT_FALSE(bindGameState(trailing.data(), trailing.size(), state, error));
+    EXPECT_EQ(error.offset, xml.size());
+    EXPECT_STREQ(error.expected, "end of document");
+
+    string truncated = xml.substr(0, xml.size() - 3);
+    EXPECT_FALSE(bindGameState(truncated.data(), truncated.size(), state, error));
+    EXPECT_STREQ(error.expected, "</GameState>");
+}
+
+TEST(ClientTest, TestBindGameStateDoesNotAllocate) {
+    const string xml = makeStateXml('O', GameMode::ManVsAI, emptyBoard(), GameStatus::NextMove);
+    GameState state;
+    BindError error;
+    size_t before = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(bindGameState(xml.data(), xml.size(), state, error));
+    }
+    EXPECT_EQ(allocationCount, before);
+}
+
+TEST(ClientTest, TestBindGameStateAgainstDom) {
+    Board board = emptyBoard();
+    board[1] = 'X';
+    board[3] = 'O';
+    const string xml = makeStateXml('X', GameMode::ManVsAI, board, GameStatus::NextMove);
+    char player;
+    GameMode gameMode;
+    Board parsed;
+    GameStatus status;
+    string buffer = xml;
+    ASSERT_EQ(parseGameStateInSitu(buffer, player, gameMode, parsed, status), XML_SUCCESS);
+
+    GameState state;
+    BindError error;
+    buffer = xml;
+    ASSERT_TRUE(bindGameState(buffer.data(), buffer.size(), state, error));
+    EXPECT_EQ(state.player, player);
+    EXPECT_EQ(state.gameMode, gameMode);
+    EXPECT_EQ(state.board.cells, parsed.cells);
+    EXPECT_EQ(state.status, status);
+}
+
+TEST(ClientBenchmark, DISABLED_BindGameState) {
+    Board board = emptyBoard();
+    board[1] = 'X';
+    board[3] = 'O';
+    const string xml = makeStateXml('X', GameMode::ManVsAI, board, GameStatus::NextMove);
+    const int rounds = 100000;
+    char player;
+    GameMode gameMode;
+    Board parsed;
+    GameStatus status;
+    string buffer;
+    buffer.reserve(xml.size());
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        buffer.assign(xml);
+        ASSERT_EQ(parseGameStateInSitu(buffer, player, gameMode, parsed, status), XML_SUCCESS);
+    }
+    auto domTime = chrono::steady_clock::now() - start;
+
+    GameState state;
+    BindError error;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        buffer.assign(xml);
+        ASSERT_TRUE(bindGameState(buffer.data(), buffer.size(), state, error));
+    }
+    auto bindTime = chrono::steady_clock::now() - start;
+
+    double dom = chrono::duration<double, micro>(domTime).count();
+    double bind = chrono::duration<double, micro>(bindTime).count();
+    cout << "Binding a game state: DOM " << dom / rounds << " us, binder " << bind / rounds << " us ("
+        << dom / bind << "x)" << endl;
+}
+
+string makeArchiveXml(int games) {
+    mt19937 rng(games);
+    XMLPrinter printer;
+    printer.PushHeader(false, true);
+    printer.OpenElement("GameArchive");
+    for (int game = 0; game < games; ++game) {
+        Board board = emptyBoard();
+        char player = (rng() % 2) ? 'X' : 'O';
+        int moves = 5 + rng() % 5;
+        for (int move = 0; move < moves; ++move) {
+            while (!makeMove(board, 1 + rng() % 9, player)) {
+            }
+            player = (player == 'X') ? 'O' : 'X';
+        }
+        printer.PushComment(("Game " + to_string(game)).c_str());
+        printer.OpenElement("GameState");
+        printer.PushAttribute("id", game);
+        printer.OpenElement("Player");
+        printer.PushText(string(1, player).c_str());
+        printer.CloseElement();
+        printer.OpenElement("GameType");
+        printer.PushText("Man vs AI & replay");
+        printer.CloseElement();
+        printer.OpenElement("Board");
+        for (int row = 0; row < 3; ++row) {
+            printer.OpenElement("Row");
+            for (int col = 0; col < 3; ++col) {
+                printer.OpenElement("Cell");
+                printer.PushText(string(1, board.at(row, col)).c_str());
+                printer.CloseElement();
+            }
+            printer.CloseElement();
+        }
+        printer.CloseElement();
+        printer.OpenElement("Status");
+        printer.PushText(gameStatusName(static_cast<GameStatus>(1 + rng() % 3)));
+        printer.CloseElement();
+        printer.CloseElement();
+    }
+    printer.CloseElement();
+    return string(printer.CStr());
+}
+
+string parseArchive(tinyxml2::XMLDocument& doc, const string& xml) {
+    EXPECT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLPrinter printer(nullptr, true);
+    doc.Print(&printer);
+    return printer.CStr();
+}
+
+TEST(ClientTest, TestScanKernelsOnGameArchive) {
+    string xml = makeArchiveXml(2000);
+    XMLScanKernel best = XMLUtil::ScanKernel();
+    tinyxml2::XMLDocument doc;
+    XMLUtil::SetScanKernel(XML_SCAN_SCALAR);
+    string expected = parseArchive(doc, xml);
+    // Every game spans 23 lines after the declaration and the archive element.
+    int lastLine = doc.RootElement()->LastChildElement("GameState")->GetLineNum();
+    EXPECT_EQ(lastLine, 4 + 23 * 1999);
+    for (int kernel = XML_SCAN_SSE2; kernel <= best; ++kernel) {
+        XMLUtil::SetScanKernel(static_cast<XMLScanKernel>(kernel));
+        EXPECT_EQ(parseArchive(doc, xml), expected);
+        EXPECT_EQ(doc.RootElement()->LastChildElement("GameState")->GetLineNum(), lastLine);
+    }
+    XMLUtil::SetScanKernel(best);
+}
+
+TEST(ClientTest, TestScanKernelsNormalizeNewlines) {
+    XMLScanKernel best = XMLUtil::ScanKernel();
+    for (int kernel = XML_SCAN_SCALAR; kernel <= best; ++kernel) {
+        XMLUtil::SetScanKernel(static_cast<XMLScanKernel>(kernel));
+        // The padding moves the carriage returns across the 16 and 32 byte blocks of the kernels.
+        for (size_t pad = 0; pad < 40; ++pad) {
+            string value = string(pad, 'v') + "1\r\n2\r3";
+            string text = string(pad, 't') + "a\r\nb\rc\nd\r";
+            string xml = "<Root><R v=\"" + value + "\">" + text + "</R>\n<S/></Root>";
+            tinyxml2::XMLDocument doc;
+            ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+            XMLElement* r = doc.RootElement()->FirstChildElement("R");
+            EXPECT_EQ(string(r->Attribute("v")), string(pad, 'v') + "1\n2\n3") << "kernel " << kernel << ", pad " << pad;
+            EXPECT_EQ(string(r->GetText()), string(pad, 't') + "a\nb\nc\nd\n") << "kernel " << kernel << ", pad " << pad;
+            // Only line feeds count as new lines, and a CR LF pair counts once.
+            EXPECT_EQ(doc.RootElement()->FirstChildElement("S")->GetLineNum(), 5) << "kernel " << kernel << ", pad " << pad;
+        }
+    }
+    XMLUtil::SetScanKernel(best);
+}
+
+TEST(ClientTest, TestScanKernelsCountLinesInValues) {
+    XMLScanKernel best = XMLUtil::ScanKernel();
+    for (int kernel = XML_SCAN_SCALAR; kernel <= best; ++kernel) {
+        XMLUtil::SetScanKernel(static_cast<XMLScanKernel>(kernel));
+        for (size_t pad = 0; pad < 40; ++pad) {
+            string xml = "<Root>\n" + string(pad, ' ') + "<A v=\"x\n\ny\">t\ne\nx\nt</A>" + string(pad, '\t')
+                + "\n<B w=\"\n1\"/>\n" + string(pad, ' ') + "<C/></Root>";
+            tinyxml2::XMLDocument doc;
+            ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+            XMLElement* root = doc.RootElement();
+            XMLElement* a = root->FirstChildElement("A");
+            XMLElement* b = root->FirstChildElement("B");
+            EXPECT_EQ(a->GetLineNum(), 2) << "kernel " << kernel << ", pad " << pad;
+            EXPECT_EQ(a->FindAttribute("v")->GetLineNum(), 2);
+            EXPECT_EQ(b->GetLineNum(), 8) << "kernel " << kernel << ", pad " << pad;
+            EXPECT_EQ(b->FindAttribute("w")->GetLineNum(), 8);
+            EXPECT_EQ(root->FirstChildElement("C")->GetLineNum(), 10) << "kernel " << kernel << ", pad " << pad;
+        }
+    }
+    XMLUtil::SetScanKernel(best);
+}
+
+TEST(ClientTest, TestScanKernelsStopAtBlockAndPageEnds) {
+    const size_t page = 4096;
+    alignas(4096) static char pages[3 * 4096];
+    const size_t ends[] = { 16, 32, page, 2 * page - 16 };
+    XMLScanKernel best = XMLUtil::ScanKernel();
+    for (int kernel = XML_SCAN_SCALAR; kernel <= best; ++kernel) {
+        XMLUtil::SetScanKernel(static_cast<XMLScanKernel>(kernel));
+        for (size_t end : ends) {
+            for (size_t length = 1; length <= 40 && length <= end; ++length) {
+                size_t start = end - length;
+                int newlines = 0;
+
+                // A whitespace run followed by a token at the end offset, then by one just before it.
+                memset(pages, 'x', sizeof(pages));
+                for (size_t i = start; i < end; ++i) {
+                    pages[i] = " \n\t\r"[i % 4];
+                    newlines += (pages[i] == '\n');
+                }
+                int line = 1;
+                EXPECT_EQ(XMLUtil::SkipWhiteSpaceRun(pages + start, &line), pages + end) << "kernel " << kernel << ", end " << end << ", length " << length;
+                EXPECT_EQ(line, 1 + newlines);
+                newlines -= (pages[end - 1] == '\n');
+                pages[end - 1] = 'x';
+                line = 1;
+                EXPECT_EQ(XMLUtil::SkipWhiteSpaceRun(pages + start, &line), pages + end - 1) << "kernel " << kernel << ", end " << end << ", length " << length;
+                EXPECT_EQ(line, 1 + newlines);
+
+                // Text stopped by the stop character, then by the null terminator, at the end offset.
+                newlines = 0;
+                for (size_t i = start; i < end; ++i) {
+                    pages[i] = "ab\nc"[i % 4];
+                    newlines += (pages[i] == '\n');
+                }
+                pages[end] = '<';
+                line = 1;
+                EXPECT_EQ(XMLUtil::FindTextStop(pages + start, '<', &line), pages + end) << "kernel " << kernel << ", end " << end << ", length " << length;
+                EXPECT_EQ(line, 1 + newlines);
+                pages[end] = 0;
+                line = 1;
+                EXPECT_EQ(XMLUtil::FindTextStop(pages + start, '<', &line), pages + end) << "kernel " << kernel << ", end " << end << ", length " << length;
+                EXPECT_EQ(line, 1 + newlines);
+            }
+        }
+    }
+    XMLUtil::SetScanKernel(best);
+}
+
+// The ClientBenchmark tests only measure and print; run them with
+// --gtest_also_run_disabled_tests --gtest_filter=ClientBenchmark.*
+TEST(ClientBenchmark, DISABLED_ScanKernels) {
+    string xml = makeArchiveXml(20000);
+    XMLScanKernel best = XMLUtil::ScanKernel();
+    const char* names[] = { "scalar", "SSE2", "AVX2" };
+    tinyxml2::XMLDocument doc;
+    doc.SetRetainMemory(true);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    cout << "Parsing " << xml.size() / 1024 << " KB of game archive XML:" << endl;
+    for (int kernel = XML_SCAN_SCALAR; kernel <= best; ++kernel) {
+        XMLUtil::SetScanKernel(static_cast<XMLScanKernel>(kernel));
+        auto start = chrono::steady_clock::now();
+        ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "  " << names[kernel] << ": " << static_cast<int>(xml.size() / elapsed / (1024.0 * 1024.0)) << " MB/s" << endl;
+    }
+    XMLUtil::SetScanKernel(best);
+}
+
+TEST(ClientBenchmark, DISABLED_ScanKernelThroughput) {
+    // The kernels alone, without node construction: a long whitespace run and a long text run.
+    const size_t size = 16 * 1024 * 1024;
+    const int rounds = 20;
+    string whitespace(size, ' ');
+    for (size_t i = 80; i < size; i += 81) {
+        whitespace[i] = '\n';
+    }
+    string text(size, 'x');
+    for (size_t i = 80; i < size; i += 81) {
+        text[i] = '\n';
+    }
+    XMLScanKernel best = XMLUtil::ScanKernel();
+    const char* names[] = { "scalar", "SSE2", "AVX2" };
+    cout << "Scanning " << size / (1024 * 1024) << " MB runs " << rounds << " times:" << endl;
+    for (int kernel = XML_SCAN_SCALAR; kernel <= best; ++kernel) {
+        XMLUtil::SetScanKernel(static_cast<XMLScanKernel>(kernel));
+        int line = 1;
+        auto start = chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            ASSERT_EQ(XMLUtil::SkipWhiteSpaceRun(whitespace.c_str(), &line), whitespace.c_str() + size);
+        }
+        double skipElapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            ASSERT_EQ(XMLUtil::FindTextStop(&text[0], '<', &line), &text[0] + size);
+        }
+        double textElapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double megabytes = static_cast<double>(size) * rounds / (1024.0 * 1024.0);
+        cout << "  " << names[kernel] << ": whitespace " << static_cast<int>(megabytes / skipElapsed) << " MB/s, text "
+             << static_cast<int>(megabytes / textElapsed) << " MB/s" << endl;
+    }
+    XMLUtil::SetScanKernel(best);
+}
+
+TEST(ClientTest, TestReaderEvents) {
+    const char* xml = "<?xml version=\"1.0\"?><GameState id=\"7\" mode='Man vs AI'><Player>X</Player>"
+        "<!-- note --><Board><Cell/></Board><Note>a &amp; b<![CDATA[<raw>]]></Note></GameState>";
+    XMLReader reader(xml, static_cast<size_t>(-1), true, 16);
+    ASSERT_EQ(reader.Next(), XML_READ_START_ELEMENT);
+    EXPECT_STREQ(reader.Name(), "GameState");
+    EXPECT_EQ(reader.AttributeCount(), 2);
+    EXPECT_STREQ(reader.Attribute("id"), "7");
+    EXPECT_STREQ(reader.Attribute("mode"), "Man vs AI");
+    ASSERT_EQ(reader.Next(), XML_READ_START_ELEMENT);
+    EXPECT_EQ(reader.Depth(), 1);
+    ASSERT_EQ(reader.Next(), XML_READ_TEXT);
+    EXPECT_STREQ(reader.Text(), "X");
+    ASSERT_EQ(reader.Next(), XML_READ_END_ELEMENT);
+    EXPECT_STREQ(reader.Name(), "Player");
+    ASSERT_EQ(reader.Next(), XML_READ_START_ELEMENT);
+    EXPECT_STREQ(reader.Name(), "Board");
+    ASSERT_EQ(reader.Next(), XML_READ_START_ELEMENT);
+    EXPECT_STREQ(reader.Name(), "Cell");
+    ASSERT_EQ(reader.Next(), XML_READ_END_ELEMENT);
+    EXPECT_STREQ(reader.Name(), "Cell");
+    ASSERT_EQ(reader.Next(), XML_READ_END_ELEMENT);
+    ASSERT_EQ(reader.Next(), XML_READ_START_ELEMENT);
+    ASSERT_EQ(reader.Next(), XML_READ_TEXT);
+    EXPECT_STREQ(reader.Text(), "a & b");
+    ASSERT_EQ(reader.Next(), XML_READ_TEXT);
+    EXPECT_TRUE(reader.CData());
+    EXPECT_STREQ(reader.Text(), "<raw>");
+    ASSERT_EQ(reader.Next(), XML_READ_END_ELEMENT);
+    ASSERT_EQ(reader.Next(), XML_READ_END_ELEMENT);
+    EXPECT_EQ(reader.Next(), XML_READ_END_DOCUMENT);
+    EXPECT_EQ(reader.Next(), XML_READ_END_DOCUMENT);
+}
+
+TEST(ClientTest, TestReaderReportsErrors) {
+    XMLReader mismatched("<GameState>\n<Board></Row></GameState>");
+    while (mismatched.Next() != XML_READ_ERROR) {
+        ASSERT_NE(mismatched.Event(), XML_READ_END_DOCUMENT);
+    }
+    EXPECT_EQ(mismatched.ErrorID(), XML_ERROR_MISMATCHED_ELEMENT);
+    EXPECT_EQ(mismatched.LineNum(), 2);
+
+    XMLReader truncated("<GameState><Player>X</Player>");
+    while (truncated.Next() != XML_READ_ERROR) {
+        ASSERT_NE(truncated.Event(), XML_READ_END_DOCUMENT);
+    }
+    EXPECT_EQ(truncated.ErrorID(), XML_ERROR_PARSING_ELEMENT);
+
+    XMLReader empty("  ");
+    EXPECT_EQ(empty.Next(), XML_READ_ERROR);
+    EXPECT_EQ(empty.ErrorID(), XML_ERROR_EMPTY_DOCUMENT);
+
+    const char* duplicate = "<GameState id=\"1\" mode=\"AI vs AI\" id=\"2\"/>";
+    tinyxml2::XMLDocument doc;
+    EXPECT_EQ(doc.Parse(duplicate), XML_ERROR_PARSING_ATTRIBUTE);
+    XMLReader repeated(duplicate);
+    EXPECT_EQ(repeated.Next(), XML_READ_ERROR);
+    EXPECT_EQ(repeated.ErrorID(), XML_ERROR_PARSING_ATTRIBUTE);
+}
+
+string randomXmlText(mt19937& rng, const char* const* pieces, size_t pieceCount) {
+    string text;
+    for (int i = rng() % 5; i >= 0; --i) {
+        text += pieces[rng() % pieceCount];
+    }
+    return text;
+}
+
+void appendRandomElement(mt19937& rng, int depth, string& xml) {
+    static const char* const names[] = { "GameState", "Board", "Row", "Cell", "x-1" };
+    static const char* const attributeNames[] = { "id", "mode", "v" };
+    static const char* const valuePieces[] = { "a", "Man vs AI", " ", "&amp;", "&lt;", "&#65;", "\n", "\r\n", "\t" };
+    static const char* const textPieces[] = { "X", "_", " ", "  ", "&amp;", "&gt;", "&#x4F;", "\n", "\r", "\r\n", "Draw" };
+    const char* name = names[rng() % 5];
+    xml += "<";
+    xml += name;
+    int attributes = rng() % 4;
+    for (int i = 0; i < attributes; ++i) {
+        char quote = (rng() % 2) ? '"' : '\'';
+        xml += string(1 + rng() % 2, (rng() % 3) ? ' ' : '\n');
+        xml += attributeNames[i];
+        xml += (rng() % 4) ? "=" : " = ";
+        xml += quote;
+        xml += randomXmlText(rng, valuePieces, 9);
+        xml += quote;
+    }
+    if (depth >= 4 || rng() % 5 == 0) {
+        xml += (rng() % 2) ? "/>" : " />";
+        return;
+    }
+    xml += ">";
+    for (int children = rng() % 5; children > 0; --children) {
+        switch (rng() % 6) {
+        case 0:
+            xml += randomXmlText(rng, textPieces, 11);
+            break;
+        case 1:
+            xml += "<![CDATA[" + randomXmlText(rng, textPieces, 11) + "<]]>";
+            break;
+        case 2:
+            xml += "<!--" + randomXmlText(rng, textPieces, 11) + "-->";
+            break;
+        case 3:
+            xml += string(1 + rng() % 3, (rng() % 2) ? ' ' : '\n');
+            break;
+        default:
+            appendRandomElement(rng, depth + 1, xml);
+            break;
+        }
+    }
+    xml += "</";
+    xml += name;
+    xml += ">";
+}
+
+void appendDomEvents(const XMLNode* node, string& events) {
+    for (const XMLNode* child = node->FirstChild(); child; child = child->NextSibling()) {
+        if (const XMLElement* element = child->ToElement()) {
+            events += "<" + string(element->Name());
+            for (const XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next()) {
+                events += " " + string(attribute->Name()) + "=[" + attribute->Value() + "]";
+            }
+            events += ">";
+            appendDomEvents(element, events);
+            events += "</" + string(element->Name()) + ">";
+        }
+        else if (const XMLText* text = child->ToText()) {
+            events += (text->CData() ? "C[" : "T[") + string(text->Value()) + "]";
+        }
+    }
+}
+
+XMLReadEvent readerEvents(XMLReader& reader, string& events) {
+    for (;;) {
+        XMLReadEvent event = reader.Next();
+        switch (event) {
+        case XML_READ_START_ELEMENT:
+            events += "<" + string(reader.Name());
+            for (int i = 0; i < reader.AttributeCount(); ++i) {
+                events += " " + string(reader.AttributeName(i)) + "=[" + reader.AttributeValue(i) + "]";
+            }
+            events += ">";
+            break;
+        case XML_READ_END_ELEMENT:
+            events += "</" + string(reader.Name()) + ">";
+            break;
+        case XML_READ_TEXT:
+            events += (reader.CData() ? "C[" : "T[") + string(reader.Text()) + "]";
+            break;
+        default:
+            return event;
+        }
+    }
+}
+
+bool hasTopLevelText(const tinyxml2::XMLDocument& doc) {
+    for (const XMLNode* node = doc.FirstChild(); node; node = node->NextSibling()) {
+        if (node->ToText()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(ClientTest, TestReaderMatchesDomOnRandomDocuments) {
+    mt19937 rng(38);
+    for (int round = 0; round < 2000; ++round) {
+        string xml;
+        if (rng() % 2) {
+            xml += "<?xml version=\"1.0\"?>\n";
+        }
+        appendRandomElement(rng, 0, xml);
+        if (round % 2) {
+            // Damage every other document so both parsers also have to agree on rejecting it.
+            size_t at = rng() % xml.size();
+            switch (rng() % 3) {
+            case 0:
+                xml.erase(at, 1);
+                break;
+            case 1:
+                xml.insert(at, 1, "<>&\"'/="[rng() % 7]);
+                break;
+            default:
+                xml.resize(at);
+                break;
+            }
+        }
+
+        tinyxml2::XMLDocument doc;
+        bool parsed = (doc.Parse(xml.data(), xml.size()) == XML_SUCCESS);
+        XMLReader reader(xml.data(), xml.size(), true, 16 + rng() % 48);
+        string events;
+        if (readerEvents(reader, events) == XML_READ_END_DOCUMENT) {
+            ASSERT_TRUE(parsed) << xml;
+            string expected;
+            appendDomEvents(&doc, expected);
+            ASSERT_EQ(events, expected) << xml;
+        }
+        else if (parsed) {
+            // The reader only rejects what XMLDocument lets through when the document has no
+            // element, has text outside the root element, or closes an element it never opened.
+            bool stray = (reader.ErrorID() == XML_ERROR_MISMATCHED_ELEMENT && reader.Depth() == 0);
+            ASSERT_TRUE(!doc.RootElement() || hasTopLevelText(doc) || stray) << reader.ErrorName() << "\n" << xml;
+        }
+    }
+}
+
+TEST(ClientTest, TestReaderStreamsArchiveInBoundedMemory) {
+    const int games = 20000;
+    string xml = makeArchiveXml(games);
+    FILE* fp = tmpfile();
+    ASSERT_NE(fp, nullptr);
+    ASSERT_EQ(fwrite(xml.data(), 1, xml.size(), fp), xml.size());
+    rewind(fp);
+
+    XMLReader reader(fp, true, 4096);
+    int states = 0;
+    int draws = 0;
+    bool inStatus = false;
+    XMLReadEvent event;
+    while ((event = reader.Next()) != XML_READ_END_DOCUMENT && event != XML_READ_ERROR) {
+        if (event == XML_READ_START_ELEMENT) {
+            states += (strcmp(reader.Name(), "GameState") == 0);
+            inStatus = (strcmp(reader.Name(), "Status") == 0);
+        }
+        else if (event == XML_READ_TEXT && inStatus) {
+            draws += (strcmp(reader.Text(), "Draw") == 0);
+        }
+    }
+    fclose(fp);
+    EXPECT_EQ(event, XML_READ_END_DOCUMENT);
+    EXPECT_EQ(states, games);
+    EXPECT_GT(draws, 0);
+    EXPECT_EQ(reader.BufferCapacity(), static_cast<size_t>(4096));
+}
+
+TEST(ClientTest, TestInternedNameLookup) {
+    tinyxml2::XMLDocument plain;
+    EXPECT_FALSE(plain.InternsNames());
+    EXPECT_FALSE(plain.Atom("Row").IsValid());
+
+    tinyxml2::XMLDocument doc;
+    doc.SetInternNames(true);
+    XMLAtom cellAtom = doc.Atom("Cell");
+    ASSERT_TRUE(cellAtom.IsValid());
+    EXPECT_EQ(doc.Atom("Cell"), cellAtom);
+    EXPECT_NE(doc.Atom("Row"), cellAtom);
+
+    Board board = emptyBoard();
+    board[5] = 'O';
+    string xml = makeStateXml('X', GameMode::ManVsMan, board, GameStatus::NextMove);
+    for (int pass = 0; pass < 2; ++pass) {
+        ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+        XMLElement* row = doc.RootElement()->FirstChildElement("Board")->FirstChildElement(doc.Atom("Row"));
+        ASSERT_NE(row, nullptr);
+        row = row->NextSiblingElement(doc.Atom("Row"));
+        ASSERT_NE(row, nullptr);
+        EXPECT_EQ(row->FirstChildElement(cellAtom), row->FirstChildElement("Cell"));
+        EXPECT_EQ(row->LastChildElement(cellAtom), row->LastChildElement("Cell"));
+        EXPECT_STREQ(row->LastChildElement(cellAtom)->GetText(), "O");
+        EXPECT_EQ(row->LastChildElement(cellAtom)->PreviousSiblingElement(cellAtom), row->FirstChildElement(cellAtom)->NextSiblingElement(cellAtom));
+        EXPECT_EQ(row->FirstChildElement(cellAtom)->NameAtom(), cellAtom);
+        EXPECT_EQ(row->FirstChildElement(XMLAtom()), nullptr);
+    }
+
+    XMLElement* cell = doc.RootElement()->FirstChildElement("Board")->FirstChildElement("Row")->FirstChildElement("Cell");
+    cell->SetName("Corner");
+    EXPECT_EQ(cell->NameAtom(), doc.Atom("Corner"));
+    EXPECT_EQ(cell->Parent()->FirstChildElement(doc.Atom("Corner")), cell);
+    XMLElement* created = doc.NewElement("Cell");
+    EXPECT_EQ(created->NameAtom(), cellAtom);
+    doc.DeleteNode(created);
+}
+
+size_t countMovesByName(XMLElement* archive) {
+    size_t moves = 0;
+    for (XMLElement* game = archive->FirstChildElement("GameState"); game; game = game->NextSiblingElement("GameState")) {
+        XMLElement* board = game->FirstChildElement("Board");
+        for (XMLElement* row = board->FirstChildElement("Row"); row; row = row->NextSiblingElement("Row")) {
+            for (XMLElement* cell = row->FirstChildElement("Cell"); cell; cell = cell->NextSiblingElement("Cell")) {
+                moves += (cell->GetText()[0] != EMPTY_CELL);
+            }
+        }
+    }
+    return moves;
+}
+
+size_t countMovesByAtom(tinyxml2::XMLDocument& doc, XMLElement* archive) {
+    XMLAtom gameAtom = doc.Atom("GameState");
+    XMLAtom boardAtom = doc.Atom("Board");
+    XMLAtom rowAtom = doc.Atom("Row");
+    XMLAtom cellAtom = doc.Atom("Cell");
+    size_t moves = 0;
+    for (XMLElement* game = archive->FirstChildElement(gameAtom); game; game = game->NextSiblingElement(gameAtom)) {
+        XMLElement* board = game->FirstChildElement(boardAtom);
+        for (XMLElement* row = board->FirstChildElement(rowAtom); row; row = row->NextSiblingElement(rowAtom)) {
+            for (XMLElement* cell = row->FirstChildElement(cellAtom); cell; cell = cell->NextSiblingElement(cellAtom)) {
+                moves += (cell->GetText()[0] != EMPTY_CELL);
+            }
+        }
+    }
+    return moves;
+}
+
+TEST(ClientTest, TestAtomLookupOnGameArchive) {
+    string xml = makeArchiveXml(200);
+    tinyxml2::XMLDocument doc;
+    doc.SetInternNames(true);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLElement* archive = doc.RootElement();
+
+    size_t byName = countMovesByName(archive);
+    EXPECT_GT(byName, 0u);
+    EXPECT_EQ(countMovesByAtom(doc, archive), byName);
+}
+
+TEST(ClientBenchmark, DISABLED_AtomLookup) {
+    string xml = makeArchiveXml(20000);
+    tinyxml2::XMLDocument doc;
+    doc.SetInternNames(true);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLElement* archive = doc.RootElement();
+    const int rounds = 5;
+
+    size_t byName = 0;
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        byName += countMovesByName(archive);
+    }
+    double nameTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    size_t byAtom = 0;
+    start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        byAtom += countMovesByAtom(doc, archive);
+    }
+    double atomTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(byAtom, byName);
+    cout << "Walking 20000 archived games: by name " << nameTime / rounds << " ms, by atom "
+        << atomTime / rounds << " ms (" << nameTime / atomTime << "x)" << endl;
+}
+
+FILE* writeTempFile(const string& content) {
+    FILE* fp = tmpfile();
+    if (fp != nullptr) {
+        fwrite(content.data(), 1, content.size(), fp);
+        rewind(fp);
+    }
+    return fp;
+}
+
+string readTempFile(FILE* fp) {
+    string content;
+    rewind(fp);
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        content.append(chunk, read);
+    }
+    return content;
+}
+
+TEST(ClientTest, TestLoadFileMapsLargeFiles) {
+    string xml = makeArchiveXml(2000);
+    ASSERT_GE(xml.size(), TINYXML2_MMAP_THRESHOLD);
+    tinyxml2::XMLDocument expected;
+    ASSERT_EQ(expected.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLPrinter expectedPrinter;
+    expected.Print(&expectedPrinter);
+
+    FILE* fp = writeTempFile(xml);
+    ASSERT_NE(fp, nullptr);
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.LoadFile(fp), XML_SUCCESS);
+    EXPECT_TRUE(doc.IsFileMapped());
+    XMLPrinter printer;
+    doc.Print(&printer);
+    EXPECT_STREQ(printer.CStr(), expectedPrinter.CStr());
+    EXPECT_STREQ(doc.RootElement()->FirstChildElement("GameState")->FirstChildElement("GameType")->GetText(), "Man vs AI & replay");
+    EXPECT_EQ(readTempFile(fp), xml);
+    doc.Clear();
+    EXPECT_FALSE(doc.IsFileMapped());
+
+    // A file ending exactly on a page boundary still gets its null terminator.
+    string padded = xml + string(4096 - xml.size() % 4096, '\n');
+    ASSERT_EQ(padded.size() % 4096, 0u);
+    FILE* paddedFp = writeTempFile(padded);
+    ASSERT_NE(paddedFp, nullptr);
+    ASSERT_EQ(doc.LoadFile(paddedFp), XML_SUCCESS);
+    EXPECT_NE(doc.RootElement()->LastChildElement("GameState"), nullptr);
+    fclose(paddedFp);
+
+    string small = makeStateXml('X', GameMode::ManVsMan, emptyBoard(), GameStatus::NextMove);
+    FILE* smallFp = writeTempFile(small);
+    ASSERT_NE(smallFp, nullptr);
+    ASSERT_EQ(doc.LoadFile(smallFp), XML_SUCCESS);
+    EXPECT_FALSE(doc.IsFileMapped());
+    EXPECT_NE(doc.FirstChildElement("GameState"), nullptr);
+    fclose(smallFp);
+    fclose(fp);
+}
+
+TEST(ClientTest, TestSaveFileWritesWholeDocument) {
+    string xml = makeArchiveXml(5000);
+    ASSERT_GT(xml.size(), TINYXML2_WRITE_CHUNK_SIZE);
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLPrinter printer;
+    doc.Print(&printer);
+
+    FILE* fp = tmpfile();
+    ASSERT_NE(fp, nullptr);
+    ASSERT_EQ(doc.SaveFile(fp), XML_SUCCESS);
+    EXPECT_EQ(readTempFile(fp), string(printer.CStr()));
+    fclose(fp);
+}
+
+TEST(ClientTest, TestNumberConversions) {
+    char buffer[64];
+    char expected[64];
+    double parsed = 0;
+    XMLUtil::ToStr(0.1, buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "0.1");
+    EXPECT_TRUE(XMLUtil::ToDouble(buffer, &parsed));
+    EXPECT_EQ(parsed, 0.1);
+    XMLUtil::ToStr(1e6, buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "1e+06");
+    EXPECT_TRUE(XMLUtil::ToDouble(buffer, &parsed));
+    EXPECT_EQ(parsed, 1e6);
+    float parsedSingle = 0;
+    XMLUtil::ToStr(0.1f, buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "0.1");
+    EXPECT_TRUE(XMLUtil::ToFloat(buffer, &parsedSingle));
+    EXPECT_EQ(parsedSingle, 0.1f);
+    XMLUtil::ToStr(2.5f, buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "2.5");
+    tinyxml2::XMLDocument doc;
+    XMLElement* element = doc.NewElement("GameState");
+    element->SetAttribute("d", 1e6);
+    EXPECT_STREQ(element->Attribute("d"), "1e+06");
+    XMLUtil::ToStr(-42, buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "-42");
+    XMLUtil::ToStr(static_cast<uint64_t>(18446744073709551615ull), buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "18446744073709551615");
+    XMLUtil::ToStr(123456, buffer, 4);
+    EXPECT_STREQ(buffer, "123");
+
+    mt19937_64 rng(42);
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t bits = rng();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value) {
+            continue;
+        }
+        // The shortest form reads back exactly and is never longer than "%.17g" / "%.9g".
+        XMLUtil::ToStr(value, buffer, sizeof(buffer));
+        snprintf(expected, sizeof(expected), "%.17g", value);
+        ASSERT_LE(strlen(buffer), strlen(expected)) << buffer;
+        ASSERT_TRUE(XMLUtil::ToDouble(buffer, &parsed)) << buffer;
+        ASSERT_EQ(parsed, value) << buffer;
+
+        float single = static_cast<float>(value);
+        XMLUtil::ToStr(single, buffer, sizeof(buffer));
+        snprintf(expected, sizeof(expected), "%.9g", single);
+        ASSERT_LE(strlen(buffer), strlen(expected)) << buffer;
+        ASSERT_TRUE(XMLUtil::ToFloat(buffer, &parsedSingle)) << buffer;
+        ASSERT_EQ(parsedSingle, single) << buffer;
+
+        int64_t integer = static_cast<int64_t>(bits);
+        XMLUtil::ToStr(integer, buffer, sizeof(buffer));
+        int64_t parsedInteger = 0;
+        ASSERT_TRUE(XMLUtil::ToInt64(buffer, &parsedInteger)) << buffer;
+        ASSERT_EQ(parsedInteger, integer);
+    }
+
+    int i = 0;
+    EXPECT_TRUE(XMLUtil::ToInt("  +17", &i));
+    EXPECT_EQ(i, 17);
+    EXPECT_TRUE(XMLUtil::ToInt("0xFF", &i));
+    EXPECT_EQ(i, 255);
+    EXPECT_TRUE(XMLUtil::ToInt("12 moves", &i));
+    EXPECT_EQ(i, 12);
+    EXPECT_FALSE(XMLUtil::ToInt("X", &i));
+    unsigned u = 0;
+    EXPECT_TRUE(XMLUtil::ToUnsigned("-1", &u));
+    EXPECT_EQ(u, 4294967295u);
+    double d = 0;
+    EXPECT_TRUE(XMLUtil::ToDouble("0x1p3", &d));
+    EXPECT_EQ(d, 8.0);
+    EXPECT_TRUE(XMLUtil::ToDouble(" -2.5e3", &d));
+    EXPECT_EQ(d, -2500.0);
+    EXPECT_FALSE(XMLUtil::ToDouble("Draw", &d));
+}
+
+TEST(ClientBenchmark, DISABLED_NumberConversion) {
+    const int count = 200000;
+    vector<double> values(count);
+    mt19937 rng(7);
+    uniform_real_distribution<double> distribution(0.0, 1e6);
+    for (double& value : values) {
+        value = distribution(rng);
+    }
+    char buffer[64];
+    double stdioSum = 0;
+    double xmlUtilSum = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (double value : values) {
+        snprintf(buffer, sizeof(buffer), "%.17g", value);
+        double parsed = 0;
+        sscanf(buffer, "%lf", &parsed);
+        stdioSum += parsed;
+    }
+    double stdioTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (double value : values) {
+        XMLUtil::ToStr(value, buffer, sizeof(buffer));
+        double parsed = 0;
+        XMLUtil::ToDouble(buffer, &parsed);
+        xmlUtilSum += parsed;
+    }
+    double xmlUtilTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(xmlUtilSum, stdioSum);
+    cout << "Writing and reading " << count << " doubles: snprintf/sscanf " << stdioTime << " ms, XMLUtil "
+        << xmlUtilTime << " ms (" << stdioTime / xmlUtilTime << "x)" << endl;
+}
+
+class RecordingSink : public XMLSink {
+public:
+    string output;
+    size_t writes = 0;
+    size_t largestWrite = 0;
+
+    void Write(const char* data, size_t size) override {
+        output.append(data, size);
+        writes++;
+        largestWrite = (size > largestWrite) ? size : largestWrite;
+    }
+};
+
+TEST(ClientTest, TestPrinterSinkMatchesMemoryPrinter) {
+    string xml = makeArchiveXml(200);
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLPrinter memory;
+    doc.Print(&memory);
+
+    const size_t chunkSizes[] = { 0, 64, TINYXML2_PRINTER_CHUNK_SIZE };
+    for (size_t chunkSize : chunkSizes) {
+        RecordingSink sink;
+        {
+            XMLPrinter printer(sink, false, 0, chunkSize);
+            doc.Print(&printer);
+            printer.Flush();
+        }
+        EXPECT_EQ(sink.output, string(memory.CStr()));
+        if (chunkSize > 0) {
+            EXPECT_LE(sink.largestWrite, chunkSize);
+            EXPECT_LE(sink.writes, sink.output.size() / (chunkSize / 2) + 1);
+        }
+    }
+
+    RecordingSink unflushed;
+    {
+        XMLPrinter printer(unflushed);
+        printer.OpenElement("Status");
+        printer.PushText("Draw");
+        printer.CloseElement();
+        EXPECT_TRUE(unflushed.output.empty());
+    }
+    EXPECT_EQ(unflushed.output, "<Status>Draw</Status>\n");
+}
+
+TEST(ClientTest, TestBufferSinkReportsOverflow) {
+    char buffer[16];
+    XMLBufferSink sink(buffer, sizeof(buffer));
+    XMLPrinter printer(sink, true, 0, 0);
+    printer.OpenElement("GameType");
+    printer.PushText("Man vs AI");
+    printer.CloseElement();
+    EXPECT_TRUE(sink.Overflowed());
+    EXPECT_EQ(sink.Size(), sizeof(buffer));
+    EXPECT_EQ(string(buffer, sink.Size()), "<GameType>Man vs");
+    sink.Clear();
+    EXPECT_FALSE(sink.Overflowed());
+    EXPECT_EQ(sink.Size(), 0u);
+}
+
+TEST(ClientTest, TestSerializeGameStateIntoTxBuffer) {
+    Board board = emptyBoard();
+    board[0] = 'X';
+    board[7] = 'O';
+    string expected = makeStateXml('O', GameMode::AIVsMan, board, GameStatus::NextMove);
+
+    char tx[GAME_STATE_TX_SIZE];
+    size_t before = allocationCount;
+    size_t length = serializeGameState(tx, sizeof(tx), 'O', GameMode::AIVsMan, board, GameStatus::NextMove);
+    EXPECT_EQ(allocationCount, before);
+    EXPECT_EQ(string(tx, length), expected);
+
+    EXPECT_EQ(serializeGameState(tx, 100, 'O', GameMode::AIVsMan, board, GameStatus::NextMove), 0u);
+}
+
+TEST(ClientTest, TestReservedPrinterDoesNotRegrow) {
+    string xml = makeArchiveXml(200);
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLPrinter printer;
+    printer.ReserveBuffer(xml.size() * 2);
+    size_t before = allocationCount;
+    doc.Print(&printer);
+    EXPECT_EQ(allocationCount, before);
+    EXPECT_GT(printer.CStrSize(), xml.size() / 2);
+}
+
+TEST(ClientTest, TestNodeLayoutOnGameArchive) {
+    string xml = makeArchiveXml(200);
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+
+    // Nodes of every pool are deleted, moved and created after parsing.
+    XMLElement* archive = doc.RootElement();
+    archive->DeleteChild(archive->FirstChild());
+    XMLElement* first = archive->FirstChildElement("GameState");
+    EXPECT_EQ(first->IntAttribute("id", -1), 0);
+    first->DeleteAttribute("id");
+    first->SetAttribute("replayed", true);
+    archive->InsertEndChild(first);
+    archive->InsertEndChild(doc.NewComment("moved"));
+    doc.DeleteNode(doc.NewText("unlinked"));
+    first->FirstChildElement("Player")->SetText("O");
+
+    XMLPrinter printer(nullptr, true);
+    doc.Print(&printer);
+    string printed = printer.CStr();
+    EXPECT_NE(printed.find("<GameState replayed=\"true\"><Player>O</Player>"), string::npos);
+    EXPECT_NE(printed.find("</GameState><!--moved--></GameArchive>"), string::npos);
+    EXPECT_EQ(printed.find("<!--Game 0-->"), string::npos);
+    EXPECT_EQ(first->GetLineNum(), 4);
+    EXPECT_EQ(first->FindAttribute("replayed")->GetLineNum(), 0);
+    EXPECT_EQ(first->FirstChildElement("Board")->GetLineNum(), 7);
+#if defined(TINYXML2_COMPACT_NODES)
+    EXPECT_LE(sizeof(XMLElement), 12 * sizeof(void*));
+    EXPECT_LE(sizeof(XMLAttribute), 7 * sizeof(void*));
+#endif
+}
+
+TEST(ClientBenchmark, DISABLED_NodeLayout) {
+    string xml = makeArchiveXml(20000);
+    size_t before = allocatedBytes;
+    tinyxml2::XMLDocument doc;
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    size_t domBytes = allocatedBytes - before;
+    cout << "DOM of " << xml.size() / 1024 << " KB of game archive XML: " << domBytes / 1024 << " KB" << endl;
+    cout << "  element " << sizeof(XMLElement) << " B, text " << sizeof(XMLText) << " B, attribute " << sizeof(XMLAttribute) << " B" << endl;
+}
+
+TEST(ClientTest, TestGameStateDocumentMatchesSerializer) {
+    GameStateDocument document;
+    char expected[GAME_STATE_TX_SIZE];
+    mt19937 rng(45);
+    const GameStatus statuses[] = { GameStatus::Start, GameStatus::NextMove, GameStatus::WinX, GameStatus::Draw };
+    for (int game = 0; game < 50; ++game) {
+        Board board = emptyBoard();
+        char player = (game % 2) ? 'O' : 'X';
+        size_t length = initGameStateDocument(document, player, GameMode::AIVsMan, board, GameStatus::Start);
+        ASSERT_EQ(length, serializeGameState(expected, sizeof(expected), player, GameMode::AIVsMan, board, GameStatus::Start));
+        ASSERT_EQ(string(document.xml, length), string(expected, length));
+        for (int move = 0; move < 9; ++move) {
+            while (!makeMove(board, 1 + rng() % 9, player)) {
+            }
+            player = (player == 'X') ? 'O' : 'X';
+            GameStatus status = statuses[rng() % 4];
+            length = updateGameStateDocument(document, player, board, status);
+            ASSERT_EQ(length, serializeGameState(expected, sizeof(expected), player, GameMode::AIVsMan, board, status));
+            ASSERT_EQ(string(document.xml, length), string(expected, length));
+        }
+    }
+    XMLPrinter printer(nullptr, true);
+    document.dom.Print(&printer);
+    EXPECT_EQ(string(printer.CStr()) + "\n", string(document.xml, document.length));
+
+    EXPECT_EQ(updateGameStateDocument(document, 'Z', emptyBoard(), GameStatus::Start), 0u);
+    Board invalid = emptyBoard();
+    invalid[4] = 'Z';
+    EXPECT_EQ(initGameStateDocument(document, 'X', GameMode::ManVsMan, invalid, GameStatus::Start), 0u);
+    EXPECT_EQ(updateGameStateDocument(document, 'X', emptyBoard(), GameStatus::Start), 0u);
+}
+
+TEST(ClientTest, TestGameStateDocumentPatchesWithoutAllocating) {
+    GameStateDocument document;
+    char buffer[GAME_STATE_TX_SIZE];
+    Board board = emptyBoard();
+    ASSERT_GT(initGameStateDocument(document, 'X', GameMode::ManVsAI, board, GameStatus::Start), 0u);
+
+    size_t before = allocationCount;
+    for (int round = 0; round < 2000; ++round) {
+        board[round % 9] = (board[round % 9] == 'X') ? EMPTY_CELL : 'X';
+        char player = (round % 2) ? 'O' : 'X';
+        GameStatus status = (round % 3) ? GameStatus::Start : GameStatus::NextMove;
+        size_t patched = updateGameStateDocument(document, player, board, status);
+        size_t serialized = serializeGameState(buffer, sizeof(buffer), player, GameMode::ManVsAI, board, status);
+        ASSERT_EQ(patched, serialized);
+        ASSERT_EQ(memcmp(document.xml, buffer, patched), 0) << "round " << round;
+    }
+    EXPECT_EQ(allocationCount, before);
+}
+
+TEST(ClientBenchmark, DISABLED_GameStateDocumentPatch) {
+    GameStateDocument document;
+    char buffer[GAME_STATE_TX_SIZE];
+    Board board = emptyBoard();
+    ASSERT_GT(initGameStateDocument(document, 'X', GameMode::ManVsAI, board, GameStatus::Start), 0u);
+    const int rounds = 200000;
+
+    size_t patched = 0;
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        board[round % 9] = (board[round % 9] == 'X') ? EMPTY_CELL : 'X';
+        patched += updateGameStateDocument(document, (round % 2) ? 'O' : 'X', board, (round % 3) ? GameStatus::Start : GameStatus::NextMove);
+    }
+    double patchTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    size_t serialized = 0;
+    start = chrono::steady_clock::now();
+    board = emptyBoard();
+    for (int round = 0; round < rounds; ++round) {
+        board[round % 9] = (board[round % 9] == 'X') ? EMPTY_CELL : 'X';
+        serialized += serializeGameState(buffer, sizeof(buffer), (round % 2) ? 'O' : 'X', GameMode::ManVsAI, board, (round % 3) ? GameStatus::Start : GameStatus::NextMove);
+    }
+    double serializeTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(patched, serialized);
+    cout << "Per-move update of the game state document: " << patchTime << " ms patched, " << serializeTime << " ms reserialized" << endl;
+}
+
+TEST(ClientTest, TestParserServiceReportsErrors) {
+    vector<string> documents;
+    documents.push_back(makeStateXml('O', GameMode::ManVsAI, emptyBoard(), GameStatus::NextMove));
+    documents.push_back("<GameState>\n<Player>X</Player>\n<Board></Row></GameState>");
+    documents.push_back("<GameState>\n<Player>X</Player>\n\n<GameType>Man vs Dog</GameType></GameState>");
+    documents.push_back("<GameState>\n<Player>X</Player>\n<GameType>AI vs AI</GameType>\n<Board><Row/></Board></GameState>");
+    documents.push_back("<Game/>");
+
+    ParserService service;
+    startParserService(service, 3);
+    vector<ParseResult> results;
+    parseGameStates(service, documents, results);
+    stopParserService(service);
+
+    ASSERT_EQ(results.size(), documents.size());
+    EXPECT_EQ(results[0].status, ParseStatus::Ok);
+    EXPECT_EQ(results[0].state.player, 'O');
+    EXPECT_EQ(results[0].state.gameMode, GameMode::ManVsAI);
+    EXPECT_EQ(results[0].state.status, GameStatus::NextMove);
+    EXPECT_EQ(results[1].status, ParseStatus::XmlError);
+    EXPECT_EQ(results[1].xmlError, XML_ERROR_MISMATCHED_ELEMENT);
+    EXPECT_EQ(results[1].line, 3);
+    EXPECT_EQ(results[2].status, ParseStatus::InvalidValue);
+    EXPECT_STREQ(results[2].element, "GameType");
+    EXPECT_EQ(results[2].line, 4);
+    EXPECT_EQ(results[3].status, ParseStatus::MissingElement);
+    EXPECT_STREQ(results[3].element, "Cell");
+    EXPECT_EQ(results[3].line, 4);
+    EXPECT_EQ(results[4].status, ParseStatus::MissingElement);
+    EXPECT_STREQ(results[4].element, "GameState");
+}
+
+TEST(ClientTest, TestParserServiceStopsWhenDestroyed) {
+    vector<string> documents(100, makeStateXml('X', GameMode::AIVsAI, emptyBoard(), GameStatus::Start));
+    vector<ParseResult> results;
+    {
+        ParserService service;
+        startParserService(service, 4);
+        parseGameStates(service, documents, results);
+    }
+    ASSERT_EQ(results.size(), documents.size());
+    EXPECT_EQ(results.back().status, ParseStatus::Ok);
+
+    ParserService stopped;
+    startParserService(stopped, 2);
+    stopParserService(stopped);
+    stopParserService(stopped);
+    EXPECT_TRUE(stopped.workers.empty());
+}
+
+void makeRandomGameStates(int count, vector<string>& documents, vector<Board>& boards, vector<char>& players) {
+    mt19937 rng(46);
+    for (int i = 0; i < count; ++i) {
+        Board board = emptyBoard();
+        char player = 'X';
+        for (int move = rng() % 9; move > 0; --move) {
+            while (!makeMove(board, 1 + rng() % 9, player)) {
+            }
+            player = (player == 'X') ? 'O' : 'X';
+        }
+        boards.push_back(board);
+        players.push_back(player);
+        documents.push_back(makeStateXml(player, GameMode::AIVsAI, board, GameStatus::NextMove));
+    }
+}
+
+TEST(ClientTest, TestParserServiceMatchesAcrossThreads) {
+    vector<string> documents;
+    vector<Board> boards;
+    vector<char> players;
+    makeRandomGameStates(2000, documents, boards, players);
+
+    for (unsigned threads : { 1u, 2u, 3u, 8u }) {
+        ParserService service;
+        startParserService(service, threads);
+        vector<ParseResult> results;
+        for (int batch = 0; batch < 2; ++batch) {
+            parseGameStates(service, documents, results);
+            ASSERT_EQ(results.size(), documents.size());
+            for (size_t i = 0; i < documents.size(); ++i) {
+                ASSERT_EQ(results[i].status, ParseStatus::Ok) << threads << " threads, document " << i;
+                ASSERT_EQ(results[i].state.player, players[i]);
+                ASSERT_EQ(results[i].state.board.cells, boards[i].cells);
+                ASSERT_EQ(results[i].state.status, GameStatus::NextMove);
+            }
+        }
+        stopParserService(service);
+    }
+}
+
+TEST(ClientBenchmark, DISABLED_ParserServiceThreads) {
+    vector<string> documents;
+    vector<Board> boards;
+    vector<char> players;
+    makeRandomGameStates(20000, documents, boards, players);
+
+    unsigned hardware = max(thread::hardware_concurrency(), 4u);
+    double singleTime = 0;
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        ParserService service;
+        startParserService(service, threads);
+        vector<ParseResult> results;
+        parseGameStates(service, documents, results);
+        auto start = chrono::steady_clock::now();
+        parseGameStates(service, documents, results);
+        double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        stopParserService(service);
+
+        if (threads == 1) {
+            singleTime = elapsed;
+        }
+        cout << "Parsing " << documents.size() << " game states on " << threads << " threads: " << elapsed << " ms ("
+            << singleTime / elapsed << "x)" << endl;
+    }
+}
+
+TEST(ClientTest, TestMemoryStats) {
+    string xml = makeArchiveXml(1000);
+    tinyxml2::XMLDocument doc;
+    doc.SetRetainMemory(true);
+    XMLMemoryStats empty = doc.MemoryStats();
+    EXPECT_EQ(empty.totalBytes, 0u);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+
+    XMLMemoryStats stats = doc.MemoryStats();
+    // Every game holds 17 elements, 12 texts, an attribute and a comment, plus the archive and its declaration.
+    EXPECT_EQ(stats.elements.currentAllocs, 1000u * 17 + 1);
+    EXPECT_EQ(stats.texts.currentAllocs, 1000u * 12);
+    EXPECT_EQ(stats.attributes.currentAllocs, 1000u);
+    EXPECT_EQ(stats.comments.currentAllocs, 1000u + 1);
+    EXPECT_EQ(stats.elements.untracked, 0u);
+    EXPECT_EQ(stats.elements.itemSize, sizeof(XMLElement));
+    EXPECT_GE(stats.elements.bytes, stats.elements.currentAllocs * sizeof(XMLElement));
+    EXPECT_GE(stats.charBufferBytes, xml.size());
+    EXPECT_EQ(stats.totalBytes, stats.elements.bytes + stats.attributes.bytes + stats.texts.bytes + stats.comments.bytes + stats.charBufferBytes);
+
+    doc.Clear();
+    XMLMemoryStats cleared = doc.MemoryStats();
+    EXPECT_EQ(cleared.elements.currentAllocs, 0u);
+    EXPECT_GE(cleared.elements.maxAllocs, stats.elements.currentAllocs);
+    EXPECT_EQ(cleared.totalBytes, stats.totalBytes);
+}
+
+TEST(ClientTest, TestPoolBlockSize) {
+    string xml = makeArchiveXml(1000);
+    tinyxml2::XMLDocument small;
+    tinyxml2::XMLDocument large;
+    large.SetPoolBlockSize(256 * 1024);
+    EXPECT_EQ(small.PoolBlockSize(), 4u * 1024);
+    EXPECT_EQ(large.PoolBlockSize(), 256u * 1024);
+    ASSERT_EQ(small.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    ASSERT_EQ(large.Parse(xml.data(), xml.size()), XML_SUCCESS);
+
+    XMLMemoryStats smallStats = small.MemoryStats();
+    XMLMemoryStats largeStats = large.MemoryStats();
+    EXPECT_EQ(largeStats.elements.currentAllocs, smallStats.elements.currentAllocs);
+    EXPECT_LT(largeStats.elements.blocks * 32, smallStats.elements.blocks);
+    EXPECT_LE(largeStats.elements.bytes, largeStats.elements.blocks * 256 * 1024);
+    EXPECT_GT(largeStats.elements.bytes, (largeStats.elements.blocks - 1) * 256 * 1024);
+
+    XMLPrinter smallPrinter;
+    XMLPrinter largePrinter;
+    small.Print(&smallPrinter);
+    large.Print(&largePrinter);
+    EXPECT_STREQ(largePrinter.CStr(), smallPrinter.CStr());
+}
+
+TEST(ClientTest, TestArenaBackedDocument) {
+    string xml = makeArchiveXml(200);
+    vector<char> buffer(4 * 1024 * 1024);
+    XMLArena arena(buffer.data(), buffer.size());
+    tinyxml2::XMLDocument doc;
+    doc.SetPoolBlockSize(64 * 1024);
+    doc.SetArena(&arena);
+    EXPECT_EQ(doc.Arena(), &arena);
+
+    // The first import grows the block lists of the pools; after that an import allocates nothing on the heap.
+    for (int pass = 0; pass < 3; ++pass) {
+        size_t before = allocationCount;
+        ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+        XMLMemoryStats stats = doc.MemoryStats();
+        EXPECT_EQ(stats.elements.currentAllocs, 200u * 17 + 1);
+        EXPECT_GE(arena.Used(), stats.totalBytes);
+        EXPECT_EQ(arena.OverflowBytes(), 0u);
+        EXPECT_EQ(doc.FirstChildElement("GameArchive")->LastChildElement("GameState")->IntAttribute("id"), 199);
+        if (pass > 0) {
+            EXPECT_EQ(allocationCount, before);
+        }
+        doc.Clear();
+        EXPECT_EQ(doc.MemoryStats().totalBytes, 0u);
+        arena.Reset();
+        EXPECT_EQ(arena.Used(), 0u);
+    }
+
+    // A buffer that is too small spills into overflow chunks, which the reset frees.
+    char tiny[1024];
+    XMLArena spilling(tiny, sizeof(tiny));
+    doc.SetArena(&spilling);
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    EXPECT_GT(spilling.OverflowBytes(), 0u);
+    EXPECT_LE(spilling.Used(), sizeof(tiny));
+    XMLPrinter printer;
+    doc.Print(&printer);
+    tinyxml2::XMLDocument reference;
+    ASSERT_EQ(reference.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    XMLPrinter referencePrinter;
+    reference.Print(&referencePrinter);
+    EXPECT_STREQ(printer.CStr(), referencePrinter.CStr());
+    doc.SetArena(nullptr);
+    spilling.Reset();
+    EXPECT_EQ(spilling.OverflowBytes(), 0u);
+
+    ASSERT_EQ(doc.Parse(xml.data(), xml.size()), XML_SUCCESS);
+    EXPECT_EQ(doc.MemoryStats().elements.currentAllocs, 200u * 17 + 1);
+}
+
+/**
+ * @brief Stands in for the server's random AI by playing the first empty cell.
+ */
+static uint8_t firstEmptyCell(const CoreState& state) {
+    uint8_t cell = 0;
+    while ((state.x | state.o) & (1 << cell)) {
+        ++cell;
+    }
+    return cell;
+}
+
+TEST(ClientTest, TestCoreRules) {
+    for (uint8_t i = 0; i < GAME_STATUS_COUNT; ++i) {
+        const char* name = gameStatusName(static_cast<GameStatus>(i));
+        GameStatus status;
+        ASSERT_TRUE(findGameStatus(name, strlen(name), status));
+        EXPECT_EQ(static_cast<uint8_t>(status), i);
+    }
+    GameMode mode;
+    EXPECT_TRUE(findGameMode("AI vs Man!", 9, mode));
+    EXPECT_EQ(mode, GameMode::AIVsMan);
+    EXPECT_FALSE(findGameMode("AI vs", 5, mode));
+
+    CoreState state = { 0, 0, 'X', GameMode::ManVsMan, GameStatus::NextMove };
+    EXPECT_TRUE(setCellSymbol(state, 4, 'X'));
+    EXPECT_FALSE(setCellSymbol(state, 0, '?'));
+    EXPECT_EQ(cellSymbol(state, 4), 'X');
+    EXPECT_EQ(cellSymbol(state, 0), '_');
+    EXPECT_FALSE(playCell(state, 4));
+    EXPECT_EQ(evaluateBoard(state), GameStatus::NextMove);
+    state.x = 0x007;
+    EXPECT_EQ(evaluateBoard(state), GameStatus::WinX);
+    state.x = 0x0AA;
+    state.o = 0x155;
+    EXPECT_EQ(evaluateBoard(state), GameStatus::WinO);
+    state.x = 0x18D;
+    state.o = 0x072;
+    EXPECT_EQ(evaluateBoard(state), GameStatus::Draw);
+    EXPECT_EQ(weightedMove(state, 'X'), NO_MOVE);
+
+    // Win first, then block, then the highest weight.
+    state.x = 0x003;
+    state.o = 0x018;
+    EXPECT_EQ(weightedMove(state, 'X'), 2);
+    EXPECT_EQ(weightedMove(state, 'O'), 5);
+    state.x = 0x001;
+    state.o = 0;
+    EXPECT_EQ(weightedMove(state, 'O'), 4);
+    state.o = 0x010;
+    EXPECT_EQ(weightedMove(state, 'X'), 2);
+
+    // Man vs AI: the AI answers the player's move as the other player.
+    state = { 0x001, 0, 'X', GameMode::ManVsAI, GameStatus::NextMove };
+    advanceGame(state, firstEmptyCell);
+    EXPECT_EQ(state.o, 0x010);
+    EXPECT_EQ(state.player, 'X');
+    EXPECT_EQ(state.status, GameStatus::NextMove);
+
+    // AI vs Man: the AI opens a new game, then answers the player's moves.
+    state = { 0, 0, 'X', GameMode::AIVsMan, GameStatus::Start };
+    advanceGame(state, firstEmptyCell);
+    EXPECT_EQ(state.x, 0x010);
+    EXPECT_EQ(state.player, 'O');
+    state.o = 0x001;
+    advanceGame(state, firstEmptyCell);
+    EXPECT_EQ(state.x, 0x014);
+    EXPECT_EQ(state.player, 'O');
+
+    // Man vs Man only passes the turn; a finished game is left as is.
+    state = { 0x001, 0, 'X', GameMode::ManVsMan, GameStatus::NextMove };
+    advanceGame(state, firstEmptyCell);
+    EXPECT_EQ(state.player, 'O');
+    state.status = GameStatus::Draw;
+    advanceGame(state, firstEmptyCell);
+    EXPECT_EQ(state.player, 'O');
+
+    // AI vs AI plays to the end.
+    state = { 0, 0, 'X', GameMode::AIVsAI, GameStatus::Start };
+    advanceGame(state, firstEmptyCell);
+    EXPECT_EQ(state.x, 0x055);
+    EXPECT_EQ(state.status, GameStatus::WinX);
+}
+
+TEST(ClientTest, TestBoardStatusUsesTheSharedRules) {
+    Board board = emptyBoard();
+    board[0] = board[4] = 'X';
+    board[2] = 'O';
+    CoreState state = toCoreState(board, 'O', GameMode::ManVsAI, GameStatus::NextMove);
+    EXPECT_EQ(state.x, 0x011);
+    EXPECT_EQ(state.o, 0x004);
+    EXPECT_EQ(state.player, 'O');
+    EXPECT_EQ(state.mode, GameMode::ManVsAI);
+    EXPECT_EQ(boardStatus(board), GameStatus::NextMove);
+
+    board[8] = 'X';
+    EXPECT_EQ(boardStatus(board), GameStatus::WinX);
+    board = { { 'O', 'O', 'O', 'X', 'X', '_', 'X', '_', '_' } };
+    EXPECT_EQ(boardStatus(board), GameStatus::WinO);
+    board = { { 'X', 'O', 'X', 'X', 'O', 'O', 'O', 'X', 'X' } };
+    EXPECT_EQ(boardStatus(board), GameStatus::Draw);
+}
+
+TEST(ClientTest, TestCrc16) {
+    const char* check = "123456789";
+    EXPECT_EQ(crc16(reinterpret_cast<const uint8_t*>(check), strlen(check)), 0x29B1);
+    EXPECT_EQ(crc16(nullptr, 0), 0xFFFF);
+}
+
+/**
+ * @brief Encodes a block with COBS and checks that it decodes back to the same bytes.
+ */
+static void expectCobsRoundTrip(const vector<uint8_t>& input) {
+    vector<uint8_t> encoded(input.size() + input.size() / 254 + 1);
+    size_t encodedLength = cobsEncode(input.data(), input.size(), encoded.data());
+    ASSERT_LE(encodedLength, encoded.size());
+    encoded.resize(encodedLength);
+    EXPECT_EQ(count(encoded.begin(), encoded.end(), 0), 0);
+    vector<uint8_t> decoded(encoded.size());
+    size_t decodedLength = cobsDecode(encoded.data(), encoded.size(), decoded.data());
+    decoded.resize(decodedLength);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST(ClientTest, TestCobsRoundTrip) {
+    uint8_t encoded[2];
+    EXPECT_EQ(cobsEncode(nullptr, 0, encoded), 1u);
+    EXPECT_EQ(encoded[0], 0x01);
+    expectCobsRoundTrip({});
+    expectCobsRoundTrip({ 0x00 });
+    expectCobsRoundTrip({ 0x00, 0x00, 0x00 });
+    expectCobsRoundTrip({ 0x11, 0x00, 0x00, 0x22, 0x00 });
+
+    vector<uint8_t> run(254);
+    for (size_t i = 0; i < run.size(); ++i) {
+        run[i] = static_cast<uint8_t>(1 + i % 255);
+    }
+    expectCobsRoundTrip(run);
+    run.push_back(0xFF);
+    expectCobsRoundTrip(run);
+    run.insert(run.begin(), 0x00);
+    expectCobsRoundTrip(run);
+
+    // A code byte pointing past the end of the block is malformed.
+    uint8_t malformed[] = { 0x05, 0x11, 0x22 };
+    uint8_t decoded[sizeof(malformed)];
+    EXPECT_EQ(cobsDecode(malformed, sizeof(malformed), decoded), 0u);
+}
+
+TEST(ClientTest, TestParseFrameRejectsDamagedFrames) {
+    const uint8_t payload[] = { '<', 'G', 0x00, 'S', '>' };
+    uint8_t encoded[FRAME_MAX_ENCODED_SIZE];
+    size_t length = buildFrame(FRAME_DATA, 7, 1, 3, payload, sizeof(payload), encoded) - 1;
+    ASSERT_EQ(encoded[length], 0x00);
+    Frame frame;
+    ASSERT_TRUE(parseFrame(encoded, length, frame));
+    EXPECT_EQ(frame.type, FRAME_DATA);
+    EXPECT_EQ(frame.seq, 7);
+    EXPECT_EQ(frame.index, 1);
+    EXPECT_EQ(frame.count, 3);
+    ASSERT_EQ(frame.payloadLength, sizeof(payload));
+    EXPECT_TRUE(equal(payload, payload + sizeof(payload), frame.payload));
+
+    // Every single flipped bit is caught, whether it hits a code byte, the data or the CRC.
+    for (size_t i = 0; i < length; ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            uint8_t damaged[FRAME_MAX_ENCODED_SIZE];
+            copy(encoded, encoded + length, damaged);
+            damaged[i] ^= static_cast<uint8_t>(1 << bit);
+            EXPECT_FALSE(parseFrame(damaged, length, frame)) << "byte " << i << " bit " << bit;
+        }
+    }
+
+    // A frame that lost any one of its bytes, or was cut short, does not pass.
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t shortened[FRAME_MAX_ENCODED_SIZE];
+        copy(encoded, encoded + i, shortened);
+        copy(encoded + i + 1, encoded + length, shortened + i);
+        EXPECT_FALSE(parseFrame(shortened, length - 1, frame)) << "byte " << i;
+        EXPECT_FALSE(parseFrame(encoded, i, frame)) << "length " << i;
+    }
+    EXPECT_FALSE(parseFrame(encoded, FRAME_MAX_ENCODED_SIZE + 1, frame));
+
+    // A frame whose payload exceeds FRAME_PAYLOAD_SIZE is rejected even with a valid CRC.
+    uint8_t raw[FRAME_MAX_SIZE + 1] = { FRAME_DATA, 1, 0, 1 };
+    fill(raw + FRAME_HEADER_SIZE, raw + FRAME_MAX_SIZE - 1, 'A');
+    uint16_t crc = crc16(raw, FRAME_MAX_SIZE - 1);
+    raw[FRAME_MAX_SIZE - 1] = static_cast<uint8_t>(crc >> 8);
+    raw[FRAME_MAX_SIZE] = static_cast<uint8_t>(crc & 0xFF);
+    uint8_t oversized[FRAME_MAX_ENCODED_SIZE + 1];
+    size_t oversizedLength = cobsEncode(raw, sizeof(raw), oversized);
+    EXPECT_FALSE(parseFrame(oversized, oversizedLength, frame));
+}
+
+TEST(ClientTest, TestEvalBatchRoundTrip) {
+    // X X _ / O O _ / _ _ _ with X to move, the same with O to move, and a won board.
+    vector<Position> positions(3, Position{ emptyBoard(), 'X' });
+    positions[0].board[0] = positions[0].board[1] = 'X';
+    positions[0].board[3] = positions[0].board[4] = 'O';
+    positions[1] = positions[0];
+    positions[1].sideToMove = 'O';
+    positions[2] = positions[0];
+    positions[2].board[2] = 'X';
+    string request = encodeEvalBatchRequest(positions);
+    EXPECT_EQ(request, string({ '\x02', '\x03', '\x00', '\x02', '\x85', '\x04', '\x02', '\x85', '\x00', '\x02', '\x95' }));
+
+    vector<Evaluation> evaluations;
+    ASSERT_TRUE(decodeEvaluations(string({ '\x02', '\x03', '\x02', '\x05', '\x4F' }), evaluations));
+    ASSERT_EQ(evaluations.size(), 3u);
+    EXPECT_EQ(evaluations[0].status, GameStatus::NextMove);
+    EXPECT_EQ(evaluations[0].move, 2);
+    EXPECT_EQ(evaluations[1].status, GameStatus::NextMove);
+    EXPECT_EQ(evaluations[1].move, 5);
+    EXPECT_EQ(evaluations[2].status, GameStatus::WinX);
+    EXPECT_EQ(evaluations[2].move, -1);
+
+    EXPECT_FALSE(decodeEvaluations(string({ '\x02', '\x03', '\x02', '\x05' }), evaluations));
+    EXPECT_FALSE(decodeEvaluations(string({ '\x01', '\x01', '\x02' }), evaluations));
+}
+
+/**
+ * @brief Records a whole game in the journal, the players alternating from the first player.
+ */
+static void journalGame(GameJournal& journal, GameMode gameMode, char firstPlayer, const vector<int>& moves, GameStatus status) {
+    startJournalGame(journal, gameMode);
+    Board board = emptyBoard();
+    char player = firstPlayer;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        board[moves[i]] = player;
+        ASSERT_TRUE(journalBoard(journal, board, moves[i], (i + 1 == moves.size()) ? status : GameStatus::NextMove));
+        player = (player == 'X') ? 'O' : 'X';
+    }
+}
+
+/**
+ * @brief Returns the contents of a file, or an empty string if it cannot be read.
+ */
+static string readFileContents(const string& filename) {
+    ifstream in(filename, ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+TEST(ClientTest, TestJournalRecoversFromTornTail) {
+    const string journalFile = "test_recovery_journal.bin";
+    remove(journalFile.c_str());
+    GameJournal journal;
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    journalGame(journal, GameMode::ManVsMan, 'X', { 0, 3, 1, 4, 2 }, GameStatus::WinX);
+    journalGame(journal, GameMode::ManVsAI, 'O', { 4, 0, 8 }, GameStatus::NextMove);
+    closeJournal(journal);
+    ASSERT_EQ(readFileContents(journalFile).size(), 8 * sizeof(JournalRecord));
+
+    // A record torn by a crash is cut off, and the unfinished game is rebuilt from the records before it.
+    {
+        ofstream out(journalFile, ios::binary | ios::app);
+        out.write("\x02\x00\x00\x00\x7F", 5);
+    }
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    EXPECT_EQ(journal.nextGameId, 3u);
+    JournalGame game;
+    ASSERT_TRUE(recoverLastGame(journal, game));
+    closeJournal(journal);
+    string contents = readFileContents(journalFile);
+    EXPECT_EQ(contents.size(), 8 * sizeof(JournalRecord));
+    vector<JournalRecord> records;
+    ASSERT_TRUE(readJournal(journalFile, records));
+    EXPECT_EQ(records.size(), 8u);
+
+    Board expected = emptyBoard();
+    expected[4] = 'O';
+    expected[0] = 'X';
+    expected[8] = 'O';
+    EXPECT_EQ(game.gameId, 2u);
+    EXPECT_EQ(game.gameMode, GameMode::ManVsAI);
+    EXPECT_EQ(game.status, GameStatus::NextMove);
+    EXPECT_EQ(game.firstPlayer, 'O');
+    EXPECT_EQ(game.lastPlayer, 'O');
+    EXPECT_EQ(game.moveCount, 3);
+    EXPECT_EQ(game.board.cells, expected.cells);
+
+    // A complete record whose checksum no longer matches is cut off as well.
+    contents[contents.size() - sizeof(JournalRecord) + offsetof(JournalRecord, timestamp)] ^= 0x01;
+    {
+        ofstream out(journalFile, ios::binary | ios::trunc);
+        out.write(contents.data(), contents.size());
+    }
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    EXPECT_EQ(journal.nextGameId, 3u);
+    ASSERT_TRUE(recoverLastGame(journal, game));
+    closeJournal(journal);
+    EXPECT_EQ(readFileContents(journalFile).size(), 7 * sizeof(JournalRecord));
+    ASSERT_TRUE(readJournal(journalFile, records));
+    EXPECT_EQ(records.size(), 7u);
+
+    expected[8] = EMPTY_CELL;
+    EXPECT_EQ(game.gameId, 2u);
+    EXPECT_EQ(game.gameMode, GameMode::ManVsAI);
+    EXPECT_EQ(game.status, GameStatus::NextMove);
+    EXPECT_EQ(game.firstPlayer, 'O');
+    EXPECT_EQ(game.lastPlayer, 'X');
+    EXPECT_EQ(game.moveCount, 2);
+    EXPECT_EQ(game.board.cells, expected.cells);
+    remove(journalFile.c_str());
+}
+
+TEST(ClientTest, TestExportGameXML) {
+    const string journalFile = "test_export_journal.bin";
+    const string xmlFile = "test_export_game.xml";
+    remove(journalFile.c_str());
+    GameJournal journal;
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    journalGame(journal, GameMode::ManVsMan, 'X', { 0, 3, 1, 4, 2 }, GameStatus::WinX);
+    journalGame(journal, GameMode::AIVsMan, 'O', { 4, 0 }, GameStatus::NextMove);
+    closeJournal(journal);
+
+    Board board = emptyBoard();
+    board[0] = board[1] = board[2] = 'X';
+    board[3] = board[4] = 'O';
+    string expected;
+    serializeGameState(expected, 'O', GameMode::ManVsMan, board, GameStatus::WinX);
+    ASSERT_TRUE(exportGameXML(journalFile, 1, xmlFile));
+    EXPECT_EQ(readFileContents(xmlFile), expected);
+
+    board = emptyBoard();
+    board[4] = 'O';
+    board[0] = 'X';
+    serializeGameState(expected, 'O', GameMode::AIVsMan, board, GameStatus::NextMove);
+    ASSERT_TRUE(exportGameXML(journalFile, 2, xmlFile));
+    EXPECT_EQ(readFileContents(xmlFile), expected);
+
+    EXPECT_FALSE(exportGameXML(journalFile, 3, xmlFile));
+    remove(journalFile.c_str());
+    remove(xmlFile.c_str());
+}
+
+TEST(ClientTest, TestPackGameRoundTrip) {
+    GameRecord game = { 'O', GameStatus::WinO, 7, { 4, 0, 8, 2, 6, 1, 3 } };
+    PackedGame packed = packGame(game, GameMode::AIVsMan);
+    EXPECT_EQ(packed.header, (2 << 6) | (2 << 4) | 7);
+    EXPECT_EQ(packed.firstPlayer, 'O');
+    EXPECT_EQ(packed.moves[0], 0x40);
+    EXPECT_EQ(packed.moves[3], 0x30);
+    GameRecord unpacked;
+    EXPECT_EQ(unpackGame(packed, unpacked), GameMode::AIVsMan);
+    EXPECT_EQ(unpacked.firstPlayer, 'O');
+    EXPECT_EQ(unpacked.status, GameStatus::WinO);
+    ASSERT_EQ(unpacked.moveCount, 7);
+    EXPECT_TRUE(equal(game.moves, game.moves + 7, unpacked.moves));
+}
+
+TEST(ClientTest, TestArchiveAppendIsIdempotent) {
+    const string journalFile = "test_archive_journal.bin";
+    const string archiveFile = "test_archive.bin";
+    const string indexFile = "test_archive.idx";
+    remove(journalFile.c_str());
+    remove(archiveFile.c_str());
+    remove(indexFile.c_str());
+
+    GameJournal journal;
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    journalGame(journal, GameMode::ManVsMan, 'X', { 0, 3, 1, 4, 2 }, GameStatus::WinX);
+    journalGame(journal, GameMode::ManVsAI, 'X', { 4, 0, 8 }, GameStatus::NextMove);
+    journalGame(journal, GameMode::AIVsAI, 'O', { 0, 1, 2, 4, 3, 5, 7, 6, 8 }, GameStatus::Draw);
+    closeJournal(journal);
+
+    uint32_t appended = 0;
+    ASSERT_TRUE(appendJournalToArchive(journalFile, archiveFile, appended));
+    EXPECT_EQ(appended, 2u);
+    ASSERT_TRUE(appendJournalToArchive(journalFile, archiveFile, appended));
+    EXPECT_EQ(appended, 0u);
+
+    // Only the games finished since the last append are added.
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    journalGame(journal, GameMode::AIVsMan, 'O', { 4, 0, 3, 1, 5 }, GameStatus::WinO);
+    closeJournal(journal);
+    ASSERT_TRUE(appendJournalToArchive(journalFile, archiveFile, appended));
+    EXPECT_EQ(appended, 1u);
+    ASSERT_TRUE(appendJournalToArchive(journalFile, archiveFile, appended));
+    EXPECT_EQ(appended, 0u);
+
+    ASSERT_TRUE(buildArchiveIndex(archiveFile, indexFile));
+    GameArchive archive;
+    ASSERT_TRUE(openArchive(archive, archiveFile, indexFile));
+    ASSERT_EQ(archive.gameCount, 3u);
+    GameRecord game;
+    EXPECT_EQ(unpackGame(archive.games[0], game), GameMode::ManVsMan);
+    EXPECT_EQ(game.status, GameStatus::WinX);
+    EXPECT_EQ(unpackGame(archive.games[1], game), GameMode::AIVsAI);
+    EXPECT_EQ(game.status, GameStatus::Draw);
+    EXPECT_EQ(game.firstPlayer, 'O');
+    EXPECT_EQ(game.moveCount, 9);
+    EXPECT_EQ(unpackGame(archive.games[2], game), GameMode::AIVsMan);
+    EXPECT_EQ(game.status, GameStatus::WinO);
+    EXPECT_EQ(archive.outcomeCounts[0], 0u);
+    ASSERT_EQ(archive.outcomeCounts[1], 1u);
+    ASSERT_EQ(archive.outcomeCounts[2], 1u);
+    ASSERT_EQ(archive.outcomeCounts[3], 1u);
+    EXPECT_EQ(archive.outcomes[1][0], 0u);
+    EXPECT_EQ(archive.outcomes[2][0], 2u);
+    EXPECT_EQ(archive.outcomes[3][0], 1u);
+    closeArchive(archive);
+
+    remove(journalFile.c_str());
+    remove(archiveFile.c_str());
+    remove(indexFile.c_str());
+}
+
+TEST(ClientTest, TestOutcomeRatesOnJournalAndArchive) {
+    const string journalFile = "test_stats_journal.bin";
+    const string archiveFile = "test_stats_archive.bin";
+    const string indexFile = "test_stats_archive.idx";
+    remove(journalFile.c_str());
+    remove(archiveFile.c_str());
+    remove(indexFile.c_str());
+
+    GameJournal journal;
+    ASSERT_TRUE(openJournal(journal, journalFile));
+    journalGame(journal, GameMode::ManVsMan, 'X', { 4, 0, 3, 1, 5 }, GameStatus::WinX);
+    journalGame(journal, GameMode::ManVsAI, 'X', { 4, 0, 8, 2, 6, 1 }, GameStatus::WinO);
+    journalGame(journal, GameMode::ManVsAI, 'O', { 0, 4, 1, 2, 6, 3, 5, 7, 8 }, GameStatus::Draw);
+    journalGame(journal, GameMode::AIVsAI, 'X', { 4, 8, 2, 6, 7, 1, 3 }, GameStatus::NextMove);
+    journalGame(journal, GameMode::AIVsAI, 'O', { 0, 4, 8, 2, 6, 3, 1, 5 }, GameStatus::WinX);
+    closeJournal(journal);
+
+    GameColumns fromJournal;
+    ASSERT_TRUE(loadColumnsFromJournal(journalFile, fromJournal));
+    ASSERT_EQ(fromJournal.outcome.size(), 4u);
+    EXPECT_EQ(fromJournal.moveCount[1], 6);
+    EXPECT_EQ(fromJournal.moves[8][1], STATS_NO_MOVE);
+    EXPECT_EQ(fromJournal.firstPlayer[3], 1);
+
+    OutcomeCounts byOpening;
+    aggregateOutcomes(fromJournal, fromJournal.moves[0], -1, byOpening, 0);
+    EXPECT_EQ(byOpening.counts[4][1], 1u);
+    EXPECT_EQ(byOpening.counts[4][2], 1u);
+    EXPECT_EQ(byOpening.counts[0][3], 1u);
+    EXPECT_EQ(byOpening.counts[0][1], 1u);
+    OutcomeCounts byMode;
+    aggregateOutcomes(fromJournal, fromJournal.mode, -1, byMode, 0);
+    EXPECT_EQ(byMode.counts[0][1], 1u);
+    EXPECT_EQ(byMode.counts[1][2], 1u);
+    EXPECT_EQ(byMode.counts[1][3], 1u);
+    EXPECT_EQ(byMode.counts[3][1], 1u);
+    OutcomeCounts manVsAi;
+    aggregateOutcomes(fromJournal, fromJournal.firstPlayer, 1, manVsAi, 0);
+    EXPECT_EQ(manVsAi.counts[0][2], 1u);
+    EXPECT_EQ(manVsAi.counts[1][3], 1u);
+    EXPECT_EQ(manVsAi.counts[0][1] + manVsAi.counts[1][1], 0u);
+
+    uint32_t appended = 0;
+    ASSERT_TRUE(appendJournalToArchive(journalFile, archiveFile, appended));
+    ASSERT_TRUE(buildArchiveIndex(archiveFile, indexFile));
+    GameColumns fromArchive;
+    ASSERT_TRUE(loadColumnsFromArchive(archiveFile, indexFile, fromArchive));
+    EXPECT_EQ(fromArchive.outcome, fromJournal.outcome);
+    EXPECT_EQ(fromArchive.mode, fromJournal.mode);
+    EXPECT_EQ(fromArchive.moves[0], fromJournal.moves[0]);
+    remove(journalFile.c_str());
+    remove(archiveFile.c_str());
+    remove(indexFile.c_str());
+
+    // Scans large enough to be split across threads count the same as a single thread.
+    GameColumns large;
+    for (uint32_t i = 0; i < 2 * STATS_MIN_GAMES_PER_THREAD + 1000; ++i) {
+        large.outcome.push_back(static_cast<uint8_t>(1 + i % 3));
+        large.mode.push_back(static_cast<uint8_t>(i % 4));
+    }
+    OutcomeCounts single;
+    OutcomeCounts split;
+    aggregateOutcomes(large, large.mode, 2, single, 1);
+    aggregateOutcomes(large, large.mode, 2, split, 4);
+    EXPECT_EQ(memcmp(&single, &split, sizeof(OutcomeCounts)), 0);
+    EXPECT_EQ(single.counts[2][1] + single.counts[2][2] + single.counts[2][3], large.mode.size() / 4);
+    EXPECT_EQ(single.counts[0][1] + single.counts[1][1] + single.counts[3][1], 0u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
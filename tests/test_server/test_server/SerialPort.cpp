@@ -1,59 +0,0 @@
-#include "pch.h"
-#include "SerialPort.h"
-
-HANDLE openSerialPort(const wstring& portName, DWORD baudRate) {
-    HANDLE hSerial = CreateFile(portName.c_str(),
-        GENERIC_READ | GENERIC_WRITE,
-        0,
-        NULL,
-        OPEN_EXISTING,
-        FILE_ATTRIBUTE_NORMAL,
-        NULL);
-    if (hSerial == INVALID_HANDLE_VALUE) {
-        return INVALID_HANDLE_VALUE;
-    }
-    DCB dcbSerialParams = { 0 };
-    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
-    if (!GetCommState(hSerial, &dcbSerialParams)) {
-        CloseHandle(hSerial);
-        return INVALID_HANDLE_VALUE;
-    }
-    dcbSerialParams.BaudRate = baudRate;
-    dcbSerialParams.ByteSize = 8;
-    dcbSerialParams.StopBits = ONESTOPBIT;
-    dcbSerialParams.Parity = NOPARITY;
-    if (!SetCommState(hSerial, &dcbSerialParams)) {
-        CloseHandle(hSerial);
-        return INVALID_HANDLE_VALUE;
-    }
-    COMMTIMEOUTS timeouts = { 0 };
-    timeouts.ReadIntervalTimeout = 50;
-    timeouts.ReadTotalTimeoutConstant = 50;
-    timeouts.ReadTotalTimeoutMultiplier = 10;
-    timeouts.WriteTotalTimeoutConstant = 50;
-    timeouts.WriteTotalTimeoutMultiplier = 10;
-    SetCommTimeouts(hSerial, &timeouts);
-    return hSerial;
-}
-
-void sendMessage(HANDLE hSerial, string message) {
-    string stdMessage = message;
-    DWORD bytesWritten;
-    WriteFile(hSerial, stdMessage.c_str(), stdMessage.size(), &bytesWritten, NULL);
-}
-
-string readMessage(HANDLE hSerial) {
-    char buffer[256];
-    DWORD bytesRead;
-    string result;
-    while (true) {
-        if (ReadFile(hSerial, buffer, sizeof(buffer) - 1, &bytesRead, NULL)) {
-            buffer[bytesRead] = '\0';
-            result += buffer;
-            if (result.find('\n') != string::npos) {
-                break;
-            }
-        }
-    }
-    return result;
-}
\ No newline at end of file
@@ -1,13 +0,0 @@
-#pragma once
-#include "pch.h"
-#include <Windows.h>
-#include <iostream>
-#include <string>
-
-using namespace std;
-
-HANDLE openSerialPort(const wstring& portName, DWORD baudRate);
-
-void sendMessage(HANDLE hSerial, string message);
-
-string readMessage(HANDLE hSerial);
\ No newline at end of file
@@ -13,7 +13,10 @@ string sendReceiveData(const string& inputData) {
     if (hSerial == INVALID_HANDLE_VALUE) {
         throw runtime_error("Error opening serial port");
     }
-    sendMessage(hSerial, inputData);
+    if (!sendMessage(hSerial, inputData)) {
+        CloseHandle(hSerial);
+        throw runtime_error("Request was not acknowledged");
+    }
     string response = readMessage(hSerial);
     CloseHandle(hSerial);
     return response;
@@ -65,6 +68,143 @@ TEST(ServerTest, TestTurnSwitching) {
     EXPECT_TRUE(response.find("<Cell>X</Cell>") != string::npos);
 }
 
+TEST(ServerTest, TestMalformedGameStateIsRejected) {
+    string board = "<Board><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>X</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell></Row></Board>";
+    string validBoard = "<Board><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>X</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row></Board>";
+    string inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>O</Player><GameType>Man vs Man</GameType>" + board + "<Status>NextMove</Status></GameState>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 5.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>Q</Player><GameType>Man vs Man</GameType><Status>NextMove</Status></GameState>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 6.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>X</Player><GameType>Man vs Man</GameType><Status>NextMove</Status></GameState>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 4.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState>X<Player>X</Player><GameType>Man vs Man</GameType>" + board + "<Status>NextMove</Status></GameState>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 1.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>X</Player><Move>5</Move><GameType>Man vs Man</GameType><Status>NextMove</Status></GameState>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 2.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>X</Player><Player>O</Player><GameType>Man vs Man</GameType><Status>NextMove</Status></GameState>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 3.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>O</Player><GameType>Man vs Man</GameType>" + validBoard + "<Status>NextMove</Status></GameState>\r\n<Player>X</Player>";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 1.");
+    inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>O</Player><GameType>Man vs Man</GameType>" + validBoard + "<Status>NextMove</Status></GameState> x";
+    EXPECT_EQ(sendReceiveData(inputXml), "Error: invalid game state, code 1.");
+}
+
+TEST(ServerTest, TestIndentedGameStateIsAccepted) {
+    string inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
+        "<GameState>\r\n"
+        "  <Player>O</Player>\r\n"
+        "  <GameType>Man vs Man</GameType>\r\n"
+        "  <Board>\n"
+        "    <Row> <Cell>_</Cell> <Cell>_</Cell> <Cell>_</Cell> </Row>\n"
+        "    <Row>\t<Cell>_</Cell>\t<Cell>X</Cell>\t<Cell>_</Cell>\t</Row>\n"
+        "    <Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row>\n"
+        "  </Board>\n"
+        "  <Status>NextMove</Status>\n"
+        "</GameState>\n";
+    string compactXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>O</Player><GameType>Man vs Man</GameType><Board><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>X</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row></Board><Status>NextMove</Status></GameState>";
+    string response = sendReceiveData(inputXml);
+    EXPECT_TRUE(response.find("<Row><Cell>_</Cell><Cell>X</Cell><Cell>_</Cell></Row>") != string::npos) << response;
+    EXPECT_EQ(response, sendReceiveData(compactXml));
+}
+
+TEST(ServerTest, TestServerPlaysFullGames) {
+    string request = { '\x01', 'X', '\x0A' };
+    string response = sendReceiveData(request);
+    ASSERT_GE(response.size(), 2u);
+    EXPECT_EQ(response[0], '\x01');
+    EXPECT_EQ(response[1], '\x0A');
+    size_t pos = 2;
+    for (int game = 0; game < 10; ++game) {
+        ASSERT_LT(pos, response.size());
+        unsigned char header = static_cast<unsigned char>(response[pos]);
+        int moveCount = header & 0x0F;
+        EXPECT_NE(header >> 6, 0);
+        EXPECT_EQ(header & 0x10, 0);
+        EXPECT_GE(moveCount, 5);
+        EXPECT_LE(moveCount, 9);
+        pos += 1 + (moveCount + 1) / 2;
+    }
+    EXPECT_EQ(pos, response.size());
+}
+
+TEST(ServerTest, TestBatchEvaluation) {
+    // X X _ / O O _ / _ _ _ with X to move, the same with O to move, and a won board.
+    string request = { '\x02', '\x03', '\x00', '\x02', '\x85', '\x04', '\x02', '\x85', '\x00', '\x02', '\x95' };
+    string response = sendReceiveData(request);
+    ASSERT_EQ(response.size(), 5u);
+    EXPECT_EQ(response[0], '\x02');
+    EXPECT_EQ(response[1], '\x03');
+    EXPECT_EQ(static_cast<unsigned char>(response[2]), 0x02);
+    EXPECT_EQ(static_cast<unsigned char>(response[3]), 0x05);
+    EXPECT_EQ(static_cast<unsigned char>(response[4]), 0x4F);
+}
+
+TEST(ServerTest, TestCorruptedFrameIsRejected) {
+    HANDLE hSerial = openSerialPort(comport, baudRate);
+    ASSERT_NE(hSerial, INVALID_HANDLE_VALUE);
+    const uint8_t payload[] = "<GameState>";
+    uint8_t encoded[FRAME_MAX_ENCODED_SIZE];
+    size_t length = buildFrame(FRAME_DATA, 0x7F, 0, 1, payload, sizeof(payload) - 1, encoded);
+    encoded[length / 2] ^= 0x10;
+    DWORD bytesWritten;
+    WriteFile(hSerial, encoded, static_cast<DWORD>(length), &bytesWritten, NULL);
+    Frame reply;
+    EXPECT_EQ(readFrame(hSerial, reply, RESPONSE_TIMEOUT_MS), FRAME_RECEIVED);
+    EXPECT_EQ(reply.type, FRAME_NAK);
+    CloseHandle(hSerial);
+}
+
+TEST(ServerTest, TestTestFrameDuringResponseIsAnswered) {
+    HANDLE hSerial = openSerialPort(comport, baudRate);
+    ASSERT_NE(hSerial, INVALID_HANDLE_VALUE);
+    string inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>X</Player><GameType>Man vs Man</GameType><Board><Row><Cell>X</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row></Board><Status>NextMove</Status></GameState>";
+    ASSERT_TRUE(sendMessage(hSerial, inputXml));
+    Frame reply;
+    ASSERT_EQ(readFrame(hSerial, reply, RESPONSE_TIMEOUT_MS), FRAME_RECEIVED);
+    EXPECT_EQ(reply.type, FRAME_DATA);
+
+    // The response is left unacknowledged, so the test pattern reaches the server while it retransmits.
+    const uint8_t pattern[] = { 0x55, 0xAA, 0x00, 0xFF };
+    writeFrame(hSerial, FRAME_TEST, 0x7D, 0, 1, pattern, sizeof(pattern));
+    do {
+        ASSERT_EQ(readFrame(hSerial, reply, RESPONSE_TIMEOUT_MS), FRAME_RECEIVED);
+    } while (reply.type == FRAME_DATA);
+    EXPECT_EQ(reply.type, FRAME_TEST);
+    ASSERT_EQ(reply.payloadLength, sizeof(pattern));
+    EXPECT_EQ(memcmp(reply.payload, pattern, sizeof(pattern)), 0);
+
+    ASSERT_TRUE(sendMessage(hSerial, inputXml));
+    EXPECT_TRUE(readMessage(hSerial).find("<Player>O</Player>") != string::npos);
+    CloseHandle(hSerial);
+}
+
+TEST(ServerTest, TestBaudRateNegotiation) {
+    HANDLE hSerial = openSerialPort(comport, BASE_BAUD_RATE);
+    ASSERT_NE(hSerial, INVALID_HANDLE_VALUE);
+    EXPECT_EQ(negotiateBaudRate(hSerial, CBR_250000), static_cast<DWORD>(CBR_250000));
+    string inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>X</Player><GameType>Man vs Man</GameType><Board><Row><Cell>X</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row></Board><Status>NextMove</Status></GameState>";
+    ASSERT_TRUE(sendMessage(hSerial, inputXml));
+    string response = readMessage(hSerial);
+    EXPECT_TRUE(response.find("<Player>O</Player>") != string::npos);
+    EXPECT_EQ(negotiateBaudRate(hSerial, BASE_BAUD_RATE), static_cast<DWORD>(BASE_BAUD_RATE));
+    CloseHandle(hSerial);
+}
+
+TEST(ServerTest, TestRefusedBaudRateKeepsBaseRate) {
+    HANDLE hSerial = openSerialPort(comport, BASE_BAUD_RATE);
+    ASSERT_NE(hSerial, INVALID_HANDLE_VALUE);
+    const uint8_t unsupported[4] = { 0x00, 0x01, 0xE2, 0x40 };
+    writeFrame(hSerial, FRAME_BAUD, 0x7E, 0, 1, unsupported, sizeof(unsupported));
+    Frame reply;
+    ASSERT_EQ(readFrame(hSerial, reply, RESPONSE_TIMEOUT_MS), FRAME_RECEIVED);
+    EXPECT_EQ(reply.type, FRAME_NAK);
+    EXPECT_EQ(negotiateBaudRate(hSerial, CBR_9600), static_cast<DWORD>(BASE_BAUD_RATE));
+    string inputXml = "<?xml version=\"1.0\" encoding=\"utf-8\"?><GameState><Player>X</Player><GameType>Man vs Man</GameType><Board><Row><Cell>X</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row><Row><Cell>_</Cell><Cell>_</Cell><Cell>_</Cell></Row></Board><Status>NextMove</Status></GameState>";
+    ASSERT_TRUE(sendMessage(hSerial, inputXml));
+    EXPECT_TRUE(readMessage(hSerial).find("<Player>O</Player>") != string::npos);
+    CloseHandle(hSerial);
+}
+
 int main(int argc, char** argv) {
     int result;
     ::testing::InitGoogleTest(&argc, argv);